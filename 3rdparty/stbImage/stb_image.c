@@ -0,0 +1,7 @@
+// Implementation of stb_image and stb_image_write, compiled once in the STB
+// library (the other files only include the headers)
+#define STB_IMAGE_IMPLEMENTATION
+#include "stb_image.h"
+
+#define STB_IMAGE_WRITE_IMPLEMENTATION
+#include "stb_image_write.h"
@@ -1,4 +1,5 @@
 #include "MainWindow.h"
+#include "Benchmark.h"
 
 #include <imgui.h>
 #include <imgui_impl_glfw.h>
@@ -31,7 +32,7 @@ int MainWindow::Initialisation()
 
 	// glfw window creation
 	// --------------------
-	m_window = glfwCreateWindow(SCR_WIDTH, SCR_HEIGHT, "ImGui Demo", NULL, NULL);
+	m_window = Benchmark::createWindow(SCR_WIDTH, SCR_HEIGHT, "ImGui Demo");
 	if (m_window == NULL)
 	{
 		std::cerr << "Failed to create GLFW window" << std::endl;
@@ -44,7 +45,7 @@ int MainWindow::Initialisation()
 
 	// glad: load all OpenGL function pointers
 	// ---------------------------------------
-	if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
+	if (!gladLoadGLLoader((GLADloadproc)Benchmark::getProcAddress))
 	{
 		std::cerr << "Failed to initialize GLAD" << std::endl;
 		return 2;
@@ -123,6 +124,9 @@ int MainWindow::RenderLoop()
 		RenderScene();
 		RenderImgui();
 
+		// Frame measurements (benchmark mode, see Benchmark.h)
+		Benchmark::endFrame(m_window);
+
 		// Show rendering and get events
 		glfwSwapBuffers(m_window);
 		glfwPollEvents();
@@ -1,7 +1,11 @@
 #include "MainWindow.h"
+#include "Benchmark.h"
 
-int main()
+int main(int argc, char** argv)
 {
+	if (!Benchmark::parseArguments(argc, argv))
+		return 1;
+
 	MainWindow MainWindow;
 	int init_value = MainWindow.Initialisation();
 	if (init_value != 0) {
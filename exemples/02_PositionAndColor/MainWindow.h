@@ -6,6 +6,7 @@
 #include <memory>
 
 #include "ShaderProgram.h"
+#include "GLDebugSink.h"
 
 void Framebuffer_size_callback(GLFWwindow* window, int width, int height);
 
@@ -1,4 +1,5 @@
 #include "MainWindow.h"
+#include "Benchmark.h"
 
 #include <imgui.h>
 #include <imgui_impl_glfw.h>
@@ -39,7 +40,7 @@ int MainWindow::Initialisation()
 
 	// glfw window creation
 	// --------------------
-	m_window = glfwCreateWindow(SCR_WIDTH, SCR_HEIGHT, "Position and colors - SSBO", NULL, NULL);
+	m_window = Benchmark::createWindow(SCR_WIDTH, SCR_HEIGHT, "Position and colors - SSBO");
 	if (m_window == NULL)
 	{
 		std::cerr << "Failed to create GLFW window" << std::endl;
@@ -52,28 +53,26 @@ int MainWindow::Initialisation()
 
 	// glad: load all OpenGL function pointers
 	// ---------------------------------------
-	if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
+	if (!gladLoadGLLoader((GLADloadproc)Benchmark::getProcAddress))
 	{
 		std::cerr << "Failed to initialize GLAD" << std::endl;
 		return 2;
 	}
 
-	// Configure the error handling
-	int flags; glGetIntegerv(GL_CONTEXT_FLAGS, &flags);
-	if (flags & GL_CONTEXT_FLAG_DEBUG_BIT)
+	// Configure the error handling (only the API errors are reported)
+	if (GLDebugSink::install())
 	{
 		std::cout << "Debug context created\n";
-		// initialize debug output 
-		glEnable(GL_DEBUG_OUTPUT);
-		glEnable(GL_DEBUG_OUTPUT_SYNCHRONOUS);
-		glDebugMessageCallback(glDebugOutput, nullptr);
 		glDebugMessageControl(GL_DONT_CARE, GL_DONT_CARE, GL_DONT_CARE, 0, nullptr, GL_FALSE);
 		glDebugMessageControl(GL_DEBUG_SOURCE_API, GL_DEBUG_TYPE_ERROR, GL_DONT_CARE, 0, NULL, GL_TRUE);
 	}
 
 	// Other openGL initialization
 	// -----------------------------
-	return InitializeGL();
+	const int initValue = InitializeGL();
+	// Print the messages of the initialization (before quitting if it failed)
+	GLDebugSink::instance().drain();
+	return initValue;
 }
 
 void MainWindow::InitializeCallback() {
@@ -152,6 +151,11 @@ int MainWindow::RenderLoop()
 			glfwSetWindowShouldClose(m_window, true);
 
 		RenderScene();
+		// Print the OpenGL debug messages of this frame
+		GLDebugSink::instance().drain();
+
+		// Frame measurements (benchmark mode, see Benchmark.h)
+		Benchmark::endFrame(m_window);
 
 		// Show rendering and get events
 		glfwSwapBuffers(m_window);
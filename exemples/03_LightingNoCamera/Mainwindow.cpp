@@ -1,4 +1,6 @@
 #include "MainWindow.h"
+#include "Benchmark.h"
+#include "JobSystem.h"
 
 #include <imgui.h>
 #include <imgui_impl_glfw.h>
@@ -37,7 +39,7 @@ int MainWindow::Initialisation()
 
 	// glfw window creation
 	// --------------------
-	m_window = glfwCreateWindow(SCR_WIDTH, SCR_HEIGHT, "Lighting no camera", NULL, NULL);
+	m_window = Benchmark::createWindow(SCR_WIDTH, SCR_HEIGHT, "Lighting no camera");
 	if (m_window == NULL)
 	{
 		std::cerr << "Failed to create GLFW window" << std::endl;
@@ -50,7 +52,7 @@ int MainWindow::Initialisation()
 
 	// glad: load all OpenGL function pointers
 	// ---------------------------------------
-	if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
+	if (!gladLoadGLLoader((GLADloadproc)Benchmark::getProcAddress))
 	{
 		std::cerr << "Failed to initialize GLAD" << std::endl;
 		return 2;
@@ -229,6 +231,9 @@ int MainWindow::RenderLoop()
 		RenderScene();
 		RenderImgui();
 
+		// Frame measurements (benchmark mode, see Benchmark.h)
+		Benchmark::endFrame(m_window);
+
 		// Show rendering and get events
 		glfwSwapBuffers(m_window);
 		glfwPollEvents();
@@ -312,18 +317,26 @@ void MainWindow::updateGeometry()
 		center /= 306.f;
 
 		// Utilisation des patchs de bezier
-		for (unsigned int npatch = 0; npatch < 16; npatch++) {
-			glm::vec3 pos[16];
-			for (unsigned int i = 0; i < 16; i++) {
-				int index = teapotPatches[npatch][i];
-				pos[i] = (teapotVertices[index] - center) * 0.45f;
-			}
-			// Pour chaque patch, on genere les triangles
-			// en forme de grille
-			// On utilise les coordonnees u et v pour parcourir
-			// la surface parametrique
-			for (unsigned int i = 0; i < COUNT; i++) {
+		// Chaque cellule (patch, i, j) ecrit ses 6 sommets a une position
+		// fixe: les lignes de la grille sont calculees en parallele
+		m_vertices.resize(16 * COUNT * COUNT * 6);
+		m_normals.resize(m_vertices.size());
+		JobSystem::instance().parallelFor(0, int(16 * COUNT), [&](int begin, int end) {
+			for (int row = begin; row < end; row++) {
+				const unsigned int npatch = row / COUNT;
+				const unsigned int i = row % COUNT;
+				glm::vec3 pos[16];
+				for (unsigned int k = 0; k < 16; k++) {
+					int index = teapotPatches[npatch][k];
+					pos[k] = (teapotVertices[index] - center) * 0.45f;
+				}
+				// Pour chaque patch, on genere les triangles
+				// en forme de grille
+				// On utilise les coordonnees u et v pour parcourir
+				// la surface parametrique
 				for(unsigned int j = 0; j < COUNT; j++) {
+					glm::vec3* vertices = &m_vertices[(row * COUNT + j) * 6];
+					glm::vec3* normals = &m_normals[(row * COUNT + j) * 6];
 					// Calcul des positions
 					float u1 = (float)i / (COUNT - 1);
 					float v1 = (float)j / (COUNT - 1);
@@ -335,13 +348,13 @@ void MainWindow::updateGeometry()
 					glm::vec3 p2top = bezierPatch(pos, u2, v2);
 
 					// Triangle 1
-					m_vertices.push_back(m * p1bot);
-					m_vertices.push_back(m * p1top);
-					m_vertices.push_back(m * p2bot);
+					vertices[0] = m * p1bot;
+					vertices[1] = m * p1top;
+					vertices[2] = m * p2bot;
 					// Triangle 2
-					m_vertices.push_back(m * p2bot);
-					m_vertices.push_back(m * p1top);
-					m_vertices.push_back(m * p2top);
+					vertices[3] = m * p2bot;
+					vertices[4] = m * p1top;
+					vertices[5] = m * p2top;
 
 					// Calcul des normales
 					// TODO: Voir pourquoi incoherence entre les normales
@@ -351,17 +364,17 @@ void MainWindow::updateGeometry()
 						glm::vec3 e1 = p1top - p1bot;
 						glm::vec3 e2 = p2bot - p1bot;
 						glm::vec3 n = glm::normalize(glm::cross(e1, e2));
-						m_normals.push_back(- m * n);
-						m_normals.push_back(- m * n);
-						m_normals.push_back(- m * n);
+						normals[0] = - m * n;
+						normals[1] = - m * n;
+						normals[2] = - m * n;
 						
 						// Triangle 2
 						e1 = p1top - p2bot;
 						e2 = p2top - p2bot;
 						n = glm::normalize(glm::cross(e1, e2));
-						m_normals.push_back(- m * n);
-						m_normals.push_back(- m * n);
-						m_normals.push_back(- m * n);
+						normals[3] = - m * n;
+						normals[4] = - m * n;
+						normals[5] = - m * n;
 					}
 					else {
 						// Utilisation de la derivee de la surface
@@ -371,17 +384,17 @@ void MainWindow::updateGeometry()
 						glm::vec3 n1top = bezierPatchNormal(pos, u1, v2);
 						glm::vec3 n2top = bezierPatchNormal(pos, u2, v2);
 						// Triangle 1
-						m_normals.push_back(- m * n1bot);
-						m_normals.push_back(- m * n1top);
-						m_normals.push_back(- m * n2bot);
+						normals[0] = - m * n1bot;
+						normals[1] = - m * n1top;
+						normals[2] = - m * n2bot;
 						// Triangle 2
-						m_normals.push_back(- m * n2bot);
-						m_normals.push_back(- m * n1top);
-						m_normals.push_back(- m * n2top);
+						normals[3] = - m * n2bot;
+						normals[4] = - m * n1top;
+						normals[5] = - m * n2top;
 					}
 				}
 			}
-		}
+		});
 	} else {
 		// Base positions
 		const float PI = 3.14159265358979323846f;
@@ -10,6 +10,8 @@ const float n = 128;
 const vec3 kd = vec3(0.5);
 const vec3 ks = vec3(0.5);
 
+#include "phong.glsl"
+
 void
 main()
 {
@@ -20,8 +22,7 @@ main()
     float cosTheta = dot(nNormal, LightDirection);
     if (cosTheta > 0.0)
     {
-        vec3 r = reflect(-LightDirection, nNormal);
-        float specular = pow(max(0.0, dot(EyeDirection, r)), n);
+        float specular = phongSpecular(LightDirection, nNormal, EyeDirection, n);
 
         // Fait l'hypothese que l'intensit de la lumiere est constante (1,1,1)
         fColor = vec3(kd * cosTheta + ks * specular);
@@ -14,6 +14,8 @@ const float n = 128;
 const vec3 kd = vec3(0.5); // Gray color
 const vec3 ks = vec3(0.5);
 
+#include "phong.glsl"
+
 void
 main()
 {
@@ -34,10 +36,9 @@ main()
     float cosTheta = dot(nNormal, LightDir);
     if (cosTheta > 0.0)
     {
-        // Compute specular (phong)
-        vec3 r = reflect(-LightDir, nNormal);
-        // Note: max here is to clamp the lobe if it is below the surface
-        float specular = pow(max(0.0, dot(EyeDir, r)), n);
+        // Compute specular (phong, see shared/shaders/phong.glsl)
+        // Note: the lobe is clamped if it is below the surface
+        float specular = phongSpecular(LightDir, nNormal, EyeDir, n);
 
         // Compute the material model (specular + diffuse)
         // Assume light intensity is (1,1,1)
@@ -1,4 +1,5 @@
 #include "MainWindow.h"
+#include "Benchmark.h"
 
 #include <imgui.h>
 #include <imgui_impl_glfw.h>
@@ -9,8 +10,7 @@
 
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/matrix_inverse.hpp>
-
-#include "OBJLoader.h"
+#include <glm/gtc/type_ptr.hpp>
 
 #define BUFFER_OFFSET(i) ((char *)NULL + (i))
 
@@ -45,7 +45,7 @@ int MainWindow::Initialisation()
 
 	// glfw window creation
 	// --------------------
-	m_window = glfwCreateWindow(SCR_WIDTH, SCR_HEIGHT, "Obj Loader", NULL, NULL);
+	m_window = Benchmark::createWindow(SCR_WIDTH, SCR_HEIGHT, "Obj Loader");
 	if (m_window == NULL)
 	{
 		std::cerr << "Failed to create GLFW window" << std::endl;
@@ -58,7 +58,7 @@ int MainWindow::Initialisation()
 
 	// glad: load all OpenGL function pointers
 	// ---------------------------------------
-	if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
+	if (!gladLoadGLLoader((GLADloadproc)Benchmark::getProcAddress))
 	{
 		std::cerr << "Failed to initialize GLAD" << std::endl;
 		return 2;
@@ -76,6 +76,9 @@ int MainWindow::Initialisation()
 	ImGui_ImplGlfw_InitForOpenGL(m_window, true);
 	ImGui_ImplOpenGL3_Init(glsl_version);
 
+	// On-demand rendering (installed after the callbacks of ImGui)
+	m_onDemand.install(m_window);
+
 	// Other openGL initialization
 // -----------------------------
 	return InitializeGL();
@@ -119,8 +122,13 @@ int MainWindow::InitializeGL()
 		return 5;
 	}
 
-	// Load the 3D model from the obj file
+	// Load the 3D model from the obj file (in background)
+	// Wake up the render loop when the file is loaded
+	m_resources.onLoaded = []() { glfwPostEmptyEvent(); };
 	loadObjFile();
+	// Benchmark: the measured frames show the loaded model
+	if (Benchmark::settings().frames > 0)
+		m_resources.finish();
 
 	FramebufferSizeCallback(SCR_WIDTH, SCR_HEIGHT);
 
@@ -129,6 +137,13 @@ int MainWindow::InitializeGL()
 
 void MainWindow::RenderImgui()
 {
+	PROFILE_SCOPE("RenderImgui");
+	// Nothing changed for the interface: draw the previous one again
+	if (!m_onDemand.imguiNeedsUpdate()) {
+		ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+		return;
+	}
+
 	// Start the Dear ImGui frame
 	ImGui_ImplOpenGL3_NewFrame();
 	ImGui_ImplGlfw_NewFrame();
@@ -156,8 +171,16 @@ void MainWindow::RenderImgui()
 			m_light_position = m_eye;
 		}
 
+		ImGui::Separator();
+		ImGui::Text("Visible meshes: %d / %d (%s)", int(m_visibleMeshes.size()), int(m_mesh->parts.size()), FrustumCulling::instructionSet());
+		m_resources.drawImgui();
+
+		ImGui::Separator();
+		m_onDemand.drawImgui();
+
 		ImGui::End();
 	}
+	CpuProfiler::drawImgui();
 
 	ImGui::Render();
 	ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
@@ -165,6 +188,7 @@ void MainWindow::RenderImgui()
 
 void MainWindow::RenderScene()
 {
+	PROFILE_SCOPE("RenderScene");
 	// Clear the frame buffer
 	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
@@ -184,9 +208,25 @@ void MainWindow::RenderScene()
 	m_mainShader->setMat3(m_mainShaderUniforms.normal, NormalMat);
 	m_mainShader->setVec3(m_mainShaderUniforms.lightPos, LookAt * glm::vec4(m_light_position, 1.0));
 
+	// Placeholder box until the mesh is loaded
+	const MeshResource& mesh = *m_mesh.get();
+	if (m_meshesBoundsReady != m_mesh.isReady() || m_meshesBounds.size() != mesh.parts.size()) {
+		m_meshesBounds.clear();
+		for (const MeshResource::Part& part : mesh.parts)
+			m_meshesBounds.add(part.center, part.radius);
+		m_meshesBoundsReady = m_mesh.isReady();
+	}
+
+	// Keep only the meshes inside the view frustum
+	// (planes expressed in the object space, same space as the bounds)
+	glm::vec4 planes[6];
+	FrustumCulling::extractPlanes(m_proj * LookAt, planes);
+	FrustumCulling::cullSpheres(planes, m_meshesBounds, m_visibleMeshes);
+
 	// Draw the meshes
-	for(const MeshGL& m : m_meshesGL)
+	for (uint32_t i : m_visibleMeshes)
 	{
+		const MeshResource::Part& m = mesh.parts[i];
 		// Set its material properties
 		m_mainShader->setVec3(m_mainShaderUniforms.Kd, m.diffuse);
 		m_mainShader->setVec3(m_mainShaderUniforms.Ks, m.specular);
@@ -194,7 +234,7 @@ void MainWindow::RenderScene()
 
 		// Draw the mesh
 		glBindVertexArray(m.vao);
-		glDrawArrays(GL_TRIANGLES, 0, m.numVertices);
+		glDrawArrays(GL_TRIANGLES, 0, m.vertexCount);
 	}
 }
 
@@ -202,6 +242,15 @@ int MainWindow::RenderLoop()
 {
 	while (!glfwWindowShouldClose(m_window))
 	{
+		PROFILE_SCOPE("RenderLoop");
+		// Create the OpenGL objects of the loaded resources (2 ms per frame)
+		if (m_resources.update() > 0)
+			m_onDemand.requestRedraw();
+
+		// Process the events, draw only when something changed
+		if (!m_onDemand.waitEvents())
+			continue;
+
 		// Check inputs: Does ESC was pressed?
 		if (glfwGetKey(m_window, GLFW_KEY_ESCAPE) == GLFW_PRESS)
 			glfwSetWindowShouldClose(m_window, true);
@@ -209,23 +258,22 @@ int MainWindow::RenderLoop()
 		RenderScene();
 		RenderImgui();
 
+		// Frame measurements (benchmark mode, see Benchmark.h)
+		Benchmark::endFrame(m_window);
+
 		// Show rendering and get events
-		glfwSwapBuffers(m_window);
-		glfwPollEvents();
+		{
+			PROFILE_SCOPE("SwapBuffers");
+			glfwSwapBuffers(m_window);
+		}
+		m_onDemand.endFrame();
 	}
 
 	// Clean memory
 	// Delete vaos and vbos
-	for (const MeshGL& m : m_meshesGL)
-	{
-		// Set material properties
-
-		// Draw the mesh
-		glDeleteVertexArrays(1, &m.vao);
-		glDeleteBuffers(1, &m.vboPosition);
-		glDeleteBuffers(1, &m.vboNormal);
-	}
-	m_meshesGL.clear();
+	m_mesh.reset();
+	m_resources.clear();
+	m_meshesBounds.clear();
 
 	// Cleanup
 	ImGui_ImplOpenGL3_Shutdown();
@@ -249,96 +297,16 @@ void MainWindow::updateCameraEye()
 
 void MainWindow::loadObjFile()
 {
+	PROFILE_SCOPE("loadObjFile");
 	std::string assets_dir = ASSETS_DIR;
 	std::string ObjPath = assets_dir + "soccerball.obj";
-	// Load the obj file
-	OBJLoader::Loader loader(ObjPath);
-
-	// Create a GL object for each mesh extracted from the OBJ file
+	// Request the obj file: it is read by a loading thread and the
+	// OpenGL objects are created by m_resources.update() in the render loop.
 	// Note that if the 3D object have several different material
-	// This will create multiple Mesh objects (one for each different material)
-	const std::vector<OBJLoader::Mesh>& meshes = loader.getMeshes();
-	const std::vector<OBJLoader::Material>& materials = loader.getMaterials();
-	for (unsigned int i = 0; i < meshes.size(); ++i)
-	{
-		if (meshes[i].vertices.size() == 0)
-			continue;
-
-		MeshGL meshGL;
-		meshGL.numVertices = meshes[i].vertices.size();
-
-		// Set material properties of the mesh
-		const float* Kd = materials[meshes[i].materialID].Kd;
-		const float* Ks = materials[meshes[i].materialID].Ks;
-
-		meshGL.diffuse = glm::vec3(Kd[0], Kd[1], Kd[2]);
-		meshGL.specular = glm::vec3(Ks[0], Ks[1], Ks[2]);
-		meshGL.specularExponent = materials[meshes[i].materialID].Kn;
-
-		// Create its VAO and VBO object
-		glCreateVertexArrays(1, &meshGL.vao);
-		glCreateBuffers(1, &meshGL.vboPosition);
-		glCreateBuffers(1, &meshGL.vboNormal);
-		std::cout << "Mesh " << i << " has " << meshGL.numVertices << " vertices\n";
-
-		// Split data into position and normal
-		std::vector<glm::vec3> positions(meshGL.numVertices);
-		std::vector<glm::vec3> normals(meshGL.numVertices);
-		for (unsigned int j = 0; j < meshGL.numVertices; ++j)
-		{
-			positions[j] = glm::vec3(meshes[i].vertices[j].position[0], meshes[i].vertices[j].position[1], meshes[i].vertices[j].position[2]);
-			normals[j] = glm::vec3(meshes[i].vertices[j].normal[0], meshes[i].vertices[j].normal[1], meshes[i].vertices[j].normal[2]);
-		}
-		std::cout << "Mesh " << i << " has " << meshGL.numVertices << " vertices\n";
-		// Here we will use only one VBO for all the data
-		glNamedBufferData(meshGL.vboPosition, sizeof(glm::vec3) * positions.size(), positions.data(), GL_STATIC_DRAW);
-		glNamedBufferData(meshGL.vboNormal, sizeof(glm::vec3) * normals.size(), normals.data(), GL_STATIC_DRAW);
-
-		int PositionLoc = m_mainShader->attributeLocation("vPosition");
-		glVertexArrayAttribFormat(meshGL.vao, 
-			PositionLoc, // Attribute index 
-			3, // Number of components
-			GL_FLOAT, // Type 
-			GL_FALSE, // Normalize 
-			0 // Relative offset (first component)
-		);
-		glVertexArrayVertexBuffer(meshGL.vao, 
-			PositionLoc, // Binding point 
-			meshGL.vboPosition, // VBO 
-			0, // Offset (when the position starts)
-			sizeof(glm::vec3) // Stride
-		);
-		glEnableVertexArrayAttrib(meshGL.vao, 
-			PositionLoc // Attribute index
-		);
-		glVertexArrayAttribBinding(meshGL.vao, 
-			PositionLoc, // Attribute index
-			PositionLoc  // Binding point
-		);
-
-		int NormalLoc = m_mainShader->attributeLocation("vNormal");
-		glVertexArrayAttribFormat(meshGL.vao, 
-			NormalLoc, // Attribute index 
-			3, // Number of components
-			GL_FLOAT, // Type 
-			GL_FALSE, // Normalize 
-			0 // Relative offset (first component)
-		);
-		glVertexArrayVertexBuffer(meshGL.vao, 
-			NormalLoc, // Binding point 
-			meshGL.vboNormal, // VBO 
-			0, // Offset (when the position starts)
-			sizeof(glm::vec3) // Stride
-		);
-		glEnableVertexArrayAttrib(meshGL.vao, 
-			NormalLoc // Attribute index
-		);
-		glVertexArrayAttribBinding(meshGL.vao, 
-			NormalLoc, // Attribute index
-			NormalLoc  // Binding point
-		);
-
-		// Add it to the list
-		m_meshesGL.push_back(meshGL);
-	}
+	// This will create multiple parts (one for each different material)
+	MeshLayout layout;
+	layout.position = m_mainShader->attributeLocation("vPosition");
+	layout.normal = m_mainShader->attributeLocation("vNormal");
+	layout.uv = -1;
+	m_mesh = m_resources.loadMesh(ObjPath, layout);
 }
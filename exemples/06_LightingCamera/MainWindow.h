@@ -10,6 +10,10 @@
 #include <memory>
 
 #include "ShaderProgram.h"
+#include "CpuProfiler.h"
+#include "FrustumCulling.h"
+#include "OnDemandRendering.h"
+#include "ResourceManager.h"
 
 
 class MainWindow
@@ -42,6 +46,8 @@ private:
 private:
 	// GLFW Window
 	GLFWwindow* m_window = nullptr;
+	// Draw only when something changed
+	OnDemandRendering m_onDemand;
 
 	// settings
 	const unsigned int SCR_WIDTH = 900;
@@ -76,20 +82,12 @@ private:
 		GLint Kn; // Kn
 	} m_mainShaderUniforms;
 
-	// VAOs and VBOs
-	struct MeshGL
-	{
-		// ID VAO/VBO
-		GLuint vao;
-		GLuint vboPosition;
-		GLuint vboNormal;
-
-		// Material information
-		glm::vec3  diffuse;
-		glm::vec3  specular;
-		GLfloat    specularExponent;
-
-		unsigned int numVertices;
-	};
-	std::vector<MeshGL> m_meshesGL;
+	// Meshes of the OBJ file (one part per material), loaded in background
+	// A box is drawn until the file is loaded
+	ResourceManager m_resources;
+	MeshHandle m_mesh;
+	// Bounding spheres of the parts (same order as the parts)
+	FrustumCulling::Spheres m_meshesBounds;
+	bool m_meshesBoundsReady = false;
+	std::vector<uint32_t> m_visibleMeshes;
 };
@@ -4,6 +4,8 @@ uniform vec3 Ks;
 uniform float Kn;
 uniform vec3 lightPos;
 
+#include "phong.glsl"
+
 in vec3 fNormal;
 in vec3 fPosition;
 
@@ -20,8 +22,7 @@ main()
     vec3 diffuse = Kd * max(0.0, dot(nfNormal, LightDirection));
 
     // Compute specular component
-    vec3 Rl = normalize(-LightDirection+2.0*nfNormal*dot(nfNormal,LightDirection));
-    vec3 specular = Ks*pow(max(0.0, dot(Rl, nviewDirection)), Kn);
+    vec3 specular = Ks*phongSpecular(LightDirection, nfNormal, nviewDirection, Kn);
 
     // Compute final color
     fColor = vec4(diffuse +  specular, 1);
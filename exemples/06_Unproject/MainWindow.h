@@ -9,6 +9,11 @@
 
 #include "ShaderProgram.h"
 #include "Camera.h"
+#include "CameraUBO.h"
+#include "CameraPath.h"
+#include "CpuProfiler.h"
+#include "FrameStats.h"
+#include "GLTrace.h"
 
 class MainWindow
 {
@@ -50,6 +55,11 @@ private:
 
 	// Camera
 	Camera m_camera;
+	CameraUBO m_cameraUBO;
+	CameraPath m_cameraPath;
+
+	// Frame times (the selection stalls the pipeline with glFinish)
+	FrameStats m_frameStats;
 
 	// VAOs and VBOs
 	enum VAO_IDs { VAO_Spiral, VAO_SpiralSelected, VAO_SpiralPicking, VAO_Ray, NumVAOs };
@@ -61,13 +71,11 @@ private:
 	// Render shaders & locations
 	std::unique_ptr<ShaderProgram> m_mainShader = nullptr;
 	struct {
-		GLint uProjMatrix;
 		GLint uMatrix;
 		GLint uNormalMatrix;
 	} m_mainShaderLocations;
 	std::unique_ptr<ShaderProgram> m_pickingShader = nullptr;
 	struct {
-		GLint uProjMatrix;
 		GLint uColor;
 		GLint uMatrix;
 	} m_pickingShaderLocations;
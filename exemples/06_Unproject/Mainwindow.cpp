@@ -1,4 +1,5 @@
 #include "MainWindow.h"
+#include "Benchmark.h"
 
 #include <imgui.h>
 #include <imgui_impl_glfw.h>
@@ -45,7 +46,7 @@ int MainWindow::Initialisation()
 
 	// glfw window creation
 	// --------------------
-	m_window = glfwCreateWindow(m_windowWidth, m_windowHeight, "Picking", NULL, NULL);
+	m_window = Benchmark::createWindow(m_windowWidth, m_windowHeight, "Picking");
 	if (m_window == NULL)
 	{
 		std::cerr << "Failed to create GLFW window" << std::endl;
@@ -58,11 +59,13 @@ int MainWindow::Initialisation()
 
 	// glad: load all OpenGL function pointers
 	// ---------------------------------------
-	if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
+	if (!gladLoadGLLoader((GLADloadproc)Benchmark::getProcAddress))
 	{
 		std::cerr << "Failed to initialize GLAD" << std::endl;
 		return 2;
 	}
+	// Count the OpenGL calls (only if compiled with ENABLE_GL_TRACE)
+	GLTrace::install();
 
 	// imGui: create interface
 	// ---------------------------------------
@@ -116,11 +119,11 @@ int MainWindow::InitializeGL()
 	}
 
 	// Get locations of the uniform variables
-	m_mainShaderLocations.uProjMatrix = m_mainShader->uniformLocation("uProjMatrix");
+	// Note: the view and projection matrices are inside the camera UBO (camera.glsl)
 	m_mainShaderLocations.uMatrix = m_mainShader->uniformLocation("uMatrix");
 	m_mainShaderLocations.uNormalMatrix = m_mainShader->uniformLocation("uNormalMatrix");
-	if (m_mainShaderLocations.uProjMatrix < 0 || m_mainShaderLocations.uMatrix < 0 || m_mainShaderLocations.uNormalMatrix < 0) {
-		std::cerr << "Unable to find shader location for uProjMatrix, uMatrix or uNormalMatrix" << std::endl;
+	if (m_mainShaderLocations.uMatrix < 0 || m_mainShaderLocations.uNormalMatrix < 0) {
+		std::cerr << "Unable to find shader location for uMatrix or uNormalMatrix" << std::endl;
 		return 3;
 	}
 
@@ -136,11 +139,10 @@ int MainWindow::InitializeGL()
 	}
 
 	// Get locations of the uniform variables
-	m_pickingShaderLocations.uProjMatrix = m_pickingShader->uniformLocation("uProjMatrix");
 	m_pickingShaderLocations.uColor = m_pickingShader->uniformLocation("uColor");
 	m_pickingShaderLocations.uMatrix = m_pickingShader->uniformLocation("uMatrix");
-	if (m_pickingShaderLocations.uProjMatrix < 0 || m_pickingShaderLocations.uColor < 0 || m_pickingShaderLocations.uMatrix < 0) {
-		std::cerr << "Unable to find shader location for uProjMatrix, uColor or uMatrix" << std::endl;
+	if (m_pickingShaderLocations.uColor < 0 || m_pickingShaderLocations.uMatrix < 0) {
+		std::cerr << "Unable to find shader location for uColor or uMatrix" << std::endl;
 		return 3;
 	}
 
@@ -172,21 +174,24 @@ int MainWindow::InitializeGL()
 
 void MainWindow::RenderScene()
 {
+	PROFILE_SCOPE("RenderScene");
 	// Clear the buffers
 	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
+	// Camera matrices used by all the programs
+	m_cameraUBO.update(m_camera);
+	const glm::mat4& viewMatrix = m_camera.viewMatrix();
+
 	// Bind our vertex/fragment shaders
 	m_mainShader->bind();
 
 	// Draw the spirals
 	glBindVertexArray(m_VAOs[VAO_Spiral]);
-	m_mainShader->setMat4(m_mainShaderLocations.uProjMatrix, m_camera.projectionMatrix());
 
 	for (int i = 0; i < NbSpirals; ++i)
 	{
 
-		glm::mat4 currentTransformation = m_camera.viewMatrix();
-		currentTransformation = glm::translate(currentTransformation,
+		glm::mat4 currentTransformation = glm::translate(glm::mat4(1.0f),
 			// Translation vector
 			// based on spherical coordinates
 			glm::vec3(cos(2.0f * i * float(M_PI) / static_cast<float>(NbSpirals)), 
@@ -201,7 +206,7 @@ void MainWindow::RenderScene()
 
 		// Draw the spiral
 		m_mainShader->setMat4(m_mainShaderLocations.uMatrix, currentTransformation);
-		glm::mat3 NormalMat = glm::inverseTranspose(glm::mat3(currentTransformation));
+		glm::mat3 NormalMat = glm::inverseTranspose(glm::mat3(viewMatrix * currentTransformation));
 		m_mainShader->setMat3(m_mainShaderLocations.uNormalMatrix, NormalMat);
 
 		glDrawArrays(GL_TRIANGLE_STRIP, 0, NbVerticesSpiral);
@@ -215,8 +220,7 @@ void MainWindow::RenderScene()
 	// Draw the vector if one spiral is selected
 	if (m_selectedSpiral != -1) {
 		m_pickingShader->bind();
-		m_pickingShader->setMat4(m_pickingShaderLocations.uProjMatrix, m_camera.projectionMatrix());
-		m_pickingShader->setMat4(m_pickingShaderLocations.uMatrix, m_camera.viewMatrix());
+		m_pickingShader->setMat4(m_pickingShaderLocations.uMatrix, glm::mat4(1.0f));
 
 		glBindVertexArray(m_VAOs[VAO_Ray]);
 		m_pickingShader->setVec4(m_pickingShaderLocations.uColor, glm::vec4(0.9f, 0.2f, 0.1f, 1.0f));
@@ -229,11 +233,36 @@ void MainWindow::RenderScene()
 	glFlush();
 }
 
+void MainWindow::RenderImgui()
+{
+	PROFILE_SCOPE("RenderImgui");
+	// Start the Dear ImGui frame
+	ImGui_ImplOpenGL3_NewFrame();
+	ImGui_ImplGlfw_NewFrame();
+	ImGui::NewFrame();
+
+	// Shift + click to select a spiral: the hitches are annotated
+	m_frameStats.drawImgui();
+
+	ImGui::Render();
+	ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+}
+
 int MainWindow::RenderLoop()
 {
+	// Benchmark: play the camera path given on the command line
+	if (!Benchmark::settings().cameraPath.empty() && m_cameraPath.load(Benchmark::settings().cameraPath))
+		m_cameraPath.startPlayback();
+
 	float time = glfwGetTime();
+	bool traceKeyPressed = false;
+	bool syncKeyPressed = false;
+	bool recordKeyPressed = false;
+	bool playKeyPressed = false;
 	while (!glfwWindowShouldClose(m_window))
 	{
+		PROFILE_SCOPE("RenderLoop");
+		m_frameStats.beginFrame();
 		// Compute delta time between two frames
 		float new_time = glfwGetTime();
 		const float delta_time = new_time - time;
@@ -242,16 +271,66 @@ int MainWindow::RenderLoop()
 		// Check inputs: Does ESC was pressed?
 		if (glfwGetKey(m_window, GLFW_KEY_ESCAPE) == GLFW_PRESS)
 			glfwSetWindowShouldClose(m_window, true);
-		m_camera.keybordEvents(m_window, delta_time);
+		if (m_cameraPath.isPlaying())
+			m_cameraPath.step(m_camera);
+		else
+			m_camera.keybordEvents(m_window, delta_time);
+		m_cameraPath.record(m_camera, glfwGetTime());
+
+		// Camera path: R starts/stops the recording (saved in camera_path.bin)
+		// P plays the saved path
+		bool recordKey = glfwGetKey(m_window, GLFW_KEY_R) == GLFW_PRESS;
+		if (recordKey && !recordKeyPressed) {
+			if (m_cameraPath.isRecording()) {
+				m_cameraPath.stopRecording();
+				m_cameraPath.save("camera_path.bin");
+			} else {
+				m_cameraPath.startRecording();
+			}
+		}
+		recordKeyPressed = recordKey;
+		bool playKey = glfwGetKey(m_window, GLFW_KEY_P) == GLFW_PRESS;
+		if (playKey && !playKeyPressed && m_cameraPath.load("camera_path.bin"))
+			m_cameraPath.startPlayback();
+		playKeyPressed = playKey;
+
+		// Save the CPU trace when T is pressed
+		bool traceKey = glfwGetKey(m_window, GLFW_KEY_T) == GLFW_PRESS;
+		if (traceKey && !traceKeyPressed)
+			CpuProfiler::writeChromeTrace("cpu_trace.json");
+		traceKeyPressed = traceKey;
+
+		// Print the OpenGL synchronization points when G is pressed (ENABLE_GL_TRACE)
+		bool syncKey = glfwGetKey(m_window, GLFW_KEY_G) == GLFW_PRESS;
+		if (syncKey && !syncKeyPressed)
+			GLTrace::printSyncPoints();
+		syncKeyPressed = syncKey;
 
 		RenderScene();
+		RenderImgui();
+		GLTrace::endFrame();
+
+		// Frame measurements (benchmark mode, see Benchmark.h)
+		Benchmark::endFrame(m_window);
+
+		// Optional frame limiter (see the "Frame statistics" window)
+		m_frameStats.waitFrameLimit();
 
 		// Show rendering and get events
-		glfwSwapBuffers(m_window);
+		{
+			PROFILE_SCOPE("SwapBuffers");
+			m_frameStats.beginSwap();
+			glfwSwapBuffers(m_window);
+			m_frameStats.endSwap();
+		}
 		glfwPollEvents();
 	}
 
 	// Cleanup
+	m_cameraUBO.release();
+	ImGui_ImplOpenGL3_Shutdown();
+	ImGui_ImplGlfw_Shutdown();
+	ImGui::DestroyContext();
 	glfwDestroyWindow(m_window);
 	glfwTerminate();
 
@@ -366,6 +445,8 @@ int MainWindow::InitGeometrySpiral()
 
 void MainWindow::PerformSelection(int x, int y)
 {
+	PROFILE_SCOPE("PerformSelection");
+	m_frameStats.annotate("PerformSelection");
 	// Map (dictionnary) used to store the correspondences between colors and spiral number.
 	// This to found easily the object associated to a given color
 	struct compUVec4 {
@@ -399,14 +480,12 @@ void MainWindow::PerformSelection(int x, int y)
 	// Draw the spirals
 	// Note that we use dedicated VAO in this case
 	glBindVertexArray(m_VAOs[VAO_SpiralPicking]);
-	m_pickingShader->setMat4(m_pickingShaderLocations.uProjMatrix, m_camera.projectionMatrix());
+	// The camera may have moved since the last frame (mouse events)
+	m_cameraUBO.update(m_camera);
 	for (uint32_t id = 0; id < NbSpirals; ++id)
 	{
-		// Save transformations
-		glm::mat4 currentTransformation(m_camera.viewMatrix());
-
 		// Translate spiral
-		currentTransformation = glm::translate(currentTransformation,
+		glm::mat4 currentTransformation = glm::translate(glm::mat4(1.0f),
 			glm::vec3(cos(2.0f * id * float(M_PI) / static_cast<float>(NbSpirals)),sin(2.0f * id * float(M_PI) / static_cast<float>(NbSpirals)),0.0));
 
 		// For convenience, convert the ID to a color object.
@@ -486,6 +565,8 @@ void MainWindow::FramebufferSizeCallback(int width, int height) {
 }
 
 void MainWindow::CursorPositionCallback(double xpos, double ypos) {
+	if (m_cameraPath.isPlaying() || ImGui::GetIO().WantCaptureMouse)
+		return;
 	int state = glfwGetMouseButton(m_window, GLFW_MOUSE_BUTTON_LEFT);
 	m_camera.mouseEvents(glm::vec2(xpos, ypos), state == GLFW_PRESS);
 }
@@ -1,11 +1,12 @@
-#version 400 core
-uniform mat4 uMatrix;
-uniform mat4 uProjMatrix;
+#version 430 core
+
+#include "camera.glsl"
+
+uniform mat4 uMatrix; // Model matrix
 
 in vec4 vPosition;
 
 void main()
 {
-  gl_Position = uProjMatrix * uMatrix * vPosition;
+  gl_Position = camera.viewProjection * uMatrix * vPosition;
 }
-
@@ -1,7 +1,8 @@
-#version 400 core
+#version 430 core
 
-uniform mat4 uMatrix;
-uniform mat4 uProjMatrix;
+#include "camera.glsl"
+
+uniform mat4 uMatrix; // Model matrix
 uniform mat3 uNormalMatrix;
 
 in vec4 vPosition;
@@ -15,10 +16,9 @@ out vec3 fPosition;
 void
 main()
 {
-     vec4 vEyeCoord = uMatrix * vPosition;
-     gl_Position = uProjMatrix * vEyeCoord;
+     vec4 vEyeCoord = camera.view * uMatrix * vPosition;
+     gl_Position = camera.projection * vEyeCoord;
      fPosition = vEyeCoord.xyz;
      fNormal = uNormalMatrix*vNormal;
      ifColor = vColor;
 }
-
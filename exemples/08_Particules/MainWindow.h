@@ -6,61 +6,33 @@
 
 #include <iostream>
 #include <memory>
+#include <random>
+#include <thread>
 #include <vector>
 
 #include "ShaderProgram.h"
 #include "Camera.h"
-
-inline float random(float min, float max)
-{
-	return (max - min) * ((float)rand() / (float)RAND_MAX) + min;
-}
-
-
-// A simple particle object.
-struct Particle
+#include "CameraUBO.h"
+#include "CameraPath.h"
+#include "GpuTimer.h"
+#include "FrameStats.h"
+#include "FixedRateThread.h"
+#include "TripleBuffer.h"
+#include "StreamingBuffer.h"
+#include "JobSystem.h"
+#include "RadixSort.h"
+#include "ParticleSimulation.h"
+#include "CpuProfiler.h"
+#include "GLDebugSink.h"
+#include "GLTrace.h"
+
+// Values given by the render thread to the simulation thread
+struct SimulationInput
 {
-	// Attributes
-	glm::vec3 p = glm::vec3(0.0); // position
-	float life = 0.0f;			  // time to live
-	glm::vec3 v = glm::vec3(0.0); // velocity
-	float size = 0.1f;			  // scaling factor
-	glm::vec3 c = glm::vec3(0.0); // RGB color
-	float padd = 0.0f;			  // padding
-};
-
-struct ParticleGeneratorSettings {
-	float size = 0.4f;
-	float velocityMin = 5.0f;
-	float velocityMax = 10.0f;
-	float lifeMin = 0.1f;
-	float lifeMax = 1.0f;
-
-	void sanitize() {
-		size = std::max(size, 0.0001f);
-		velocityMin = std::max(velocityMin, 0.0f);
-		velocityMax = std::max(velocityMax, velocityMin);
-		lifeMin = std::max(lifeMin, 0.0f);
-		lifeMax = std::max(lifeMax, lifeMin);
-	}
-
-	Particle createNewParticle()
-	{
-		Particle p;
-		p.p = glm::vec3(0, 0, 0);
-		const float vx = random(-size, size);
-		const float vz = random(-size, size);
-		p.v = glm::vec3(vx, random(velocityMin, velocityMax), vz);
-		p.life = random(lifeMin, lifeMax);
-		const float r = random(0.5, 1.0);
-		const float g = random(0.0, 0.5);
-		const float b = random(0.0, 0.5);
-		p.c = glm::vec3(r, g, b);
-		p.size = random(0.1f, 0.25f);
-		return p;
-	}
-
-
+	glm::vec3 eye = glm::vec3(0.0);
+	float speed = 1.0f;
+	bool animate = true;
+	bool sort = true; // Back to front order (alpha blending only)
 };
 
 class MainWindow
@@ -84,6 +56,15 @@ private:
 	int InitializeGL();
 	void initializeParticles();
 
+	// CPU simulation thread (when the compute shader is not used)
+	// startSimulation restarts from the initial particles, runSimulation
+	// starts the thread with the current state (ex: new rate)
+	void startSimulation();
+	void runSimulation();
+	void stopSimulation();
+	void simulationStep(ParticleGeneratorSettings& settings, float dt);
+	void sortAndPublish(uint64_t step, bool sort);
+
 	// Rendering scene (OpenGL)
 	void RenderScene(float t);
 	void RenderImgui();
@@ -94,6 +75,8 @@ private:
 private:
 	// Camera
 	Camera m_camera;
+	CameraUBO m_cameraUBO;
+	CameraPath m_cameraPath;
 	bool m_imGuiActive = false;
 
 	// settings
@@ -110,37 +93,141 @@ private:
 	// Storage buffer
 	enum VAO_IDs { Particules, NumVAOs };
 	GLuint m_VAOs[NumVAOs];
-	GLuint m_particleBuffer;
-	GLuint m_spawnBuffer;
-	bool m_particleBufferCreated = true;
-
-	// Compute shader
+	GLuint m_particleBuffer = 0;
+	GLuint m_orderBuffer = 0; // (key, index) pairs sorted on the GPU
+	int m_orderCount = 0; // Power of 2
+	int m_particleCapacity = 0; // Particles (grows geometrically)
+	int m_orderCapacity = 0;
+
+	// Compute shader: GPU emitter, dead stack and alive lists (ping-pong)
+	// Counters and indirect commands are written by the GPU (no readback)
 	std::unique_ptr<ShaderProgram> m_computeShader = nullptr;
 	struct {
 		GLint dt;
 		GLint gravity;
+		GLint mode;
+		GLint emit;
+		GLint seed;
+		GLint spawnSize;
+		GLint velocityRange;
+		GLint lifeRange;
+		GLint packed;
 	} m_computeUniforms;
+	GLuint m_deadBuffer = 0;
+	GLuint m_aliveBuffers[2] = { 0, 0 };
+	GLuint m_counterBuffer = 0;
+	int m_aliveCurrent = 0; // Alive list at the start of the frame
+	float m_emitRate = 0.0f; // Particles per second
+	float m_emitAccumulator = 0.0f;
+	uint32_t m_emitFrame = 0; // Seed of the emission: Random::key(m_seed, frame)
+	void simulateParticlesGPU(float dt);
+	void bindAliveLists();
+
+	// Particle interactions (compute mode): uniform grid of the alive particles
+	// rebuilt each frame (cell of each particle, prefix sum of the cell counts,
+	// indices sorted by cell), then a separation force between the neighbors
+	// closer than the interaction radius (the size of the cells)
+	std::unique_ptr<ShaderProgram> m_gridShader = nullptr;
+	struct {
+		GLint mode;
+		GLint origin;
+		GLint cellSize;
+		GLint dt;
+		GLint strength;
+		GLint packed;
+	} m_gridUniforms;
+	static constexpr int GridSize = 64; // Cells per axis (GRID in particules_grid.comp)
+	GLuint m_particleCellBuffer = 0; // Cell and rank of each alive particle
+	GLuint m_sortedBuffer = 0;       // Particles sorted by cell
+	GLuint m_cellCountBuffer = 0;
+	GLuint m_cellStartBuffer = 0;
+	GLuint m_blockSumBuffer = 0;
+	bool m_useInteraction = false;
+	float m_interactionRadius = 0.1f;
+	float m_interactionStrength = 2.0f; // Acceleration at contact (units/s^2)
+	void interactParticlesGPU(float dt);
+
+	// Back to front sort on the GPU (compute mode)
+	std::unique_ptr<ShaderProgram> m_sortShader = nullptr;
+	struct {
+		GLint mode;
+		GLint stage;
+		GLint pass;
+		GLint packed;
+	} m_sortUniforms;
+	void sortParticlesGPU();
 	
 	// Particules
 	ParticleGeneratorSettings m_settings;
-	std::vector<Particle> m_particles;
-	bool m_useAdditiveBlending = true;
+	std::vector<Particle> m_particles; // Initial state (GPU buffers and CPU simulation)
+	// Transparency: alpha blending (sorted back to front), additive blending
+	// or weighted blended OIT (McGuire and Bavoil 2013), both without any sort
+	enum BlendMode { BlendAlpha, BlendAdditive, BlendWeighted, NumBlendModes };
+	int m_blendMode = BlendAdditive;
 	int m_numberParticles = 3000;
 	float m_speed = 1.0f;
 	float m_size = 0.05f;
 	float m_transparency = 1.0f;
 	bool m_useTexture = false;
 	bool m_useCompute = false;
+	uint32_t m_seed = 1; // The initial particles only depend on the seed
+	// Compact particles in the SSBO (PackedParticle, 24 bytes), in both modes
+	bool m_usePackedParticles = false;
+	std::size_t particleStride() const { return m_usePackedParticles ? sizeof(PackedParticle) : sizeof(Particle); }
 
 	// Shader
-	std::unique_ptr<ShaderProgram> m_mainShader = nullptr;
-	struct {
-		GLint viewMatrix;
-		GLint projMatrix;
+	// Billboards: points expanded by a geometry shader (m_mainShader), or
+	// quads built in the vertex shader from the SSBO (m_quadShader, no VBO)
+	struct MainUniforms {
 		GLint globalSize;
 		GLint globalTransparency;
 		GLint texture;
 		GLint useTexture;
 		GLint time;
-	} m_mainUniforms;
+		GLint useOrder;
+		GLint packed;
+		GLint weighted;
+	};
+	std::unique_ptr<ShaderProgram> m_mainShader = nullptr;
+	MainUniforms m_mainUniforms;
+	std::unique_ptr<ShaderProgram> m_quadShader = nullptr;
+	MainUniforms m_quadUniforms;
+	bool m_useVertexPulling = false;
+	static bool loadMainUniforms(ShaderProgram& shader, MainUniforms& uniforms);
+
+	// Weighted blended OIT: accumulation (RGBA16F) and revealage (R8) targets,
+	// then a fullscreen composite over the frame (window size)
+	std::unique_ptr<ShaderProgram> m_compositeShader = nullptr;
+	GLuint m_weightedFBO = 0;
+	GLuint m_weightedTextures[2] = { 0, 0 };
+	int m_weightedWidth = 0;
+	int m_weightedHeight = 0;
+	void resizeWeightedTargets(int width, int height);
+
+	// GPU timings (compute dispatch vs draw)
+	GpuProfiler m_gpuProfiler;
+	// Frame times, hitches and frame pacing
+	FrameStats m_frameStats;
+
+	// Simulation at a fixed rate on its own thread, the sorted particles are
+	// written straight into a persistently mapped buffer (3 regions guarded by
+	// fences), the render thread draws the newest region
+	FixedRateThread m_simulation;
+	float m_simulationRate = 60.0f;
+	StreamingBuffer m_particleStream;
+	TripleBuffer<SimulationInput> m_simulationInputs;
+	uint64_t m_uploadedStep = 0;
+	uint64_t m_simulationStep = 0;
+
+	// State of the CPU simulation (SoA, owned by the simulation thread when it runs)
+	// and back to front sort (radix sort on the job system)
+	// Double buffered: the state of step N is sorted while step N+1 is simulated
+	ParticleArrays m_state;
+	ParticleArrays m_nextState;
+	std::vector<uint32_t> m_sortKeys;
+	std::vector<uint32_t> m_nextSortKeys;
+	RadixSort m_sorter;
+	JobCounter m_sortDone;
+	std::vector<uint32_t> m_identityOrder; // Published order without sort
+	bool m_publishPacked = false; // Layout written by the simulation (copy made at the start)
 };
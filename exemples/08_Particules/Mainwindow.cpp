@@ -1,4 +1,5 @@
 #include "MainWindow.h"
+#include "Benchmark.h"
 
 #include "imgui.h"
 #include "imgui_impl_glfw.h"
@@ -7,9 +8,9 @@
 #include <glm/gtc/matrix_transform.hpp>
 
 #include <algorithm>
+#include <numeric>
 
 // For images
-#define STB_IMAGE_IMPLEMENTATION
 #include <stb_image.h>
 
 #define BUFFER_OFFSET(i) ((char *)NULL + (i))
@@ -40,6 +41,9 @@ int MainWindow::Initialisation()
 	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
 	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 6);
 	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+#ifdef _DEBUG
+	glfwWindowHint(GLFW_OPENGL_DEBUG_CONTEXT, true);  // For debug callback 
+#endif
 
 #ifdef __APPLE__
 	glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
@@ -47,7 +51,7 @@ int MainWindow::Initialisation()
 
 	// glfw window creation
 	// --------------------
-	m_window = glfwCreateWindow(m_windowWidth, m_windowHeight, "Particules", NULL, NULL);
+	m_window = Benchmark::createWindow(m_windowWidth, m_windowHeight, "Particules");
 	if (m_window == NULL)
 	{
 		std::cerr << "Failed to create GLFW window" << std::endl;
@@ -60,11 +64,21 @@ int MainWindow::Initialisation()
 
 	// glad: load all OpenGL function pointers
 	// ---------------------------------------
-	if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
+	if (!gladLoadGLLoader((GLADloadproc)Benchmark::getProcAddress))
 	{
 		std::cerr << "Failed to initialize GLAD" << std::endl;
 		return 2;
 	}
+	// Count the OpenGL calls (only if compiled with ENABLE_GL_TRACE)
+	GLTrace::install();
+
+#ifdef _DEBUG
+	// Debug messages (including performance warnings) are rate limited
+	// and printed at the end of each frame
+	if (GLDebugSink::install()) {
+		std::cout << "Debug context created\n";
+	}
+#endif
 
 	// imGui: create interface
 	// ---------------------------------------
@@ -112,18 +126,37 @@ int MainWindow::InitializeGL()
 		return 4;
 	}
 
-	m_mainUniforms.projMatrix = m_mainShader->uniformLocation("projMatrix");
-	m_mainUniforms.viewMatrix = m_mainShader->uniformLocation("viewMatrix");
-	m_mainUniforms.globalSize = m_mainShader->uniformLocation("globalSize");
-	m_mainUniforms.globalTransparency = m_mainShader->uniformLocation("globalTransparency");
-	m_mainUniforms.texture = m_mainShader->uniformLocation("texture");
-	m_mainUniforms.useTexture = m_mainShader->uniformLocation("useTexture");
-	m_mainUniforms.time = m_mainShader->uniformLocation("time");	
-	if(m_mainUniforms.projMatrix == -1 || m_mainUniforms.viewMatrix == -1 || m_mainUniforms.globalSize == -1 || m_mainUniforms.globalTransparency == -1 || m_mainUniforms.texture == -1 || m_mainUniforms.useTexture == -1 || m_mainUniforms.time == -1) {
+	if (!loadMainUniforms(*m_mainShader, m_mainUniforms)) {
 		std::cerr << "Error when loading main shader uniforms\n";
 		return 5;
 	}
 
+	// Quads without geometry shader (same fragment shader)
+	bool quadShaderSuccess = true;
+	m_quadShader = std::make_unique<ShaderProgram>();
+	quadShaderSuccess &= m_quadShader->addShaderFromSource(GL_VERTEX_SHADER, directory + "particules_quad.vert");
+	quadShaderSuccess &= m_quadShader->addShaderFromSource(GL_FRAGMENT_SHADER, directory + "particules.frag");
+	quadShaderSuccess &= m_quadShader->link();
+	if (!quadShaderSuccess) {
+		std::cerr << "Error when loading quad shader\n";
+		return 4;
+	}
+	if (!loadMainUniforms(*m_quadShader, m_quadUniforms)) {
+		std::cerr << "Error when loading quad shader uniforms\n";
+		return 5;
+	}
+
+	// Composite of the weighted blended OIT
+	bool compositeShaderSuccess = true;
+	m_compositeShader = std::make_unique<ShaderProgram>();
+	compositeShaderSuccess &= m_compositeShader->addShaderFromSource(GL_VERTEX_SHADER, directory + "particules_oit.vert");
+	compositeShaderSuccess &= m_compositeShader->addShaderFromSource(GL_FRAGMENT_SHADER, directory + "particules_oit.frag");
+	compositeShaderSuccess &= m_compositeShader->link();
+	if (!compositeShaderSuccess) {
+		std::cerr << "Error when loading composite shader\n";
+		return 4;
+	}
+
 	// Create compute 
 	bool computeShaderSuccess = true;
 	m_computeShader = std::make_unique<ShaderProgram>();
@@ -135,12 +168,71 @@ int MainWindow::InitializeGL()
 	}
 	m_computeUniforms.dt = m_computeShader->uniformLocation("dt");
 	m_computeUniforms.gravity = m_computeShader->uniformLocation("gravity");
-	if(m_computeUniforms.dt == -1 || m_computeUniforms.gravity == -1) {
+	m_computeUniforms.mode = m_computeShader->uniformLocation("mode");
+	m_computeUniforms.emit = m_computeShader->uniformLocation("emit");
+	m_computeUniforms.seed = m_computeShader->uniformLocation("seed");
+	m_computeUniforms.spawnSize = m_computeShader->uniformLocation("spawnSize");
+	m_computeUniforms.velocityRange = m_computeShader->uniformLocation("velocityRange");
+	m_computeUniforms.lifeRange = m_computeShader->uniformLocation("lifeRange");
+	m_computeUniforms.packed = m_computeShader->uniformLocation("packedParticles");
+	if(m_computeUniforms.dt == -1 || m_computeUniforms.gravity == -1 || m_computeUniforms.mode == -1 || m_computeUniforms.emit == -1
+		|| m_computeUniforms.seed == -1 || m_computeUniforms.spawnSize == -1 || m_computeUniforms.velocityRange == -1 || m_computeUniforms.lifeRange == -1
+		|| m_computeUniforms.packed == -1) {
 		std::cerr << "Error when loading compute shader uniforms\n";
 		std::cerr << "dt: " << m_computeUniforms.dt << " gravity: " << m_computeUniforms.gravity << std::endl;
 		return 7;
 	}
 
+	// Uniform grid and interactions of the particles (compute mode)
+	bool gridShaderSuccess = true;
+	m_gridShader = std::make_unique<ShaderProgram>();
+	gridShaderSuccess &= m_gridShader->addShaderFromSource(GL_COMPUTE_SHADER, directory + "particules_grid.comp");
+	gridShaderSuccess &= m_gridShader->link();
+	if (!gridShaderSuccess) {
+		std::cerr << "Error when loading grid shader\n";
+		return 10;
+	}
+	m_gridUniforms.mode = m_gridShader->uniformLocation("mode");
+	m_gridUniforms.origin = m_gridShader->uniformLocation("gridOrigin");
+	m_gridUniforms.cellSize = m_gridShader->uniformLocation("cellSize");
+	m_gridUniforms.dt = m_gridShader->uniformLocation("dt");
+	m_gridUniforms.strength = m_gridShader->uniformLocation("strength");
+	m_gridUniforms.packed = m_gridShader->uniformLocation("packedParticles");
+	if(m_gridUniforms.mode == -1 || m_gridUniforms.origin == -1 || m_gridUniforms.cellSize == -1 || m_gridUniforms.dt == -1
+		|| m_gridUniforms.strength == -1 || m_gridUniforms.packed == -1) {
+		std::cerr << "Error when loading grid shader uniforms\n";
+		return 11;
+	}
+
+	// Sort of the particles (compute mode)
+	bool sortShaderSuccess = true;
+	m_sortShader = std::make_unique<ShaderProgram>();
+	sortShaderSuccess &= m_sortShader->addShaderFromSource(GL_COMPUTE_SHADER, directory + "particules_sort.comp");
+	sortShaderSuccess &= m_sortShader->link();
+	if (!sortShaderSuccess) {
+		std::cerr << "Error when loading sort shader\n";
+		return 8;
+	}
+	m_sortUniforms.mode = m_sortShader->uniformLocation("mode");
+	m_sortUniforms.stage = m_sortShader->uniformLocation("sortStage");
+	m_sortUniforms.pass = m_sortShader->uniformLocation("sortPass");
+	m_sortUniforms.packed = m_sortShader->uniformLocation("packedParticles");
+	if(m_sortUniforms.mode == -1 || m_sortUniforms.stage == -1 || m_sortUniforms.pass == -1 || m_sortUniforms.packed == -1) {
+		std::cerr << "Error when loading sort shader uniforms\n";
+		return 9;
+	}
+
+
+	// Benchmark scenes (--set particles=N --set seed=S --set compute=1 --set additive=0 --set blend=2 --set quads=1 --set packed=1
+	// --set interact=1)
+	m_numberParticles = Benchmark::option("particles", m_numberParticles);
+	m_seed = uint32_t(Benchmark::option("seed", int(m_seed)));
+	m_usePackedParticles = Benchmark::option("packed", m_usePackedParticles ? 1 : 0) != 0;
+	m_useVertexPulling = Benchmark::option("quads", m_useVertexPulling ? 1 : 0) != 0;
+	m_useCompute = Benchmark::option("compute", m_useCompute ? 1 : 0) != 0;
+	m_useInteraction = Benchmark::option("interact", m_useInteraction ? 1 : 0) != 0;
+	m_blendMode = Benchmark::option("additive", m_blendMode == BlendAdditive ? 1 : 0) != 0 ? BlendAdditive : BlendAlpha;
+	m_blendMode = std::clamp(Benchmark::option("blend", m_blendMode), 0, NumBlendModes - 1);
 
 	// Create the VAO
 	glCreateVertexArrays(1, m_VAOs);
@@ -192,25 +284,210 @@ int MainWindow::InitializeGL()
 
 void MainWindow::initializeParticles()
 {
+	PROFILE_SCOPE("initializeParticles");
+	m_frameStats.annotate("initializeParticles");
+	// The simulation thread uses the particles
+	stopSimulation();
 	std::cout << "Initialize the particules ... " << m_numberParticles << "\n";
 	m_particles.resize(m_numberParticles);
+	JobSystem::instance().parallelFor(0, m_numberParticles, [this](int begin, int end) {
+		m_settings.createNewParticles(m_seed, uint32_t(begin), m_particles.data() + begin, std::size_t(end - begin));
+	});
+
+	// The buffers grow geometrically: they are only recreated when the
+	// number of particles is larger than their capacity
+	// The buffers can hold the particles in both layouts
+	const std::size_t bytes = m_numberParticles * particleStride();
+	if (m_numberParticles > m_particleCapacity) {
+		if (m_particleCapacity > 0) {
+			glDeleteBuffers(1, &m_particleBuffer);
+			glDeleteBuffers(1, &m_deadBuffer);
+			glDeleteBuffers(2, m_aliveBuffers);
+			glDeleteBuffers(1, &m_particleCellBuffer);
+			glDeleteBuffers(1, &m_sortedBuffer);
+		}
+		m_particleCapacity = std::max(m_numberParticles, 2 * m_particleCapacity);
+		std::cout << " - Create buffer of size: " << m_particleCapacity * sizeof(Particle) << "\n";
+		glCreateBuffers(1, &m_particleBuffer);
+		glCreateBuffers(1, &m_deadBuffer);
+		glCreateBuffers(2, m_aliveBuffers);
+		glNamedBufferStorage(m_particleBuffer, m_particleCapacity * sizeof(Particle), nullptr, GL_DYNAMIC_STORAGE_BIT);
+		glNamedBufferStorage(m_deadBuffer, m_particleCapacity * sizeof(GLuint), nullptr, 0);
+		// Count, then the indices
+		for (GLuint buffer : m_aliveBuffers)
+			glNamedBufferStorage(buffer, (m_particleCapacity + 1) * sizeof(GLuint), nullptr, GL_DYNAMIC_STORAGE_BIT);
+		glCreateBuffers(1, &m_particleCellBuffer);
+		glCreateBuffers(1, &m_sortedBuffer);
+		glNamedBufferStorage(m_particleCellBuffer, m_particleCapacity * 2 * sizeof(GLuint), nullptr, 0);
+		glNamedBufferStorage(m_sortedBuffer, m_particleCapacity * sizeof(GLuint), nullptr, 0);
+	}
+	if (m_counterBuffer == 0) {
+		glCreateBuffers(1, &m_counterBuffer);
+		glNamedBufferStorage(m_counterBuffer, 24 * sizeof(GLuint), nullptr, GL_DYNAMIC_STORAGE_BIT);
+		// Grid: one count and one start per cell, one sum per block of 512 cells
+		const GLsizeiptr cells = GLsizeiptr(GridSize) * GridSize * GridSize;
+		glCreateBuffers(1, &m_cellCountBuffer);
+		glCreateBuffers(1, &m_cellStartBuffer);
+		glCreateBuffers(1, &m_blockSumBuffer);
+		glNamedBufferStorage(m_cellCountBuffer, cells * sizeof(GLuint), nullptr, 0);
+		glNamedBufferStorage(m_cellStartBuffer, cells * sizeof(GLuint), nullptr, 0);
+		glNamedBufferStorage(m_blockSumBuffer, (cells / 512) * sizeof(GLuint), nullptr, 0);
+		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 7, m_cellCountBuffer);
+		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 8, m_cellStartBuffer);
+		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 9, m_blockSumBuffer);
+	}
+	if (m_usePackedParticles) {
+		std::vector<PackedParticle> packed(m_particles.size());
+		JobSystem::instance().parallelFor(0, m_numberParticles, [&](int begin, int end) {
+			for (int i = begin; i < end; ++i)
+				packed[i] = ParticleSimulation::pack(m_particles[i]);
+		});
+		glNamedBufferSubData(m_particleBuffer, 0, bytes, (const void*)packed.data());
+	} else {
+		glNamedBufferSubData(m_particleBuffer, 0, bytes, (const void*)m_particles.data());
+	}
+	// The shaders use data.length(): only the used part is bound
+	glBindBufferRange(GL_SHADER_STORAGE_BUFFER, 0, m_particleBuffer, 0, bytes);
+	glBindBufferRange(GL_SHADER_STORAGE_BUFFER, 1, m_deadBuffer, 0, m_numberParticles * sizeof(GLuint));
+	glBindBufferRange(GL_SHADER_STORAGE_BUFFER, 6, m_particleCellBuffer, 0, m_numberParticles * 2 * sizeof(GLuint));
+	glBindBufferRange(GL_SHADER_STORAGE_BUFFER, 10, m_sortedBuffer, 0, m_numberParticles * sizeof(GLuint));
+
+	// GPU emitter: all the particles are alive at the start, the emission
+	// rate keeps about the same number of particles (mean life)
+	std::vector<GLuint> alive(m_numberParticles + 1);
+	alive[0] = GLuint(m_numberParticles);
 	for (int i = 0; i < m_numberParticles; ++i)
+		alive[i + 1] = GLuint(i);
+	glNamedBufferSubData(m_aliveBuffers[0], 0, alive.size() * sizeof(GLuint), alive.data());
+	const GLuint counters[24] = {
+		0, 0, 0, 0,                           // Dead count, emission
+		0, 1, 1, 0,                           // Emission dispatch
+		0, 1, 1, 0,                           // Simulation dispatch
+		GLuint(m_numberParticles), 1, 0, 0,     // Draw (points)
+		4, GLuint(m_numberParticles), 0, 0,     // Draw (quads)
+		0, 1, 1, 0                            // Grid dispatch
+	};
+	glNamedBufferSubData(m_counterBuffer, 0, sizeof(counters), counters);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 5, m_counterBuffer);
+	m_aliveCurrent = 0;
+	bindAliveLists();
+	m_emitRate = m_numberParticles / (0.5f * (m_settings.lifeMin + m_settings.lifeMax) + 1e-3f);
+	m_emitAccumulator = 0.0f;
+	m_emitFrame = 0;
+	// Bitonic sort: power of 2, at least one block of 512 pairs
+	m_orderCount = 512;
+	while (m_orderCount < m_numberParticles)
+		m_orderCount *= 2;
+	if (m_orderCount > m_orderCapacity) {
+		if (m_orderCapacity > 0)
+			glDeleteBuffers(1, &m_orderBuffer);
+		m_orderCapacity = m_orderCount;
+		glCreateBuffers(1, &m_orderBuffer);
+		glNamedBufferStorage(m_orderBuffer, m_orderCapacity * 2 * sizeof(GLuint), nullptr, 0);
+	}
+	glBindBufferRange(GL_SHADER_STORAGE_BUFFER, 2, m_orderBuffer, 0, m_orderCount * 2 * sizeof(GLuint));
+	// CPU mode: regions written by the simulation
+	m_particleStream.reserve(bytes);
+
+	if (!m_useCompute)
+		startSimulation();
+}
+
+void MainWindow::startSimulation()
+{
+	stopSimulation();
+	// The particles of the previous simulation are not drawn anymore
+	m_particleStream.reserve(m_numberParticles * particleStride());
+	m_publishPacked = m_usePackedParticles;
+	SimulationInput input;
+	input.eye = m_camera.position();
+	input.speed = m_speed;
+	input.animate = m_animate;
+	input.sort = m_blendMode == BlendAlpha;
+	m_simulationInputs.reset(input);
+	m_uploadedStep = 0;
+	m_simulationStep = 0;
+	m_state.assign(m_particles.data(), m_particles.size());
+	runSimulation();
+}
+
+void MainWindow::runSimulation()
+{
+	// The thread uses its own copy of the generator settings
+	// (a change of the settings restarts the simulation)
+	ParticleGeneratorSettings settings = m_settings;
+	m_simulation.start("Simulation", m_simulationRate, [this, settings](double dt) mutable {
+		simulationStep(settings, float(dt));
+	});
+}
+
+void MainWindow::stopSimulation()
+{
+	m_simulation.stop();
+	// The sort of the last step can still run on the workers
+	JobSystem::instance().wait(m_sortDone);
+}
+
+void MainWindow::simulationStep(ParticleGeneratorSettings& settings, float dt)
+{
+	// Note: executed by the simulation thread
+	PROFILE_SCOPE("Simulation step");
+	m_simulationInputs.update();
+	const SimulationInput& input = m_simulationInputs.readBuffer();
+
+	JobSystem& jobs = JobSystem::instance();
 	{
-		m_particles[i] = m_settings.createNewParticle();
+		PROFILE_SCOPE("Update particles");
+		ParticleStep params;
+		params.dt = dt * input.speed;
+		params.eye = input.eye;
+		params.animate = input.animate;
+		params.settings = settings;
+		// Same seeds for the same step: the respawns only depend on m_seed
+		params.seed = Random::key(m_seed, uint32_t(m_simulationStep));
+		// The next state is written in the other buffer (the previous state can
+		// still be sorted), with the sort keys: distance from the camera, far first
+		// The particles are independent: update them with all the cores (SIMD)
+		m_nextSortKeys.resize(m_state.capacity());
+		ParticleSimulation::step(m_state, m_nextState, m_nextSortKeys.data(), params);
 	}
 
-	if(m_particleBufferCreated) {
-		glDeleteBuffers(1, &m_particleBuffer);
-		glDeleteBuffers(1, &m_spawnBuffer);
+	// The sort of the previous step is done with m_state
+	jobs.wait(m_sortDone);
+	std::swap(m_state, m_nextState);
+	std::swap(m_sortKeys, m_nextSortKeys);
+
+	// Sort according to distance from the camera (for the alpha blending) and
+	// give the new state to the render thread, during the next step
+	const uint64_t step = ++m_simulationStep;
+	const bool sort = input.sort;
+	jobs.run([this, step, sort]() { sortAndPublish(step, sort); }, &m_sortDone);
+}
+
+void MainWindow::sortAndPublish(uint64_t step, bool sort)
+{
+	// Note: executed by the job system (one sort at a time)
+	PROFILE_SCOPE("Sort");
+	// The additive blending and the OIT do not depend on the order
+	const uint32_t* order = nullptr;
+	if (sort) {
+		order = m_sorter.sort(m_sortKeys.data(), m_state.count).data();
+	} else {
+		if (m_identityOrder.size() != m_state.count) {
+			m_identityOrder.resize(m_state.count);
+			std::iota(m_identityOrder.begin(), m_identityOrder.end(), 0u);
+		}
+		order = m_identityOrder.data();
+	}
+	// Interleaved particles in the sorted order, written straight into the
+	// mapped buffer (skipped if the GPU still reads all the regions)
+	if (void* region = m_particleStream.beginWrite()) {
+		if (m_publishPacked)
+			ParticleSimulation::pack(m_state, order, static_cast<PackedParticle*>(region));
+		else
+			ParticleSimulation::interleave(m_state, order, static_cast<Particle*>(region));
+		m_particleStream.endWrite(step);
 	}
-	glCreateBuffers(1, &m_particleBuffer);
-	glCreateBuffers(1, &m_spawnBuffer);
-	std::cout << " - Create buffer of size: " << m_numberParticles * sizeof(Particle) << "\n";
-	glNamedBufferStorage(m_particleBuffer, m_numberParticles * sizeof(Particle), (const void*)m_particles.data(), GL_DYNAMIC_STORAGE_BIT);
-	glNamedBufferStorage(m_spawnBuffer, m_numberParticles * sizeof(Particle), (const void*)m_particles.data(), GL_DYNAMIC_STORAGE_BIT);
-	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, m_particleBuffer);
-	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, m_spawnBuffer);
-	m_particleBufferCreated = true;
 }
 
 #include <imgui_internal.h>
@@ -224,6 +501,7 @@ void ResetImGuiFramerateMovingAverage()
 
 void MainWindow::RenderImgui()
 {
+	PROFILE_SCOPE("RenderImgui");
 	// Start the Dear ImGui frame
 	ImGui_ImplOpenGL3_NewFrame();
 	ImGui_ImplGlfw_NewFrame();
@@ -236,7 +514,8 @@ void MainWindow::RenderImgui()
             1000.0/double(ImGui::GetIO().Framerate), double(ImGui::GetIO().Framerate));
 
 		ImGui::Checkbox("Animate", &m_animate);
-		ImGui::Checkbox("Additive blend", &m_useAdditiveBlending);
+		ImGui::Combo("Blending", &m_blendMode, "Alpha (sorted)\0Additive\0Weighted OIT\0");
+		ImGui::Checkbox("Vertex pulling (no geometry shader)", &m_useVertexPulling);
 
 		// if (ImGui::InputInt("Number particules", &m_numberParticles)) {
 		// 	m_numberParticles = std::max(0, m_numberParticles);
@@ -276,6 +555,38 @@ void MainWindow::RenderImgui()
 			initializeParticles();
 			ResetImGuiFramerateMovingAverage();
 		}
+		// The particles are recreated in the other layout
+		if (m_useCompute) {
+			ImGui::Checkbox("Particle interaction (uniform grid)", &m_useInteraction);
+			if (m_useInteraction) {
+				ImGui::InputFloat("Interaction radius", &m_interactionRadius);
+				ImGui::InputFloat("Interaction strength", &m_interactionStrength);
+				m_interactionRadius = std::max(0.001f, m_interactionRadius);
+			}
+		}
+		if (ImGui::Checkbox("Packed particles", &m_usePackedParticles)) {
+			initializeParticles();
+			ResetImGuiFramerateMovingAverage();
+		}
+		ImGui::SameLine();
+		ImGui::Text("(%d bytes/particle)", int(particleStride()));
+		if (m_useCompute) {
+			ImGui::InputFloat("Emission (particles/s)", &m_emitRate);
+			m_emitRate = std::max(0.f, m_emitRate);
+		} else {
+			// The thread is restarted at the end of the edition (the particles are kept)
+			ImGui::SliderFloat("Simulation rate (Hz)", &m_simulationRate, 10.0f, 240.0f, "%.0f");
+			if (ImGui::IsItemDeactivatedAfterEdit()) {
+				stopSimulation();
+				runSimulation();
+			}
+			ImGui::Text("Simulation: %.1f steps/s (dropped %llu), step %llu",
+				m_simulation.measuredRate(), (unsigned long long)m_simulation.droppedSteps(),
+				(unsigned long long)m_uploadedStep);
+			ImGui::Text("Streaming: %llu regions written, %llu skipped (GPU busy)",
+				(unsigned long long)m_particleStream.writtenRegions(), (unsigned long long)m_particleStream.skippedWrites());
+			ImGui::Text("Integrator: %s, %d job threads", ParticleSimulation::instructionSet(), JobSystem::instance().threadCount());
+		}
 		m_speed = std::max(0.f, m_speed);
 		m_size = std::max(0.000001f, m_size);
 		m_transparency = std::max(0.f, std::min(1.f, m_transparency));
@@ -287,7 +598,7 @@ void MainWindow::RenderImgui()
 		ImGui::Text("Velocity:");
 		changed |= ImGui::InputFloat("v_min: ", &m_settings.velocityMin);
 		changed |= ImGui::InputFloat("v_max", &m_settings.velocityMax);
-		ImGui::Text("Life:");
+		ImGui::Text("Life (max %.0f s):", PackedParticle::MaxLife);
 		changed |= ImGui::InputFloat("l_min", &m_settings.lifeMin);
 		changed |= ImGui::InputFloat("l_max", &m_settings.lifeMax);
 		m_settings.sanitize();
@@ -297,6 +608,14 @@ void MainWindow::RenderImgui()
 
 		ImGui::End();
 	}
+	m_gpuProfiler.drawImgui();
+	m_frameStats.drawImgui();
+	CpuProfiler::drawImgui();
+	GLTrace::drawImgui();
+	m_cameraPath.drawImgui();
+#ifdef _DEBUG
+	GLDebugSink::instance().drawImgui();
+#endif
 
 	ImGui::Render();
 	ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
@@ -305,19 +624,37 @@ void MainWindow::RenderImgui()
 
 void MainWindow::RenderScene(float time)
 {
+	PROFILE_SCOPE("RenderScene");
+	GpuTimer timer(m_gpuProfiler, "Draw");
 	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-	m_mainShader->bind();
-	m_mainShader->setMat4(m_mainUniforms.projMatrix, m_camera.projectionMatrix());
-	m_mainShader->setMat4(m_mainUniforms.viewMatrix, m_camera.viewMatrix());
-	m_mainShader->setFloat(m_mainUniforms.globalSize, m_size);
-	m_mainShader->setFloat(m_mainUniforms.globalTransparency, m_transparency);
-	m_mainShader->setFloat(m_mainUniforms.time, glfwGetTime() * 2.f);
+	m_cameraUBO.update(m_camera);
+	ShaderProgram& shader = m_useVertexPulling ? *m_quadShader : *m_mainShader;
+	const MainUniforms& uniforms = m_useVertexPulling ? m_quadUniforms : m_mainUniforms;
+	shader.bind();
+	shader.setFloat(uniforms.globalSize, m_size);
+	shader.setFloat(uniforms.globalTransparency, m_transparency);
+	shader.setFloat(uniforms.time, glfwGetTime() * 2.f);
 	glEnable(GL_BLEND);
 	// Choose the blending method
-	if (m_useAdditiveBlending)
+	if (m_blendMode == BlendAdditive)
 	{
 		glBlendFunc(GL_SRC_ALPHA, GL_ONE);
 	}
+	else if (m_blendMode == BlendWeighted)
+	{
+		// Weighted sum of the colors and product of the (1 - alpha) in
+		// offscreen targets, composited after the particles
+		int width = 0, height = 0;
+		glfwGetFramebufferSize(m_window, &width, &height);
+		resizeWeightedTargets(width, height);
+		const GLfloat accumulationClear[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+		const GLfloat revealageClear[4] = { 1.0f, 1.0f, 1.0f, 1.0f };
+		glClearNamedFramebufferfv(m_weightedFBO, GL_COLOR, 0, accumulationClear);
+		glClearNamedFramebufferfv(m_weightedFBO, GL_COLOR, 1, revealageClear);
+		glBindFramebuffer(GL_FRAMEBUFFER, m_weightedFBO);
+		glBlendFunci(0, GL_ONE, GL_ONE);
+		glBlendFunci(1, GL_ZERO, GL_ONE_MINUS_SRC_COLOR);
+	}
 	else
 	{
 		glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
@@ -326,81 +663,316 @@ void MainWindow::RenderScene(float time)
 	// Activate and use texture unit 0
 	glActiveTexture(GL_TEXTURE0);
 	glBindTexture(GL_TEXTURE_2D, m_textureID);
-	m_mainShader->setInt(m_mainUniforms.texture, 0); // Unit 0
-	m_mainShader->setBool(m_mainUniforms.useTexture, m_useTexture);
+	shader.setInt(uniforms.texture, 0); // Unit 0
+	shader.setBool(uniforms.useTexture, m_useTexture);
+	shader.setBool(uniforms.packed, m_usePackedParticles);
+	shader.setBool(uniforms.weighted, m_blendMode == BlendWeighted);
+
+	// Compute mode: alive particles, sorted back to front (not needed by
+	// the additive blending and the OIT)
+	// In CPU mode, the particles are sorted by the simulation thread
+	if (m_useCompute)
+		sortParticlesGPU();
+	shader.setBool(uniforms.useOrder, m_useCompute);
+
+	// CPU mode: newest region written by the simulation
+	const GLsizeiptr bytes = m_numberParticles * particleStride();
+	const bool streamed = !m_useCompute && m_particleStream.hasData();
+	if (streamed)
+		glBindBufferRange(GL_SHADER_STORAGE_BUFFER, 0, m_particleStream.buffer(), m_particleStream.readOffset(), bytes);
+	else
+		glBindBufferRange(GL_SHADER_STORAGE_BUFFER, 0, m_particleBuffer, 0, bytes);
+
+	// Draw the particles: a point, or an instance of a 4 vertices strip per particle
+	// (compute mode: the number of alive particles is written by the GPU)
+	shader.bind();
+	if (m_useCompute) {
+		glBindBuffer(GL_DRAW_INDIRECT_BUFFER, m_counterBuffer);
+		if (m_useVertexPulling)
+			glDrawArraysIndirect(GL_TRIANGLE_STRIP, BUFFER_OFFSET(16 * sizeof(GLuint)));
+		else
+			glDrawArraysIndirect(GL_POINTS, BUFFER_OFFSET(12 * sizeof(GLuint)));
+	} else if (m_useVertexPulling) {
+		glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, m_numberParticles);
+	} else {
+		glDrawArrays(GL_POINTS, 0, m_numberParticles);
+	}
+	// The region can be rewritten when the GPU has executed the draw
+	if (streamed)
+		m_particleStream.fenceRead();
+
+	// OIT: average color of the particles over the frame, one fullscreen triangle
+	if (m_blendMode == BlendWeighted) {
+		glBindFramebuffer(GL_FRAMEBUFFER, 0);
+		glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+		glBindTextureUnit(0, m_weightedTextures[0]);
+		glBindTextureUnit(1, m_weightedTextures[1]);
+		m_compositeShader->bind();
+		glDrawArrays(GL_TRIANGLES, 0, 3);
+	}
 
+	glDisable(GL_BLEND);
 
-	// Draw the particles
-	glDrawArrays(GL_POINTS, 0, m_numberParticles);
+}
 
-	// Note here we sort async to avoid locking the rendering system
-	// Sort according to distance from the camera.
-	const glm::vec3 eyePos = m_camera.position();
-	std::sort(m_particles.begin(), m_particles.end(),
-		[&eyePos](const Particle& a, const Particle& b)
-		{
-			return glm::dot(eyePos - a.p, eyePos - a.p) > glm::dot(eyePos - b.p, eyePos - b.p);
-		});
+bool MainWindow::loadMainUniforms(ShaderProgram& shader, MainUniforms& uniforms)
+{
+	uniforms.globalSize = shader.uniformLocation("globalSize");
+	uniforms.globalTransparency = shader.uniformLocation("globalTransparency");
+	uniforms.texture = shader.uniformLocation("particleTexture");
+	uniforms.useTexture = shader.uniformLocation("useTexture");
+	uniforms.time = shader.uniformLocation("time");
+	uniforms.useOrder = shader.uniformLocation("useOrder");
+	uniforms.packed = shader.uniformLocation("packedParticles");
+	uniforms.weighted = shader.uniformLocation("weightedBlend");
+	return uniforms.globalSize != -1 && uniforms.globalTransparency != -1 && uniforms.texture != -1 && uniforms.useTexture != -1 && uniforms.time != -1 && uniforms.useOrder != -1
+		&& uniforms.packed != -1 && uniforms.weighted != -1;
+}
 
-	glDisable(GL_BLEND);
+void MainWindow::resizeWeightedTargets(int width, int height)
+{
+	// Created at the first use, recreated when the window is resized
+	if (m_weightedFBO != 0 && width == m_weightedWidth && height == m_weightedHeight)
+		return;
+	if (m_weightedFBO != 0) {
+		glDeleteFramebuffers(1, &m_weightedFBO);
+		glDeleteTextures(2, m_weightedTextures);
+	}
+	m_weightedWidth = width;
+	m_weightedHeight = height;
+	glCreateTextures(GL_TEXTURE_2D, 2, m_weightedTextures);
+	glTextureStorage2D(m_weightedTextures[0], 1, GL_RGBA16F, width, height); // Accumulation
+	glTextureStorage2D(m_weightedTextures[1], 1, GL_R8, width, height);      // Revealage
+	for (GLuint texture : m_weightedTextures) {
+		glTextureParameteri(texture, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+		glTextureParameteri(texture, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	}
+	glCreateFramebuffers(1, &m_weightedFBO);
+	glNamedFramebufferTexture(m_weightedFBO, GL_COLOR_ATTACHMENT0, m_weightedTextures[0], 0);
+	glNamedFramebufferTexture(m_weightedFBO, GL_COLOR_ATTACHMENT1, m_weightedTextures[1], 0);
+	const GLenum drawBuffers[2] = { GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1 };
+	glNamedFramebufferDrawBuffers(m_weightedFBO, 2, drawBuffers);
+	if (glCheckNamedFramebufferStatus(m_weightedFBO, GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+		std::cerr << "Error: incomplete OIT framebuffer\n";
+}
 
+void MainWindow::bindAliveLists()
+{
+	const GLsizeiptr size = (m_numberParticles + 1) * sizeof(GLuint);
+	glBindBufferRange(GL_SHADER_STORAGE_BUFFER, 3, m_aliveBuffers[m_aliveCurrent], 0, size);
+	glBindBufferRange(GL_SHADER_STORAGE_BUFFER, 4, m_aliveBuffers[1 - m_aliveCurrent], 0, size);
+}
+
+void MainWindow::simulateParticlesGPU(float dt)
+{
+	// Emission, then simulation of the alive particles only: the sizes of the
+	// dispatches and of the draw are written by the GPU (indirect commands)
+	PROFILE_SCOPE("Compute");
+	GpuTimer timer(m_gpuProfiler, "Compute");
+	const glm::vec3 gravity(0, -9.8, 0); // acceleration due to gravity
+
+	// Particles emitted during this frame (the fraction is kept for the next ones)
+	m_emitAccumulator = std::min(m_emitAccumulator + m_emitRate * dt, float(m_numberParticles));
+	const int emit = int(m_emitAccumulator);
+	m_emitAccumulator -= float(emit);
+
+	m_computeShader->bind();
+	m_computeShader->setFloat(m_computeUniforms.dt, dt);
+	m_computeShader->setVec3(m_computeUniforms.gravity, gravity);
+	m_computeShader->setInt(m_computeUniforms.emit, emit);
+	m_computeShader->setInt(m_computeUniforms.seed, int(Random::key(m_seed, m_emitFrame++)));
+	m_computeShader->setFloat(m_computeUniforms.spawnSize, m_settings.size);
+	m_computeShader->setVec2(m_computeUniforms.velocityRange, glm::vec2(m_settings.velocityMin, m_settings.velocityMax));
+	m_computeShader->setVec2(m_computeUniforms.lifeRange, glm::vec2(m_settings.lifeMin, m_settings.lifeMax));
+	m_computeShader->setBool(m_computeUniforms.packed, m_usePackedParticles);
+	glBindBuffer(GL_DISPATCH_INDIRECT_BUFFER, m_counterBuffer);
+
+	m_computeShader->setInt(m_computeUniforms.mode, 0);
+	glDispatchCompute(1, 1, 1);
+	glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT | GL_COMMAND_BARRIER_BIT);
+
+	m_computeShader->setInt(m_computeUniforms.mode, 1);
+	glDispatchComputeIndirect(4 * sizeof(GLuint));
+	glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+
+	m_computeShader->setInt(m_computeUniforms.mode, 2);
+	glDispatchComputeIndirect(8 * sizeof(GLuint));
+	glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+
+	m_computeShader->setInt(m_computeUniforms.mode, 3);
+	glDispatchCompute(1, 1, 1);
+	glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT | GL_COMMAND_BARRIER_BIT);
+
+	// The alive particles of this frame are the input of the next one
+	m_aliveCurrent = 1 - m_aliveCurrent;
+	bindAliveLists();
+
+	if (m_useInteraction)
+		interactParticlesGPU(dt);
+}
+
+void MainWindow::interactParticlesGPU(float dt)
+{
+	// Counting sort of the alive particles by cell, without any CPU readback:
+	// the dispatches over the alive particles are indirect (written by particules.comp)
+	PROFILE_SCOPE("Interactions");
+	GpuTimer timer(m_gpuProfiler, "Interactions");
+	const GLuint cells = GLuint(GridSize) * GridSize * GridSize;
+	// The grid follows the emitter: centered in x and z, mostly above it
+	const float cellSize = m_interactionRadius;
+	const glm::vec3 origin = cellSize * glm::vec3(-0.5f * GridSize, -0.125f * GridSize, -0.5f * GridSize);
+
+	m_gridShader->bind();
+	m_gridShader->setVec3(m_gridUniforms.origin, origin);
+	m_gridShader->setFloat(m_gridUniforms.cellSize, cellSize);
+	m_gridShader->setFloat(m_gridUniforms.dt, dt);
+	m_gridShader->setFloat(m_gridUniforms.strength, m_interactionStrength);
+	m_gridShader->setBool(m_gridUniforms.packed, m_usePackedParticles);
+	glClearNamedBufferData(m_cellCountBuffer, GL_R32UI, GL_RED_INTEGER, GL_UNSIGNED_INT, nullptr);
+	glBindBuffer(GL_DISPATCH_INDIRECT_BUFFER, m_counterBuffer);
+
+	// Cell of each particle and counts
+	m_gridShader->setInt(m_gridUniforms.mode, 0);
+	glDispatchComputeIndirect(20 * sizeof(GLuint));
+	glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+
+	// Prefix sum: blocks of 512 cells, then the sums of the blocks
+	m_gridShader->setInt(m_gridUniforms.mode, 1);
+	glDispatchCompute(cells / 512, 1, 1);
+	glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+	m_gridShader->setInt(m_gridUniforms.mode, 2);
+	glDispatchCompute(1, 1, 1);
+	glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+
+	// Particles sorted by cell
+	m_gridShader->setInt(m_gridUniforms.mode, 3);
+	glDispatchComputeIndirect(20 * sizeof(GLuint));
+	glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+
+	// Neighbors (velocities of the next frame)
+	m_gridShader->setInt(m_gridUniforms.mode, 4);
+	glDispatchComputeIndirect(20 * sizeof(GLuint));
+	glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+}
+
+void MainWindow::sortParticlesGPU()
+{
+	// Bitonic sort of the (key, index) pairs, the keys are computed from the
+	// alive particles and the camera position (UBO), without any CPU readback
+	// Steps with a distance of 256 pairs or less are done in shared memory
+	// (a work group sorts a block of 512 pairs)
+	PROFILE_SCOPE("Sort");
+	GpuTimer timer(m_gpuProfiler, "Sort");
+	const GLuint blocks = m_orderCount / 512;
+	m_sortShader->bind();
+
+	m_sortShader->setInt(m_sortUniforms.mode, 0);
+	m_sortShader->setBool(m_sortUniforms.packed, m_usePackedParticles);
+	glDispatchCompute(m_orderCount / 256, 1, 1);
+	glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+	if (m_blendMode != BlendAlpha)
+		return;
+
+	m_sortShader->setInt(m_sortUniforms.mode, 1);
+	glDispatchCompute(blocks, 1, 1);
+	glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+
+	for (int stage = 1024; stage <= m_orderCount; stage *= 2) {
+		m_sortShader->setInt(m_sortUniforms.stage, stage);
+		m_sortShader->setInt(m_sortUniforms.mode, 2);
+		for (int pass = stage / 2; pass >= 512; pass /= 2) {
+			m_sortShader->setInt(m_sortUniforms.pass, pass);
+			glDispatchCompute(blocks, 1, 1);
+			glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+		}
+		m_sortShader->setInt(m_sortUniforms.mode, 3);
+		glDispatchCompute(blocks, 1, 1);
+		glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+	}
 }
 
 int MainWindow::RenderLoop()
 {
+	// Benchmark: play the camera path given on the command line
+	if (!Benchmark::settings().cameraPath.empty() && m_cameraPath.load(Benchmark::settings().cameraPath))
+		m_cameraPath.startPlayback();
+
 	float time = glfwGetTime();
 	while (!glfwWindowShouldClose(m_window))
 	{
+		PROFILE_SCOPE("RenderLoop");
+		m_frameStats.beginFrame();
 		// Compute delta time between two frames
 		float new_time = float(glfwGetTime());
-		const float delta_time = new_time - time;
+		// When a camera path is played, the simulation uses the same fixed time step
+		// (identical runs, independent of the frame rate)
+		const float delta_time = m_cameraPath.isPlaying() ? m_cameraPath.timeStep() : new_time - time;
 		time = new_time;
 
 		// Check inputs: Does ESC was pressed?
 		if (glfwGetKey(m_window, GLFW_KEY_ESCAPE) == GLFW_PRESS)
 			glfwSetWindowShouldClose(m_window, true);
-		if (!m_imGuiActive) {
+		if (m_cameraPath.isPlaying()) {
+			m_cameraPath.step(m_camera);
+		} else if (!m_imGuiActive) {
 			m_camera.keybordEvents(m_window, delta_time);
 		}
-
-		if (m_animate) {
-			const glm::vec3 gravity(0, -9.8, 0); // acceleration due to gravity
-			if(m_useCompute) {
-				m_computeShader->bind();
-				m_computeShader->setFloat(m_computeUniforms.dt, delta_time * m_speed);
-				m_computeShader->setVec3(m_computeUniforms.gravity, gravity);
-				glDispatchCompute(m_numberParticles / 256, 1, 1);
-				glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
-			} else {
-				const float dt = delta_time * m_speed;
-				for (auto p = m_particles.begin(); p != m_particles.end(); ++p)
-				{
-					p->life -= dt;
-					if (p->life <= 0.0f)
-					{
-						// particle is dead, so create a new one
-						*p = m_settings.createNewParticle();
-					}
-					else
-					{
-						// Euler integration
-						p->p += dt * p->v;
-						p->v += dt * gravity;
-					}
-				}
-				glNamedBufferSubData(m_particleBuffer, 0, m_numberParticles * sizeof(Particle), (const void*)m_particles.data());
-			}
+		m_cameraPath.record(m_camera, glfwGetTime());
+
+		m_gpuProfiler.beginFrame();
+		// Last GPU frame time read back (a few frames late)
+		if (!m_gpuProfiler.results().empty())
+			m_frameStats.setGpuTime(m_gpuProfiler.results()[0].ms);
+		if(m_useCompute) {
+			if (m_animate)
+				simulateParticlesGPU(delta_time * m_speed);
+		} else {
+			// Inputs of the next simulation steps
+			SimulationInput& input = m_simulationInputs.writeBuffer();
+			input.eye = m_camera.position();
+			input.speed = m_speed;
+			input.animate = m_animate;
+			input.sort = m_blendMode == BlendAlpha;
+			m_simulationInputs.publish();
+
+			// Newest state of the simulation thread (never waits, no copy)
+			if (m_particleStream.update())
+				m_uploadedStep = m_particleStream.readTag();
 		}
 		RenderScene(time);
-		RenderImgui();
+		{
+			GpuTimer timer(m_gpuProfiler, "ImGui");
+			RenderImgui();
+		}
+		m_gpuProfiler.endFrame();
+		GLDebugSink::instance().drain();
+		GLTrace::endFrame();
+
+		// Frame measurements (benchmark mode, see Benchmark.h)
+		Benchmark::endFrame(m_window);
+
+		// Optional frame limiter (see the "Frame statistics" window)
+		m_frameStats.waitFrameLimit();
 
 		// Show rendering and get events
-		glfwSwapBuffers(m_window);
-		glfwPollEvents();
+		{
+			PROFILE_SCOPE("SwapBuffers");
+			m_frameStats.beginSwap();
+			glfwSwapBuffers(m_window);
+			m_frameStats.endSwap();
+		}
+		{
+			PROFILE_SCOPE("PollEvents");
+			glfwPollEvents();
+		}
 		m_imGuiActive = ImGui::IsAnyItemActive();
 	}
 
 	// Cleanup
+	stopSimulation();
+	m_particleStream.release();
+	m_gpuProfiler.release();
+	m_cameraUBO.release();
 	ImGui_ImplOpenGL3_Shutdown();
 	ImGui_ImplGlfw_Shutdown();
 	ImGui::DestroyContext();
@@ -421,7 +993,7 @@ void MainWindow::FramebufferSizeCallback(int width, int height)
 }
 
 void MainWindow::CursorPositionCallback(double xpos, double ypos) {
-	if (!m_imGuiActive) {
+	if (!m_imGuiActive && !m_cameraPath.isPlaying()) {
 		int state = glfwGetMouseButton(m_window, GLFW_MOUSE_BUTTON_LEFT);
 		m_camera.mouseEvents(glm::vec2(xpos, ypos), state == GLFW_PRESS);
 	}
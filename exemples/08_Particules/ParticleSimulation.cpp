@@ -0,0 +1,492 @@
+#include "ParticleSimulation.h"
+#include "JobSystem.h"
+#include "RadixSort.h"
+#include "CpuProfiler.h"
+#include "RandomLanes.h"
+
+#include <cstring>
+
+namespace
+{
+	using CpuFeatures::Level;
+
+	// Padding of the arrays (AVX2 lanes)
+	const std::size_t Lanes = 8;
+
+	// New particles of a step, one entry per sequence of
+	// ParticleGeneratorSettings: value = min + scale * Random::uniform(key, i)
+	// for particle i (same values than createNewParticle(seed, i))
+	struct Spawn
+	{
+		uint32_t key[8];
+		float min[8];
+		float scale[8];
+	};
+
+	Spawn makeSpawn(const ParticleGeneratorSettings& s, uint32_t seed)
+	{
+		const float ranges[8][2] = {
+			{ -s.size, s.size }, { s.velocityMin, s.velocityMax }, { -s.size, s.size }, { s.lifeMin, s.lifeMax },
+			{ 0.5f, 1.0f }, { 0.0f, 0.5f }, { 0.0f, 0.5f }, { 0.1f, 0.25f }
+		};
+		Spawn spawn;
+		for (uint32_t k = ParticleGeneratorSettings::SequenceVx; k <= ParticleGeneratorSettings::SequenceSize; ++k)
+		{
+			spawn.key[k] = Random::key(seed, k);
+			spawn.min[k] = ranges[k][0];
+			spawn.scale[k] = ranges[k][1] - ranges[k][0];
+		}
+		return spawn;
+	}
+
+	// ------------------------------------------------------------------------
+	// Scalar (reference)
+	void stepScalar(const ParticleArrays& in, ParticleArrays& out, uint32_t* keys,
+		const ParticleStep& p, const Spawn& s, std::size_t begin, std::size_t end)
+	{
+		for (std::size_t i = begin; i < end; ++i)
+		{
+			auto spawn = [&s, i](int k) { return s.min[k] + s.scale[k] * Random::uniform(s.key[k], uint32_t(i)); };
+			float px = in.px[i], py = in.py[i], pz = in.pz[i], life = in.life[i];
+			float vx = in.vx[i], vy = in.vy[i], vz = in.vz[i], size = in.size[i];
+			float r = in.r[i], g = in.g[i], b = in.b[i];
+			if (p.animate)
+			{
+				life -= p.dt;
+				if (life <= 0.0f)
+				{
+					px = py = pz = 0.0f;
+					vx = spawn(0); vy = spawn(1); vz = spawn(2); life = spawn(3);
+					r = spawn(4); g = spawn(5); b = spawn(6); size = spawn(7);
+				}
+				else
+				{
+					px += p.dt * vx;
+					py += p.dt * vy;
+					pz += p.dt * vz;
+					vx += p.dt * p.gravity.x;
+					vy += p.dt * p.gravity.y;
+					vz += p.dt * p.gravity.z;
+				}
+			}
+			out.px[i] = px; out.py[i] = py; out.pz[i] = pz; out.life[i] = life;
+			out.vx[i] = vx; out.vy[i] = vy; out.vz[i] = vz; out.size[i] = size;
+			out.r[i] = r; out.g[i] = g; out.b[i] = b;
+
+			const glm::vec3 d = p.eye - glm::vec3(px, py, pz);
+			keys[i] = RadixSort::floatKey(-glm::dot(d, d));
+		}
+	}
+
+	void interleaveScalar(const ParticleArrays& a, const uint32_t* order, Particle* out,
+		std::size_t begin, std::size_t end)
+	{
+		for (std::size_t i = begin; i < end; ++i)
+		{
+			const uint32_t j = order[i];
+			Particle& p = out[i];
+			p.p = glm::vec3(a.px[j], a.py[j], a.pz[j]);
+			p.life = a.life[j];
+			p.v = glm::vec3(a.vx[j], a.vy[j], a.vz[j]);
+			p.size = a.size[j];
+			p.c = glm::vec3(a.r[j], a.g[j], a.b[j]);
+			p.padd = 0.0f;
+		}
+	}
+
+	// Float to half float, round to nearest (the values smaller than the
+	// smallest normal half are flushed to 0, the larger ones are clamped)
+	uint32_t halfBits(float value)
+	{
+		uint32_t bits;
+		std::memcpy(&bits, &value, sizeof(bits));
+		const uint32_t sign = (bits >> 16) & 0x8000u;
+		const uint32_t a = bits & 0x7FFFFFFFu;
+		if (a < 0x38800000u)
+			return sign;
+		if (a >= 0x477FF000u)
+			return sign | 0x7BFFu;
+		return sign | ((a - 0x38000000u + 0xFFFu + ((a >> 13) & 1u)) >> 13);
+	}
+
+	// [0, scale] to [0, max] (rounded)
+	uint32_t unorm(float value, float scale, float max)
+	{
+		return uint32_t(std::min(std::max(value / scale, 0.0f), 1.0f) * max + 0.5f);
+	}
+
+	PackedParticle packValues(float px, float py, float pz, float life, float vx, float vy, float vz,
+		float size, float r, float g, float b)
+	{
+		PackedParticle p;
+		p.p = glm::vec3(px, py, pz);
+		p.lifeVz = unorm(life, PackedParticle::MaxLife, 65535.0f) | (halfBits(vz) << 16);
+		p.vxy = halfBits(vx) | (halfBits(vy) << 16);
+		p.colorSize = unorm(r, 1.0f, 255.0f) | (unorm(g, 1.0f, 255.0f) << 8) | (unorm(b, 1.0f, 255.0f) << 16)
+			| (unorm(size, PackedParticle::MaxSize, 255.0f) << 24);
+		return p;
+	}
+
+	void packScalar(const ParticleArrays& a, const uint32_t* order, PackedParticle* out,
+		std::size_t begin, std::size_t end)
+	{
+		for (std::size_t i = begin; i < end; ++i)
+		{
+			const uint32_t j = order[i];
+			out[i] = packValues(a.px[j], a.py[j], a.pz[j], a.life[j], a.vx[j], a.vy[j], a.vz[j],
+				a.size[j], a.r[j], a.g[j], a.b[j]);
+		}
+	}
+
+#ifdef SIMD_SSE2
+	// ------------------------------------------------------------------------
+	// SSE2 (4 particles at a time)
+	inline __m128 select4(__m128 mask, __m128 a, __m128 b)
+	{
+		// mask ? a : b
+		return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+	}
+
+	// Attribute k of the new particles i to i + 3
+	inline __m128 spawn4(const Spawn& s, int k, __m128i counters)
+	{
+		const __m128 u = RandomLanes::unit4(RandomLanes::value4(counters, s.key[k]));
+		return _mm_add_ps(_mm_set1_ps(s.min[k]), _mm_mul_ps(_mm_set1_ps(s.scale[k]), u));
+	}
+
+	void stepSSE2(const ParticleArrays& in, ParticleArrays& out, uint32_t* keys,
+		const ParticleStep& p, const Spawn& s, std::size_t begin, std::size_t end)
+	{
+		const __m128 dt = _mm_set1_ps(p.dt), zero = _mm_setzero_ps();
+		const __m128 gx = _mm_set1_ps(p.gravity.x), gy = _mm_set1_ps(p.gravity.y), gz = _mm_set1_ps(p.gravity.z);
+		const __m128 ex = _mm_set1_ps(p.eye.x), ey = _mm_set1_ps(p.eye.y), ez = _mm_set1_ps(p.eye.z);
+		const __m128i keyMask = _mm_set1_epi32(0x7FFFFFFF);
+		for (std::size_t i = begin; i < end; i += 4)
+		{
+			__m128 px = _mm_loadu_ps(&in.px[i]), py = _mm_loadu_ps(&in.py[i]), pz = _mm_loadu_ps(&in.pz[i]);
+			__m128 vx = _mm_loadu_ps(&in.vx[i]), vy = _mm_loadu_ps(&in.vy[i]), vz = _mm_loadu_ps(&in.vz[i]);
+			__m128 life = _mm_loadu_ps(&in.life[i]), size = _mm_loadu_ps(&in.size[i]);
+			__m128 r = _mm_loadu_ps(&in.r[i]), g = _mm_loadu_ps(&in.g[i]), b = _mm_loadu_ps(&in.b[i]);
+			if (p.animate)
+			{
+				life = _mm_sub_ps(life, dt);
+				px = _mm_add_ps(px, _mm_mul_ps(dt, vx));
+				py = _mm_add_ps(py, _mm_mul_ps(dt, vy));
+				pz = _mm_add_ps(pz, _mm_mul_ps(dt, vz));
+				vx = _mm_add_ps(vx, _mm_mul_ps(dt, gx));
+				vy = _mm_add_ps(vy, _mm_mul_ps(dt, gy));
+				vz = _mm_add_ps(vz, _mm_mul_ps(dt, gz));
+				const __m128 dead = _mm_cmple_ps(life, zero);
+				if (_mm_movemask_ps(dead))
+				{
+					// New particles, kept only in the dead lanes
+					px = select4(dead, zero, px);
+					py = select4(dead, zero, py);
+					pz = select4(dead, zero, pz);
+					const __m128i counters = _mm_add_epi32(_mm_set1_epi32(int(i)), _mm_setr_epi32(0, 1, 2, 3));
+					vx = select4(dead, spawn4(s, 0, counters), vx);
+					vy = select4(dead, spawn4(s, 1, counters), vy);
+					vz = select4(dead, spawn4(s, 2, counters), vz);
+					life = select4(dead, spawn4(s, 3, counters), life);
+					r = select4(dead, spawn4(s, 4, counters), r);
+					g = select4(dead, spawn4(s, 5, counters), g);
+					b = select4(dead, spawn4(s, 6, counters), b);
+					size = select4(dead, spawn4(s, 7, counters), size);
+				}
+			}
+			_mm_storeu_ps(&out.px[i], px); _mm_storeu_ps(&out.py[i], py); _mm_storeu_ps(&out.pz[i], pz);
+			_mm_storeu_ps(&out.vx[i], vx); _mm_storeu_ps(&out.vy[i], vy); _mm_storeu_ps(&out.vz[i], vz);
+			_mm_storeu_ps(&out.life[i], life); _mm_storeu_ps(&out.size[i], size);
+			_mm_storeu_ps(&out.r[i], r); _mm_storeu_ps(&out.g[i], g); _mm_storeu_ps(&out.b[i], b);
+
+			// Key: bits of -distance^2 inverted (see RadixSort::floatKey)
+			const __m128 dx = _mm_sub_ps(ex, px), dy = _mm_sub_ps(ey, py), dz = _mm_sub_ps(ez, pz);
+			const __m128 d2 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(keys + i), _mm_andnot_si128(_mm_castps_si128(d2), keyMask));
+		}
+	}
+#endif
+
+#ifdef SIMD_AVX2
+	// ------------------------------------------------------------------------
+	// AVX2 (8 particles at a time)
+	// Attribute k of the new particles i to i + 7
+	SIMD_AVX2_TARGET
+	inline __m256 spawn8(const Spawn& s, int k, __m256i counters)
+	{
+		const __m256 u = RandomLanes::unit8(RandomLanes::value8(counters, s.key[k]));
+		return _mm256_add_ps(_mm256_set1_ps(s.min[k]), _mm256_mul_ps(_mm256_set1_ps(s.scale[k]), u));
+	}
+
+	SIMD_AVX2_TARGET
+	void stepAVX2(const ParticleArrays& in, ParticleArrays& out, uint32_t* keys,
+		const ParticleStep& p, const Spawn& s, std::size_t begin, std::size_t end)
+	{
+		const __m256 dt = _mm256_set1_ps(p.dt), zero = _mm256_setzero_ps();
+		const __m256 gx = _mm256_set1_ps(p.gravity.x), gy = _mm256_set1_ps(p.gravity.y), gz = _mm256_set1_ps(p.gravity.z);
+		const __m256 ex = _mm256_set1_ps(p.eye.x), ey = _mm256_set1_ps(p.eye.y), ez = _mm256_set1_ps(p.eye.z);
+		const __m256i keyMask = _mm256_set1_epi32(0x7FFFFFFF);
+		for (std::size_t i = begin; i < end; i += 8)
+		{
+			__m256 px = _mm256_loadu_ps(&in.px[i]), py = _mm256_loadu_ps(&in.py[i]), pz = _mm256_loadu_ps(&in.pz[i]);
+			__m256 vx = _mm256_loadu_ps(&in.vx[i]), vy = _mm256_loadu_ps(&in.vy[i]), vz = _mm256_loadu_ps(&in.vz[i]);
+			__m256 life = _mm256_loadu_ps(&in.life[i]), size = _mm256_loadu_ps(&in.size[i]);
+			__m256 r = _mm256_loadu_ps(&in.r[i]), g = _mm256_loadu_ps(&in.g[i]), b = _mm256_loadu_ps(&in.b[i]);
+			if (p.animate)
+			{
+				life = _mm256_sub_ps(life, dt);
+				px = _mm256_add_ps(px, _mm256_mul_ps(dt, vx));
+				py = _mm256_add_ps(py, _mm256_mul_ps(dt, vy));
+				pz = _mm256_add_ps(pz, _mm256_mul_ps(dt, vz));
+				vx = _mm256_add_ps(vx, _mm256_mul_ps(dt, gx));
+				vy = _mm256_add_ps(vy, _mm256_mul_ps(dt, gy));
+				vz = _mm256_add_ps(vz, _mm256_mul_ps(dt, gz));
+				const __m256 dead = _mm256_cmp_ps(life, zero, _CMP_LE_OQ);
+				if (_mm256_movemask_ps(dead))
+				{
+					// New particles, kept only in the dead lanes
+					px = _mm256_blendv_ps(px, zero, dead);
+					py = _mm256_blendv_ps(py, zero, dead);
+					pz = _mm256_blendv_ps(pz, zero, dead);
+					const __m256i counters = _mm256_add_epi32(_mm256_set1_epi32(int(i)), _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7));
+					vx = _mm256_blendv_ps(vx, spawn8(s, 0, counters), dead);
+					vy = _mm256_blendv_ps(vy, spawn8(s, 1, counters), dead);
+					vz = _mm256_blendv_ps(vz, spawn8(s, 2, counters), dead);
+					life = _mm256_blendv_ps(life, spawn8(s, 3, counters), dead);
+					r = _mm256_blendv_ps(r, spawn8(s, 4, counters), dead);
+					g = _mm256_blendv_ps(g, spawn8(s, 5, counters), dead);
+					b = _mm256_blendv_ps(b, spawn8(s, 6, counters), dead);
+					size = _mm256_blendv_ps(size, spawn8(s, 7, counters), dead);
+				}
+			}
+			_mm256_storeu_ps(&out.px[i], px); _mm256_storeu_ps(&out.py[i], py); _mm256_storeu_ps(&out.pz[i], pz);
+			_mm256_storeu_ps(&out.vx[i], vx); _mm256_storeu_ps(&out.vy[i], vy); _mm256_storeu_ps(&out.vz[i], vz);
+			_mm256_storeu_ps(&out.life[i], life); _mm256_storeu_ps(&out.size[i], size);
+			_mm256_storeu_ps(&out.r[i], r); _mm256_storeu_ps(&out.g[i], g); _mm256_storeu_ps(&out.b[i], b);
+
+			// Key: bits of -distance^2 inverted (see RadixSort::floatKey)
+			const __m256 dx = _mm256_sub_ps(ex, px), dy = _mm256_sub_ps(ey, py), dz = _mm256_sub_ps(ez, pz);
+			const __m256 d2 = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(dx, dx), _mm256_mul_ps(dy, dy)), _mm256_mul_ps(dz, dz));
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(keys + i), _mm256_andnot_si256(_mm256_castps_si256(d2), keyMask));
+		}
+	}
+
+	// Transpose 4 attributes of 8 particles and write them at the offset of
+	// the attributes inside each particle (12 floats per particle)
+	SIMD_AVX2_TARGET
+	inline void store4x8(__m256 a, __m256 b, __m256 c, __m256 d, float* out)
+	{
+		const __m256 t0 = _mm256_unpacklo_ps(a, b); // a0 b0 a1 b1 | a4 b4 a5 b5
+		const __m256 t1 = _mm256_unpackhi_ps(a, b); // a2 b2 a3 b3 | a6 b6 a7 b7
+		const __m256 t2 = _mm256_unpacklo_ps(c, d);
+		const __m256 t3 = _mm256_unpackhi_ps(c, d);
+		const __m256 r0 = _mm256_shuffle_ps(t0, t2, 0x44); // a0 b0 c0 d0 | a4 b4 c4 d4
+		const __m256 r1 = _mm256_shuffle_ps(t0, t2, 0xEE);
+		const __m256 r2 = _mm256_shuffle_ps(t1, t3, 0x44);
+		const __m256 r3 = _mm256_shuffle_ps(t1, t3, 0xEE);
+		_mm_storeu_ps(out + 0 * 12, _mm256_castps256_ps128(r0));
+		_mm_storeu_ps(out + 1 * 12, _mm256_castps256_ps128(r1));
+		_mm_storeu_ps(out + 2 * 12, _mm256_castps256_ps128(r2));
+		_mm_storeu_ps(out + 3 * 12, _mm256_castps256_ps128(r3));
+		_mm_storeu_ps(out + 4 * 12, _mm256_extractf128_ps(r0, 1));
+		_mm_storeu_ps(out + 5 * 12, _mm256_extractf128_ps(r1, 1));
+		_mm_storeu_ps(out + 6 * 12, _mm256_extractf128_ps(r2, 1));
+		_mm_storeu_ps(out + 7 * 12, _mm256_extractf128_ps(r3, 1));
+	}
+
+	SIMD_AVX2_TARGET
+	void interleaveAVX2(const ParticleArrays& a, const uint32_t* order, Particle* out,
+		std::size_t begin, std::size_t end)
+	{
+		const __m256 zero = _mm256_setzero_ps();
+		std::size_t i = begin;
+		for (; i + 8 <= end; i += 8)
+		{
+			const __m256i j = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(order + i));
+			float* o = reinterpret_cast<float*>(out + i);
+			store4x8(_mm256_i32gather_ps(a.px.data(), j, 4), _mm256_i32gather_ps(a.py.data(), j, 4),
+				_mm256_i32gather_ps(a.pz.data(), j, 4), _mm256_i32gather_ps(a.life.data(), j, 4), o);
+			store4x8(_mm256_i32gather_ps(a.vx.data(), j, 4), _mm256_i32gather_ps(a.vy.data(), j, 4),
+				_mm256_i32gather_ps(a.vz.data(), j, 4), _mm256_i32gather_ps(a.size.data(), j, 4), o + 4);
+			store4x8(_mm256_i32gather_ps(a.r.data(), j, 4), _mm256_i32gather_ps(a.g.data(), j, 4),
+				_mm256_i32gather_ps(a.b.data(), j, 4), zero, o + 8);
+		}
+		interleaveScalar(a, order, out, i, end);
+	}
+
+	// Same as halfBits, 8 values
+	SIMD_AVX2_TARGET
+	inline __m256i halfBits8(__m256 value)
+	{
+		const __m256i bits = _mm256_castps_si256(value);
+		const __m256i sign = _mm256_and_si256(_mm256_srli_epi32(bits, 16), _mm256_set1_epi32(0x8000));
+		const __m256i a = _mm256_and_si256(bits, _mm256_set1_epi32(0x7FFFFFFF));
+		const __m256i even = _mm256_and_si256(_mm256_srli_epi32(a, 13), _mm256_set1_epi32(1));
+		__m256i h = _mm256_srli_epi32(_mm256_add_epi32(_mm256_sub_epi32(a, _mm256_set1_epi32(0x38000000 - 0xFFF)), even), 13);
+		// a < 2^31: the signed comparisons are valid
+		const __m256i small = _mm256_cmpgt_epi32(_mm256_set1_epi32(0x38800000), a);
+		const __m256i large = _mm256_cmpgt_epi32(a, _mm256_set1_epi32(0x477FEFFF));
+		h = _mm256_blendv_epi8(h, _mm256_set1_epi32(0x7BFF), large);
+		h = _mm256_andnot_si256(small, h);
+		return _mm256_or_si256(h, sign);
+	}
+
+	// Same as unorm, 8 values
+	SIMD_AVX2_TARGET
+	inline __m256i unorm8(__m256 value, float scale, float max)
+	{
+		const __m256 v = _mm256_min_ps(_mm256_max_ps(_mm256_div_ps(value, _mm256_set1_ps(scale)), _mm256_setzero_ps()), _mm256_set1_ps(1.0f));
+		return _mm256_cvttps_epi32(_mm256_add_ps(_mm256_mul_ps(v, _mm256_set1_ps(max)), _mm256_set1_ps(0.5f)));
+	}
+
+	SIMD_AVX2_TARGET
+	void packAVX2(const ParticleArrays& a, const uint32_t* order, PackedParticle* out,
+		std::size_t begin, std::size_t end)
+	{
+		alignas(32) uint32_t fields[6][8];
+		std::size_t i = begin;
+		for (; i + 8 <= end; i += 8)
+		{
+			const __m256i j = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(order + i));
+			const __m256i lifeVz = _mm256_or_si256(unorm8(_mm256_i32gather_ps(a.life.data(), j, 4), PackedParticle::MaxLife, 65535.0f),
+				_mm256_slli_epi32(halfBits8(_mm256_i32gather_ps(a.vz.data(), j, 4)), 16));
+			const __m256i vxy = _mm256_or_si256(halfBits8(_mm256_i32gather_ps(a.vx.data(), j, 4)),
+				_mm256_slli_epi32(halfBits8(_mm256_i32gather_ps(a.vy.data(), j, 4)), 16));
+			const __m256i rg = _mm256_or_si256(unorm8(_mm256_i32gather_ps(a.r.data(), j, 4), 1.0f, 255.0f),
+				_mm256_slli_epi32(unorm8(_mm256_i32gather_ps(a.g.data(), j, 4), 1.0f, 255.0f), 8));
+			const __m256i bs = _mm256_or_si256(_mm256_slli_epi32(unorm8(_mm256_i32gather_ps(a.b.data(), j, 4), 1.0f, 255.0f), 16),
+				_mm256_slli_epi32(unorm8(_mm256_i32gather_ps(a.size.data(), j, 4), PackedParticle::MaxSize, 255.0f), 24));
+			_mm256_store_ps(reinterpret_cast<float*>(fields[0]), _mm256_i32gather_ps(a.px.data(), j, 4));
+			_mm256_store_ps(reinterpret_cast<float*>(fields[1]), _mm256_i32gather_ps(a.py.data(), j, 4));
+			_mm256_store_ps(reinterpret_cast<float*>(fields[2]), _mm256_i32gather_ps(a.pz.data(), j, 4));
+			_mm256_store_si256(reinterpret_cast<__m256i*>(fields[3]), lifeVz);
+			_mm256_store_si256(reinterpret_cast<__m256i*>(fields[4]), vxy);
+			_mm256_store_si256(reinterpret_cast<__m256i*>(fields[5]), _mm256_or_si256(rg, bs));
+			// Sequential writes (the output can be a mapped buffer)
+			uint32_t* o = reinterpret_cast<uint32_t*>(out + i);
+			for (int k = 0; k < 8; ++k)
+				for (int f = 0; f < 6; ++f)
+					o[k * 6 + f] = fields[f][k];
+		}
+		packScalar(a, order, out, i, end);
+	}
+#endif
+}
+
+static_assert(sizeof(Particle) == 12 * sizeof(float), "Particle must be 12 floats (interleave)");
+static_assert(sizeof(PackedParticle) == 6 * sizeof(uint32_t), "PackedParticle must be 6 words (pack)");
+
+void ParticleGeneratorSettings::createNewParticles(uint32_t seed, uint32_t first, Particle* out, std::size_t count) const
+{
+	const std::size_t Batch = 256;
+	float values[8][Batch];
+	const float ranges[8][2] = {
+		{ -size, size }, { velocityMin, velocityMax }, { -size, size }, { lifeMin, lifeMax },
+		{ 0.5f, 1.0f }, { 0.0f, 0.5f }, { 0.0f, 0.5f }, { 0.1f, 0.25f }
+	};
+	for (std::size_t begin = 0; begin < count; begin += Batch)
+	{
+		const std::size_t n = std::min(Batch, count - begin);
+		for (uint32_t s = SequenceVx; s <= SequenceSize; ++s)
+			Random::fill(Random::key(seed, s), first + uint32_t(begin), values[s], n, ranges[s][0], ranges[s][1]);
+		for (std::size_t i = 0; i < n; ++i)
+		{
+			Particle& p = out[begin + i];
+			p.p = glm::vec3(0.0f);
+			p.v = glm::vec3(values[SequenceVx][i], values[SequenceVy][i], values[SequenceVz][i]);
+			p.life = values[SequenceLife][i];
+			p.c = glm::vec3(values[SequenceR][i], values[SequenceG][i], values[SequenceB][i]);
+			p.size = values[SequenceSize][i];
+			p.padd = 0.0f;
+		}
+	}
+}
+
+void ParticleArrays::resize(std::size_t n)
+{
+	const std::size_t padded = (n + Lanes - 1) / Lanes * Lanes;
+	for (std::vector<float>* a : { &px, &py, &pz, &life, &vx, &vy, &vz, &size, &r, &g, &b })
+		a->resize(padded, 0.0f);
+	count = n;
+}
+
+void ParticleArrays::assign(const Particle* particles, std::size_t n)
+{
+	resize(n);
+	for (std::size_t i = 0; i < n; ++i)
+	{
+		const Particle& p = particles[i];
+		px[i] = p.p.x; py[i] = p.p.y; pz[i] = p.p.z; life[i] = p.life;
+		vx[i] = p.v.x; vy[i] = p.v.y; vz[i] = p.v.z; size[i] = p.size;
+		r[i] = p.c.x; g[i] = p.c.y; b[i] = p.c.z;
+	}
+}
+
+// ----------------------------------------------------------------------------
+void ParticleSimulation::step(const ParticleArrays& in, ParticleArrays& out, uint32_t* keys, const ParticleStep& params)
+{
+	PROFILE_SCOPE("ParticleSimulation::step");
+	out.resize(in.count);
+	const Spawn spawn = makeSpawn(params.settings, params.seed);
+	// Blocks of 8 particles (the padding is simulated too)
+	const int blocks = int(in.capacity() / Lanes);
+	JobSystem::instance().parallelFor(0, blocks, [&](int begin, int end) {
+		const std::size_t b = std::size_t(begin) * Lanes, e = std::size_t(end) * Lanes;
+		switch (CpuFeatures::level())
+		{
+#ifdef SIMD_AVX2
+		case Level::AVX2: stepAVX2(in, out, keys, params, spawn, b, e); break;
+#endif
+#ifdef SIMD_SSE2
+		case Level::SSE2: stepSSE2(in, out, keys, params, spawn, b, e); break;
+#endif
+		default: stepScalar(in, out, keys, params, spawn, b, e); break;
+		}
+	});
+}
+
+void ParticleSimulation::interleave(const ParticleArrays& particles, const uint32_t* order, Particle* out)
+{
+	PROFILE_SCOPE("ParticleSimulation::interleave");
+	const int blocks = int(particles.capacity() / Lanes);
+	JobSystem::instance().parallelFor(0, blocks, [&](int begin, int end) {
+		const std::size_t b = std::size_t(begin) * Lanes;
+		const std::size_t e = std::min(std::size_t(end) * Lanes, particles.count);
+#ifdef SIMD_AVX2
+		if (CpuFeatures::level() == Level::AVX2)
+		{
+			interleaveAVX2(particles, order, out, b, e);
+			return;
+		}
+#endif
+		interleaveScalar(particles, order, out, b, e);
+	});
+}
+
+void ParticleSimulation::pack(const ParticleArrays& particles, const uint32_t* order, PackedParticle* out)
+{
+	PROFILE_SCOPE("ParticleSimulation::pack");
+	const int blocks = int(particles.capacity() / Lanes);
+	JobSystem::instance().parallelFor(0, blocks, [&](int begin, int end) {
+		const std::size_t b = std::size_t(begin) * Lanes;
+		const std::size_t e = std::min(std::size_t(end) * Lanes, particles.count);
+#ifdef SIMD_AVX2
+		if (CpuFeatures::level() == Level::AVX2)
+		{
+			packAVX2(particles, order, out, b, e);
+			return;
+		}
+#endif
+		packScalar(particles, order, out, b, e);
+	});
+}
+
+PackedParticle ParticleSimulation::pack(const Particle& p)
+{
+	return packValues(p.p.x, p.p.y, p.p.z, p.life, p.v.x, p.v.y, p.v.z, p.size, p.c.x, p.c.y, p.c.z);
+}
+
+const char* ParticleSimulation::instructionSet()
+{
+	return CpuFeatures::name(CpuFeatures::level());
+}
@@ -0,0 +1,139 @@
+#pragma once
+
+#include "Random.h"
+
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// A simple particle object.
+struct Particle
+{
+	// Attributes
+	glm::vec3 p = glm::vec3(0.0); // position
+	float life = 0.0f;			  // time to live
+	glm::vec3 v = glm::vec3(0.0); // velocity
+	float size = 0.1f;			  // scaling factor
+	glm::vec3 c = glm::vec3(0.0); // RGB color
+	float padd = 0.0f;			  // padding
+};
+
+// Compact particle (24 bytes instead of 48), same layout than PackedParticle
+// in particle.glsl. The position stays in float, the other attributes are
+// quantized: velocity in half floats, life in 16 bits (unorm, up to MaxLife),
+// color in RGBA8 with the size in the alpha channel (unorm, up to MaxSize).
+struct PackedParticle
+{
+	static constexpr float MaxLife = 16.0f; // Limit of the settings (see sanitize)
+	static constexpr float MaxSize = 0.5f;
+
+	glm::vec3 p = glm::vec3(0.0); // position
+	uint32_t lifeVz = 0;		  // life (bits 0-15), velocity z (half, bits 16-31)
+	uint32_t vxy = 0;			  // velocity x, y (half)
+	uint32_t colorSize = 0;		  // RGB color, size (RGBA8)
+};
+
+struct ParticleGeneratorSettings {
+	float size = 0.4f;
+	float velocityMin = 5.0f;
+	float velocityMax = 10.0f;
+	float lifeMin = 0.1f;
+	float lifeMax = 1.0f;
+
+	void sanitize() {
+		size = std::max(size, 0.0001f);
+		velocityMin = std::max(velocityMin, 0.0f);
+		velocityMax = std::max(velocityMax, velocityMin);
+		// The packed particles cannot store longer lives
+		lifeMin = std::min(std::max(lifeMin, 0.0f), PackedParticle::MaxLife);
+		lifeMax = std::min(std::max(lifeMax, lifeMin), PackedParticle::MaxLife);
+	}
+
+	// One random sequence per attribute, the counter is the index of the
+	// particle: the particles only depend on the seed (see shared/Random.h,
+	// same sequences in particules.comp)
+	enum Sequence : uint32_t { SequenceVx, SequenceVy, SequenceVz, SequenceLife, SequenceR, SequenceG, SequenceB, SequenceSize };
+
+	Particle createNewParticle(uint32_t seed, uint32_t index) const
+	{
+		auto random = [seed, index](Sequence sequence, float min, float max) {
+			return Random::uniform(Random::key(seed, sequence), index, min, max);
+		};
+		Particle p;
+		p.p = glm::vec3(0, 0, 0);
+		p.v = glm::vec3(random(SequenceVx, -size, size), random(SequenceVy, velocityMin, velocityMax), random(SequenceVz, -size, size));
+		p.life = random(SequenceLife, lifeMin, lifeMax);
+		p.c = glm::vec3(random(SequenceR, 0.5f, 1.0f), random(SequenceG, 0.0f, 0.5f), random(SequenceB, 0.0f, 0.5f));
+		p.size = random(SequenceSize, 0.1f, 0.25f);
+		return p;
+	}
+
+	// particles [first, first + count[ of the seed, same values than
+	// createNewParticle (SIMD batches of Random::fill)
+	void createNewParticles(uint32_t seed, uint32_t first, Particle* out, std::size_t count) const;
+};
+
+// Particles of the CPU simulation stored as structure of arrays (SoA)
+// One array per attribute: the SIMD integrator loads 8 (AVX2) or 4 (SSE2)
+// particles per instruction. The arrays are padded to a multiple of 8.
+struct ParticleArrays
+{
+	std::vector<float> px, py, pz, life;
+	std::vector<float> vx, vy, vz, size;
+	std::vector<float> r, g, b;
+	std::size_t count = 0;
+
+	std::size_t capacity() const { return px.size(); } // Padded size
+	void resize(std::size_t n);
+	void assign(const Particle* particles, std::size_t n);
+};
+
+// Values used by one simulation step
+struct ParticleStep
+{
+	float dt = 0.0f;
+	glm::vec3 gravity = glm::vec3(0.0f, -9.8f, 0.0f);
+	glm::vec3 eye = glm::vec3(0.0f); // For the sort keys
+	bool animate = true;
+	ParticleGeneratorSettings settings;
+	// Seed of the new particles of this step (ex: Random::key(seed, step)):
+	// the new particle i is settings.createNewParticle(seed, i)
+	uint32_t seed = 0;
+};
+
+// CPU particle simulation (SIMD + job system)
+// The instruction set is chosen at runtime (AVX2, SSE2 or scalar).
+//
+// Usage:
+//   keys.resize(current.capacity());
+//   ParticleSimulation::step(current, next, keys.data(), params);
+//   const std::vector<uint32_t>& order = sorter.sort(keys.data(), next.count);
+//   ParticleSimulation::interleave(next, order.data(), particles.data());
+namespace ParticleSimulation
+{
+	// ------------------------------------------------------------------------
+	// integrate in into out (Euler), the dead particles are replaced by new
+	// ones (masked selects, counter-based random numbers of params.seed: the
+	// result does not depend on the threads)
+	// keys: back to front sort key of each particle (see RadixSort::floatKey),
+	// needs in.capacity() elements
+	void step(const ParticleArrays& in, ParticleArrays& out, uint32_t* keys, const ParticleStep& params);
+
+	// ------------------------------------------------------------------------
+	// gather the particles in the given order and interleave them
+	// (Particle layout, for the upload)
+	void interleave(const ParticleArrays& particles, const uint32_t* order, Particle* out);
+
+	// ------------------------------------------------------------------------
+	// same as interleave, in the compact layout (half of the bytes to upload)
+	void pack(const ParticleArrays& particles, const uint32_t* order, PackedParticle* out);
+	// one particle in the compact layout (same rounding than pack)
+	PackedParticle pack(const Particle& particle);
+
+	// ------------------------------------------------------------------------
+	// instruction set used: "AVX2", "SSE2" or "Scalar"
+	const char* instructionSet();
+}
@@ -0,0 +1,99 @@
+// Particules dans le SSBO (binding 0): format complet (48 octets) ou compact
+// (24 octets, voir PackedParticle dans ParticleSimulation.h), choisi par
+// l'uniform packedParticles. Les deux blocs partagent le binding 0, seul
+// celui du format courant est lu.
+// Usage: #define PARTICLES_WRITE (compute) puis #include "particle.glsl"
+#pragma once
+
+#ifdef PARTICLES_WRITE
+#define PARTICLES_ACCESS
+#else
+#define PARTICLES_ACCESS readonly
+#endif
+
+struct Particle{
+    vec3 position;
+    float life;
+    vec3 velocity;
+    float size;
+    vec3 color;
+    float _pad;
+};
+
+// Position en float, vitesse en half float, vie en unorm 16 bits,
+// couleur et taille en RGBA8
+struct PackedParticle{
+    float px, py, pz;
+    uint lifeVelocityZ; // vie (bits 0-15), vitesse z (half, bits 16-31)
+    uint velocityXY;    // vitesse x, y (half)
+    uint colorSize;     // couleur RGB, taille (A)
+};
+
+const float PARTICLE_MAX_LIFE = 16.0; // PackedParticle::MaxLife
+const float PARTICLE_MAX_SIZE = 0.5;  // PackedParticle::MaxSize
+
+layout(binding = 0, std430) PARTICLES_ACCESS buffer ssbo1 {
+    Particle data[];
+};
+
+layout(binding = 0, std430) PARTICLES_ACCESS buffer ssbo1Packed {
+    PackedParticle packedData[];
+};
+
+uniform bool packedParticles;
+
+vec3 particlePosition(uint i) {
+    if (packedParticles) {
+        return vec3(packedData[i].px, packedData[i].py, packedData[i].pz);
+    }
+    return data[i].position;
+}
+
+vec3 particleVelocity(uint i) {
+    if (packedParticles) {
+        return vec3(unpackHalf2x16(packedData[i].velocityXY), unpackHalf2x16(packedData[i].lifeVelocityZ >> 16).x);
+    }
+    return data[i].velocity;
+}
+
+Particle loadParticle(uint i) {
+    if (!packedParticles) {
+        return data[i];
+    }
+    PackedParticle q = packedData[i];
+    Particle p;
+    p.position = vec3(q.px, q.py, q.pz);
+    p.life = float(q.lifeVelocityZ & 0xFFFFu) * (PARTICLE_MAX_LIFE / 65535.0);
+    p.velocity = vec3(unpackHalf2x16(q.velocityXY), unpackHalf2x16(q.lifeVelocityZ >> 16).x);
+    vec4 colorSize = unpackUnorm4x8(q.colorSize);
+    p.color = colorSize.rgb;
+    p.size = colorSize.a * PARTICLE_MAX_SIZE;
+    p._pad = 0.0;
+    return p;
+}
+
+#ifdef PARTICLES_WRITE
+void storeParticle(uint i, Particle p) {
+    if (!packedParticles) {
+        data[i] = p;
+        return;
+    }
+    uint life = uint(clamp(p.life / PARTICLE_MAX_LIFE, 0.0, 1.0) * 65535.0 + 0.5);
+    packedData[i].px = p.position.x;
+    packedData[i].py = p.position.y;
+    packedData[i].pz = p.position.z;
+    packedData[i].lifeVelocityZ = life | (packHalf2x16(vec2(p.velocity.z, 0.0)) << 16);
+    packedData[i].velocityXY = packHalf2x16(p.velocity.xy);
+    packedData[i].colorSize = packUnorm4x8(vec4(p.color, p.size / PARTICLE_MAX_SIZE));
+}
+
+// Seule la vitesse est ecrite (la position peut etre lue par d'autres invocations)
+void storeParticleVelocity(uint i, vec3 v) {
+    if (!packedParticles) {
+        data[i].velocity = v;
+        return;
+    }
+    packedData[i].lifeVelocityZ = (packedData[i].lifeVelocityZ & 0xFFFFu) | (packHalf2x16(vec2(v.z, 0.0)) << 16);
+    packedData[i].velocityXY = packHalf2x16(v.xy);
+}
+#endif
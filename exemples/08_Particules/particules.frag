@@ -2,18 +2,33 @@
 
 in vec2 ex_TexCoor;
 in vec3 ex_color;
-out vec4 color;
+// Transparence ordonnee (une seule sortie) ou OIT pondere: accumulation
+// (RGBA16F) et revealage (R8), composes par particules_oit.frag
+layout(location = 0) out vec4 color;
+layout(location = 1) out float revealage;
 
 uniform float globalTransparency;
 
-uniform sampler2D texture;
+uniform sampler2D particleTexture;
 uniform bool useTexture;
 uniform float time; // Temps de la simulation
+uniform bool weightedBlend; // OIT pondere (McGuire et Bavoil, JCGT 2013)
+
+#include "camera.glsl"
+
+// Poids qui diminue avec la distance a la camera (equation 9 de l'article):
+// les particules proches dominent la moyenne, sans aucun tri
+float oitWeight(float alpha) {
+    float ndc = 2.0 * gl_FragCoord.z - 1.0;
+    float near = camera.clip.x, far = camera.clip.y;
+    float z = 2.0 * near * far / (far + near - ndc * (far - near));
+    return alpha * clamp(10.0 / (1e-5 + pow(z / 5.0, 2.0) + pow(z / 200.0, 6.0)), 1e-2, 3e3);
+}
 
 void main(void){
     vec4 outputColor = vec4(ex_color, globalTransparency);
     if(useTexture) {
-        outputColor = texture2D(texture, ex_TexCoor);
+        outputColor = texture(particleTexture, ex_TexCoor);
         
         // Play around with the values to change color of particles over time
         // https://github.com/StanEpp/OpenGL_ParticleSystem
@@ -26,5 +41,13 @@ void main(void){
         outputColor.z *= blue;
     }
 
+    if (weightedBlend) {
+        // Couleur premultipliee ponderee (blending: ONE, ONE) et produit des
+        // (1 - alpha) (blending: ZERO, ONE_MINUS_SRC_COLOR)
+        float alpha = clamp(outputColor.a, 0.0, 1.0);
+        color = vec4(outputColor.rgb * alpha, alpha) * oitWeight(alpha);
+        revealage = alpha;
+        return;
+    }
     color = outputColor;
 }
\ No newline at end of file
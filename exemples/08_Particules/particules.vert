@@ -1,27 +1,24 @@
 #version 460
 
-struct Particle{
-    vec3 position;
-    float life;
-    vec3 velocity;
-    float size;
-    vec3 color;
-    float _pad;
-};
+#include "particle.glsl"
 
-layout(binding = 0, std430) readonly buffer ssbo1 {
-    Particle data[];
+// Particules vivantes a dessiner, calculees par particules_sort.comp (y: indice)
+layout(binding = 2, std430) readonly buffer ssbo3 {
+    uvec2 order[];
 };
 
 uniform float globalSize;
+uniform bool useOrder; // Mode compute (sinon: particules deja triees par le CPU)
 
 out float quadLength;
 out vec3 quadColor;
 
 void main(void){
-    vec4 pPos = vec4(data[gl_VertexID].position, 1.0);
-    float pSize = data[gl_VertexID].size;
-    vec3 pColor = data[gl_VertexID].color;
+    uint index = useOrder ? order[gl_VertexID].y : uint(gl_VertexID);
+    Particle particle = loadParticle(index);
+    vec4 pPos = vec4(particle.position, 1.0);
+    float pSize = particle.size;
+    vec3 pColor = particle.color;
 
     gl_Position = pPos;
     quadLength = pSize * globalSize;
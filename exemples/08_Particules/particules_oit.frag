@@ -0,0 +1,26 @@
+#version 430
+
+// Composition de l'OIT pondere (McGuire et Bavoil, "Weighted Blended
+// Order-Independent Transparency", JCGT 2013)
+// La moyenne ponderee des couleurs est melangee avec l'image (blending:
+// SRC_ALPHA, ONE_MINUS_SRC_ALPHA), l'opacite est 1 - revealage.
+
+layout(binding = 0) uniform sampler2D accumulationTexture;
+layout(binding = 1) uniform sampler2D revealageTexture;
+
+out vec4 color;
+
+void main(void){
+    ivec2 pixel = ivec2(gl_FragCoord.xy);
+    float revealage = texelFetch(revealageTexture, pixel, 0).r;
+    if (revealage == 1.0) {
+        discard; // Aucune particule
+    }
+    vec4 accumulation = texelFetch(accumulationTexture, pixel, 0);
+    // Debordement des half float: la moyenne reste bornee
+    if (isinf(max(max(abs(accumulation.r), abs(accumulation.g)), abs(accumulation.b)))) {
+        accumulation.rgb = vec3(accumulation.a);
+    }
+    vec3 average = accumulation.rgb / max(accumulation.a, 1e-5);
+    color = vec4(average, 1.0 - revealage);
+}
@@ -0,0 +1,9 @@
+#version 430
+
+// Passe de composition de l'OIT pondere: un triangle qui couvre l'ecran
+// (aucun VBO, les sommets sont calcules avec gl_VertexID)
+
+void main(void){
+    vec2 position = vec2((gl_VertexID << 1) & 2, gl_VertexID & 2);
+    gl_Position = vec4(position * 2.0 - 1.0, 0.0, 1.0);
+}
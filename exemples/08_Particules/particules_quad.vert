@@ -0,0 +1,39 @@
+#version 460
+
+// Quads des particules sans geometry shader (vertex pulling)
+// Aucun VBO: une instance par particule (triangle strip de 4 sommets), la
+// particule est lue dans le SSBO avec gl_InstanceID et le coin avec gl_VertexID.
+// Le quad fait face a la camera: le decalage du coin est ajoute dans l'espace
+// de camera, apres la matrice vue-projection precalculee (camera.glsl).
+
+#include "particle.glsl"
+
+// Particules vivantes a dessiner, calculees par particules_sort.comp (y: indice)
+layout(binding = 2, std430) readonly buffer ssbo3 {
+    uvec2 order[];
+};
+
+#include "camera.glsl"
+
+uniform float globalSize;
+uniform bool useOrder; // Mode compute (sinon: particules deja triees par le CPU)
+
+out vec2 ex_TexCoor;
+out vec3 ex_color;
+
+void main(void){
+    // Meme ordre que le triangle strip de particules.geo: (0,0) (1,0) (0,1) (1,1)
+    uint particle = uint(gl_InstanceID);
+    vec2 corner = vec2(gl_VertexID & 1, gl_VertexID >> 1);
+    uint index = useOrder ? order[particle].y : particle;
+
+    Particle p = loadParticle(index);
+    float quadLength = p.size * globalSize;
+    vec4 particlePos = camera.viewProjection * vec4(p.position, 1.0);
+    // Decalage dans le plan de la camera (mise a l'echelle par la projection)
+    vec2 offset = (corner - 0.5) * quadLength;
+    gl_Position = particlePos + vec4(offset.x * camera.projection[0][0], offset.y * camera.projection[1][1], 0.0, 0.0);
+
+    ex_TexCoor = corner;
+    ex_color = p.color;
+}
@@ -7,6 +7,8 @@ layout(bindless_sampler) uniform sampler2D texARM;
 
 uniform bool activateARM;
 
+#include "phong.glsl"
+
 in vec2 fUV;
 in vec3 fNormal;
 in vec3 fViewDirection;
@@ -39,8 +41,7 @@ main()
     if (cosTheta >= 0)
     {
         // Reflexion
-        vec3 Rl = normalize(-LightDirection+2.0*nfNormal*dot(nfNormal,LightDirection));
-        float specular = pow(max(0.0, dot(Rl, nviewDirection)), n);
+        float specular = phongSpecular(LightDirection, nfNormal, nviewDirection, n);
 
         // Use phong model with ambiant and controlled metallic
         // the diffuse color is directly control with diffuse texture (Kd)
@@ -9,6 +9,8 @@
 #include <tuple>
 
 #include "ShaderProgram.h"
+#include "OnDemandRendering.h"
+#include "ResourceManager.h"
 
 typedef std::tuple<glm::vec3, glm::vec3, glm::vec3> vec3x3;
 typedef std::tuple<glm::vec2, glm::vec2, glm::vec2> vec2x3;
@@ -37,11 +39,6 @@ private:
 
 	void updateCameraEye();
 
-	bool loadTexture(const std::string& path, unsigned int& textureID,
-		GLint uvMode, // UV/ST warp mode
-		GLint minMode,  // Minfication
-		GLint magMode); // Magnification
-	
 	glm::vec3 computeTangentFace(vec3x3 pos, vec2x3 uvs) const;
 
 private:
@@ -61,15 +58,19 @@ private:
 	glm::vec3 m_eye, m_at, m_up;
 	glm::mat4 m_proj;
 
-	unsigned int m_diffTexID = -1 ;
-	unsigned int m_normalTexID = -1;
-	unsigned int m_ARMTexID = -1;
+	// Textures loaded in background (placeholders until loaded)
+	ResourceManager m_resources;
+	TextureHandle m_diffTexture;
+	TextureHandle m_normalTexture;
+	TextureHandle m_ARMTexture;
 
 	enum VAO_IDs { Triangles, NumVAOs };
 	enum Buffer_IDs { Position, UV, Normal, Tangent, NumBuffers };
 
 	// GLFW Window
 	GLFWwindow* m_window = nullptr;
+	// Draw only when something changed
+	OnDemandRendering m_onDemand;
 
 	GLuint m_VAOs[NumVAOs];
 	GLuint m_buffers[NumBuffers];
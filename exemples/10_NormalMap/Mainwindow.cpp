@@ -1,7 +1,5 @@
 #include "MainWindow.h"
-
-#define STB_IMAGE_IMPLEMENTATION
-#include <stb_image.h>
+#include "Benchmark.h"
 
 #include "imgui.h"
 #include "imgui_impl_glfw.h"
@@ -45,7 +43,7 @@ int MainWindow::Initialisation()
 
     // glfw window creation
     // --------------------
-    m_window = glfwCreateWindow(SCR_WIDTH, SCR_HEIGHT, "Normal Map", NULL, NULL);
+    m_window = Benchmark::createWindow(SCR_WIDTH, SCR_HEIGHT, "Normal Map");
     if (m_window == NULL)
     {
         std::cerr << "Failed to create GLFW window" << std::endl;
@@ -58,7 +56,7 @@ int MainWindow::Initialisation()
 
     // glad: load all OpenGL function pointers
     // ---------------------------------------
-    if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
+    if (!gladLoadGLLoader((GLADloadproc)Benchmark::getProcAddress))
     {
         std::cerr << "Failed to initialize GLAD" << std::endl;
         return 2;
@@ -76,6 +74,9 @@ int MainWindow::Initialisation()
     ImGui_ImplGlfw_InitForOpenGL(m_window, true);
     ImGui_ImplOpenGL3_Init(glsl_version);
 
+    // On-demand rendering (installed after the callbacks of ImGui)
+    m_onDemand.install(m_window);
+
     // Other openGL initialization
     // -----------------------------
     return InitializeGL();
@@ -217,18 +218,22 @@ int MainWindow::InitializeGL()
     std::string dispPath = assets_dir + "concrete_debris_disp_1k.jpg";
 
 
-    if (!loadTexture(diffPath, m_diffTexID, GL_CLAMP_TO_BORDER, GL_LINEAR_MIPMAP_LINEAR, GL_LINEAR)) {
-        std::cerr << "Unable to load texture: " << diffPath << std::endl;
-        return 4;
-    }
-    if (!loadTexture(normalPath, m_normalTexID, GL_CLAMP_TO_BORDER, GL_LINEAR_MIPMAP_LINEAR, GL_LINEAR)) {
-        std::cerr << "Unable to load texture: " << normalPath << std::endl;
-        return 4;
-    }
-    if (!loadTexture(ARMPath, m_ARMTexID, GL_CLAMP_TO_BORDER, GL_LINEAR_MIPMAP_LINEAR, GL_LINEAR)) {
-        std::cerr << "Unable to load texture: " << ARMPath << std::endl;
-        return 4;
-    }
+    // The textures are decoded by loading threads, the first frames use
+    // placeholders: checker (color), flat normal and rough dielectric (ARM)
+    m_resources.onLoaded = []() { glfwPostEmptyEvent(); };
+    TextureRequest request;
+    request.wrap = GL_CLAMP_TO_BORDER;
+    request.minFilter = GL_LINEAR_MIPMAP_LINEAR;
+    request.magFilter = GL_LINEAR;
+    m_diffTexture = m_resources.loadTexture(diffPath, request);
+    request.placeholderColor = true;
+    request.color = glm::vec4(0.5f, 0.5f, 1.0f, 1.0f);
+    m_normalTexture = m_resources.loadTexture(normalPath, request);
+    request.color = glm::vec4(1.0f, 1.0f, 0.0f, 1.0f);
+    m_ARMTexture = m_resources.loadTexture(ARMPath, request);
+    // Benchmark: the measured frames show the loaded textures
+    if (Benchmark::settings().frames > 0)
+        m_resources.finish();
     
     // Configure the texture uniform in advances
     {
@@ -264,6 +269,12 @@ int MainWindow::InitializeGL()
 
 void MainWindow::RenderImgui()
 {
+    // Nothing changed for the interface: draw the previous one again
+    if (!m_onDemand.imguiNeedsUpdate()) {
+        ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+        return;
+    }
+
     // Start the Dear ImGui frame
     ImGui_ImplOpenGL3_NewFrame();
     ImGui_ImplGlfw_NewFrame();
@@ -291,6 +302,10 @@ void MainWindow::RenderImgui()
             updateCameraEye();
         }
 
+        ImGui::Separator();
+        m_onDemand.drawImgui();
+        m_resources.drawImgui();
+
         ImGui::End();
     }
 
@@ -326,11 +341,11 @@ void MainWindow::RenderScene()
     m_mainShader->setVec3(m_uniforms.lightDirection, lightDir);
 
     glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, m_diffTexID);
+    glBindTexture(GL_TEXTURE_2D, m_diffTexture->id);
     glActiveTexture(GL_TEXTURE1);
-    glBindTexture(GL_TEXTURE_2D, m_normalTexID);
+    glBindTexture(GL_TEXTURE_2D, m_normalTexture->id);
     glActiveTexture(GL_TEXTURE2);
-    glBindTexture(GL_TEXTURE_2D, m_ARMTexID);
+    glBindTexture(GL_TEXTURE_2D, m_ARMTexture->id);
 
     glDrawArrays(GL_TRIANGLE_STRIP, 0, NumVertices);
     glFlush();
@@ -341,6 +356,14 @@ int MainWindow::RenderLoop()
 {
     while (!glfwWindowShouldClose(m_window))
     {
+        // Create the textures that finished loading (2 ms per frame)
+        if (m_resources.update() > 0)
+            m_onDemand.requestRedraw();
+
+        // Process the events, draw only when something changed
+        if (!m_onDemand.waitEvents())
+            continue;
+
         // Check inputs: Does ESC was pressed?
         if (glfwGetKey(m_window, GLFW_KEY_ESCAPE) == GLFW_PRESS)
             glfwSetWindowShouldClose(m_window, true);
@@ -348,12 +371,19 @@ int MainWindow::RenderLoop()
         RenderScene();
         RenderImgui();
 
-        // Show rendering and get events
+        // Frame measurements (benchmark mode, see Benchmark.h)
+        Benchmark::endFrame(m_window);
+
+        // Show rendering
         glfwSwapBuffers(m_window);
-        glfwPollEvents();
+        m_onDemand.endFrame();
     }
 
     // Cleanup
+    m_diffTexture.reset();
+    m_normalTexture.reset();
+    m_ARMTexture.reset();
+    m_resources.clear();
     ImGui_ImplOpenGL3_Shutdown();
     ImGui_ImplGlfw_Shutdown();
     ImGui::DestroyContext();
@@ -372,41 +402,3 @@ void MainWindow::updateCameraEye()
     longitude = glm::rotate(longitude, glm::radians(m_longitude), glm::vec3(0, 1, 0));
     m_eye = longitude * latitude * glm::vec4(m_eye,1);
 }
-
-bool MainWindow::loadTexture(const std::string& path, unsigned int& textureID, GLint uvMode, GLint minMode, GLint magMode)
-{
-    glGenTextures(1, &textureID);
-
-    // Ask the library to flip the image horizontally
-    // This is necessary as TexImage2D assume "The first element corresponds to the lower left corner of the texture image"
-    // whereas stb_image load the image such "the first pixel pointed to is top-left-most in the image"
-    stbi_set_flip_vertically_on_load(true);
-
-    int width, height, nrComponents;
-    unsigned char* data = stbi_load(path.c_str(), &width, &height, &nrComponents, STBI_rgb_alpha);
-    if (data)
-    {
-        glBindTexture(GL_TEXTURE_2D, textureID);
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, data);
-        if (minMode == GL_LINEAR_MIPMAP_LINEAR) {
-            glGenerateMipmap(GL_TEXTURE_2D);
-        }
-
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, uvMode);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, uvMode);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, minMode);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, magMode);
-
-        stbi_image_free(data);
-
-        std::cout << "Texture loaded at path: " << path << std::endl;
-    }
-    else
-    {
-        std::cout << "Texture failed to load at path: " << path << std::endl;
-        stbi_image_free(data);
-        return false;
-    }
-
-    return true;
-}
\ No newline at end of file
@@ -7,6 +7,8 @@ uniform bool activateARM;
 uniform bool activateNormalMap;
 uniform vec3 lightDirection;
 
+#include "phong.glsl"
+
 in vec2 fUV;
 in vec3 fNormal;
 in vec3 fTangent;
@@ -50,8 +52,7 @@ main()
     // Shading
     float cosTheta = max(0.0, dot(normal, lightDirection));
     if(cosTheta != 0.0) {
-        vec3 Rl = normalize(-lightDirection+2.0*normal*cosTheta);
-        float specular = pow(max(0.0, dot(Rl, nViewDirection)), n);
+        float specular = phongSpecular(lightDirection, normal, nViewDirection, n);
         vec4 Kd = texture(texColor, fUV);
         fColor = ao*0.2 + Kd * cosTheta * (1-propSpec) + vec4(1.0) * specular * propSpec;
     } else {
@@ -1,4 +1,5 @@
 #include "MainWindow.h"
+#include "Benchmark.h"
 
 #include <imgui.h>
 #include <imgui_impl_glfw.h>
@@ -45,7 +46,7 @@ int MainWindow::Initialisation()
 
 	// glfw window creation
 	// --------------------
-	m_window = glfwCreateWindow(SCR_WIDTH, SCR_HEIGHT, "Simple FBO", NULL, NULL);
+	m_window = Benchmark::createWindow(SCR_WIDTH, SCR_HEIGHT, "Simple FBO");
 	if (m_window == NULL)
 	{
 		std::cerr << "Failed to create GLFW window" << std::endl;
@@ -58,7 +59,7 @@ int MainWindow::Initialisation()
 
 	// glad: load all OpenGL function pointers
 	// ---------------------------------------
-	if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
+	if (!gladLoadGLLoader((GLADloadproc)Benchmark::getProcAddress))
 	{
 		std::cerr << "Failed to initialize GLAD" << std::endl;
 		return 2;
@@ -76,6 +77,9 @@ int MainWindow::Initialisation()
 	ImGui_ImplGlfw_InitForOpenGL(m_window, true);
 	ImGui_ImplOpenGL3_Init(glsl_version);
 
+	// On-demand rendering (installed after the callbacks of ImGui)
+	m_onDemand.install(m_window);
+
 	// Other openGL initialization
 // -----------------------------
 	return InitializeGL();
@@ -204,6 +208,13 @@ int MainWindow::InitializeGL()
 
 void MainWindow::RenderImgui()
 {
+	PROFILE_SCOPE("RenderImgui");
+	// Nothing changed for the interface: draw the previous one again
+	if (!m_onDemand.imguiNeedsUpdate()) {
+		ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+		return;
+	}
+
 	// Start the Dear ImGui frame
 	ImGui_ImplOpenGL3_NewFrame();
 	ImGui_ImplGlfw_NewFrame();
@@ -237,8 +248,13 @@ void MainWindow::RenderImgui()
 			m_light_position = m_eye;
 		}
 
+		ImGui::Separator();
+		m_onDemand.drawImgui();
+
 		ImGui::End();
 	}
+	m_gpuProfiler.drawImgui();
+	CpuProfiler::drawImgui();
 
 	ImGui::Render();
 	ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
@@ -246,6 +262,8 @@ void MainWindow::RenderImgui()
 
 void MainWindow::RenderScene()
 {
+	PROFILE_SCOPE("RenderScene");
+	m_gpuProfiler.push(m_activeFBO ? "FBO pass" : "Main pass");
 	if (m_activeFBO) {
 		// If true, we will redirect the rendering inside the texture
 		glBindFramebuffer(GL_FRAMEBUFFER, m_fboID);
@@ -287,8 +305,11 @@ void MainWindow::RenderScene()
 		glDrawArrays(GL_TRIANGLES, 0, m.numVertices);
 	}
 
+	m_gpuProfiler.pop();
+
 	// Second pass (only if the FBO is activated)
 	if (m_activeFBO) {
+		GpuTimer filterTimer(m_gpuProfiler, m_useFilter ? "Kuwahara filter" : "Copy");
 		glBindFramebuffer(GL_FRAMEBUFFER, 0);
 		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 		// Active the filter shader
@@ -314,16 +335,32 @@ int MainWindow::RenderLoop()
 {
 	while (!glfwWindowShouldClose(m_window))
 	{
+		PROFILE_SCOPE("RenderLoop");
+		// Process the events, draw only when something changed
+		if (!m_onDemand.waitEvents())
+			continue;
+
 		// Check inputs: Does ESC was pressed?
 		if (glfwGetKey(m_window, GLFW_KEY_ESCAPE) == GLFW_PRESS)
 			glfwSetWindowShouldClose(m_window, true);
 
+		m_gpuProfiler.beginFrame();
 		RenderScene();
-		RenderImgui();
+		{
+			GpuTimer timer(m_gpuProfiler, "ImGui");
+			RenderImgui();
+		}
+		m_gpuProfiler.endFrame();
+
+		// Frame measurements (benchmark mode, see Benchmark.h)
+		Benchmark::endFrame(m_window);
 
 		// Show rendering and get events
-		glfwSwapBuffers(m_window);
-		glfwPollEvents();
+		{
+			PROFILE_SCOPE("SwapBuffers");
+			glfwSwapBuffers(m_window);
+		}
+		m_onDemand.endFrame();
 	}
 
 	// Clean memory
@@ -338,6 +375,7 @@ int MainWindow::RenderLoop()
 		glDeleteBuffers(1, &m.vboNormal);
 	}
 	m_meshesGL.clear();
+	m_gpuProfiler.release();
 
 	// Cleanup
 	ImGui_ImplOpenGL3_Shutdown();
@@ -361,6 +399,7 @@ void MainWindow::updateCameraEye()
 
 void MainWindow::loadObjFile()
 {
+	PROFILE_SCOPE("loadObjFile");
 	std::string assets_dir = ASSETS_DIR;
 	std::string ObjPath = assets_dir + "bunny.obj";
 	// Load the obj file
@@ -10,6 +10,9 @@
 #include <memory>
 
 #include "ShaderProgram.h"
+#include "CpuProfiler.h"
+#include "GpuTimer.h"
+#include "OnDemandRendering.h"
 
 
 class MainWindow
@@ -42,6 +45,8 @@ private:
 private:
 	// GLFW Window
 	GLFWwindow* m_window = nullptr;
+	// Draw only when something changed
+	OnDemandRendering m_onDemand;
 
 	// settings
 	const unsigned int SCR_WIDTH = 900;
@@ -117,4 +122,7 @@ private:
 		unsigned int numVertices;
 	};
 	std::vector<MeshGL> m_meshesGL;
+
+	// GPU timings (FBO pass vs filter pass)
+	GpuProfiler m_gpuProfiler;
 };
@@ -8,6 +8,8 @@ layout(location = 7) uniform vec3 lightPos2;
 layout(location = 8) uniform vec3 lightPos3;
 
 
+#include "phong.glsl"
+
 in vec3 fNormal;
 in vec3 fPosition;
 
@@ -28,8 +30,7 @@ vec3 compute_direct_point(vec3 normal, vec3 viewDir, vec3 position, vec3 lightPo
     vec3 diffuse = Kd * max(0.0, dot(normal, LightDirection)) * I_light;
 
     // Compute specular component
-    vec3 Rl = normalize(-LightDirection+2.0*normal*dot(normal,LightDirection));
-    vec3 specular = Ks*pow(max(0.0, dot(Rl, viewDir)), Kn) * I_light;
+    vec3 specular = Ks*phongSpecular(LightDirection, normal, viewDir, Kn) * I_light;
 
     return diffuse +  specular;
 }
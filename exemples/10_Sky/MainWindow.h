@@ -9,6 +9,7 @@
 
 #include "ShaderProgram.h"
 #include "Camera.h"
+#include "CameraUBO.h"
 
 class MainWindow
 {
@@ -49,20 +50,12 @@ private:
 	// Skybox shader
 	std::unique_ptr<ShaderProgram> m_skydomeShader = nullptr;
 	int m_vSkyPos = -1;
-	struct {
-		GLint viewRotMatrix;
-		GLint projMatrix;
-		GLint texSkydome;
-	} m_uSky;
 	
 	// Normal shader
 	std::unique_ptr<ShaderProgram> m_mainShader = nullptr;
 	int m_vMainPos = -1;
 	int m_vMainNormal = -1;
 	struct {
-		GLint mvMatrix;
-		GLint projMatrix;
-		GLint cameraPos;
 		GLint texSkydome;
 		GLint useFresnel;
 	} m_uMain;
@@ -70,6 +63,7 @@ private:
 
 	// Camera
 	Camera m_camera;
+	CameraUBO m_cameraUBO; // View/projection of both programs (camera.glsl)
 	bool m_imGuiActive = false;
 
 	// Sphere
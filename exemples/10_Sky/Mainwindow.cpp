@@ -1,9 +1,9 @@
 #include "MainWindow.h"
+#include "Benchmark.h"
 
 #include <vector>
 #include <iostream>
 
-#define STB_IMAGE_IMPLEMENTATION
 #include <stb_image.h>
 
 #include "imgui.h"
@@ -41,7 +41,7 @@ int MainWindow::Initialisation()
 
     // glfw window creation
     // --------------------
-    m_window = glfwCreateWindow(m_windowWidth, m_windowHeight, "Sky", NULL, NULL);
+    m_window = Benchmark::createWindow(m_windowWidth, m_windowHeight, "Sky");
     if (m_window == NULL)
     {
         std::cerr << "Failed to create GLFW window" << std::endl;
@@ -54,7 +54,7 @@ int MainWindow::Initialisation()
 
     // glad: load all OpenGL function pointers
     // ---------------------------------------
-    if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
+    if (!gladLoadGLLoader((GLADloadproc)Benchmark::getProcAddress))
     {
         std::cerr << "Failed to initialize GLAD" << std::endl;
         return 2;
@@ -123,8 +123,6 @@ int MainWindow::InitializeGL()
         std::cerr << "Unable to find shader location for " << "vPosition" << std::endl;
         return 3;
     }
-    m_uSky.viewRotMatrix = m_skydomeShader->uniformLocation("viewRotMatrix");
-    m_uSky.projMatrix = m_skydomeShader->uniformLocation("projMatrix");
 
     // --- Normal
     m_mainShader = std::make_unique<ShaderProgram>();
@@ -143,13 +141,10 @@ int MainWindow::InitializeGL()
         std::cerr << "Unable to find shader location for " << "vNormal" << std::endl;
         return 3;
     }
-    m_uMain.mvMatrix = m_mainShader->uniformLocation("mvMatrix");
-    m_uMain.projMatrix = m_mainShader->uniformLocation("projMatrix");
-    m_uMain.cameraPos = m_mainShader->uniformLocation("cameraPos");
     m_uMain.texSkydome = m_mainShader->uniformLocation("texSkydome");
     m_uMain.useFresnel = m_mainShader->uniformLocation("useFresnel");
-    if(m_uMain.texSkydome < 0 | m_uMain.mvMatrix < 0 | m_uMain.projMatrix < 0 | m_uMain.cameraPos < 0 | m_uMain.useFresnel < 0) {
-        std::cerr << "Unable to find shader location for " << "mvMatrix, projMatrix, cameraPos, texSkydome, useFresnel" << std::endl;
+    if(m_uMain.texSkydome < 0 | m_uMain.useFresnel < 0) {
+        std::cerr << "Unable to find shader location for " << "texSkydome, useFresnel" << std::endl;
         return 3;
     }
 
@@ -163,7 +158,6 @@ int MainWindow::InitializeGL()
 
     // Set texture unit (all 0)
     // Not necessary because we specified binding in the shader
-    m_skydomeShader->setInt(m_uSky.texSkydome, 0);
     m_mainShader->setInt(m_uMain.texSkydome, 0);
 
     std::cout << "Load geometry ... \n";
@@ -210,26 +204,20 @@ void MainWindow::RenderScene()
 {
     // render
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-    
+
+    // Camera matrices used by both programs (bound once per frame)
+    m_cameraUBO.update(m_camera);
     
     // Use the same VAO for the skydome and the sphere
     glDisable(GL_DEPTH_TEST);
     glBindVertexArray(m_VAOs[VAO_Sphere]); 
     glUseProgram(m_skydomeShader->programId());
-    glm::mat4 modelMatrix = glm::mat4(1.0);
-    glm::mat4 viewMatrix = m_camera.viewMatrix();
-    m_skydomeShader->setMat4(m_uSky.projMatrix, m_camera.projectionMatrix());
-    m_skydomeShader->setMat3(m_uSky.viewRotMatrix, glm::mat3(viewMatrix));
     glBindTextureUnit(0, TextureId);
     glDrawElements(GL_TRIANGLES, numTriSphere * 3, GL_UNSIGNED_INT, 0);
     
     glEnable(GL_DEPTH_TEST);
-    glm::mat3 normalMat = glm::inverseTranspose(glm::mat3(viewMatrix));
     glBindVertexArray(m_VAOs[VAO_Sphere]);
     glUseProgram(m_mainShader->programId());
-    m_mainShader->setMat4(m_uMain.projMatrix, m_camera.projectionMatrix());
-    m_mainShader->setMat4(m_uMain.mvMatrix, viewMatrix);
-    m_mainShader->setVec3(m_uMain.cameraPos, m_camera.position());
     glDrawElements(GL_TRIANGLES, numTriSphere * 3, GL_UNSIGNED_INT, 0);
 }
 
@@ -254,12 +242,16 @@ int MainWindow::RenderLoop()
         RenderScene();
         RenderImgui();
 
+        // Frame measurements (benchmark mode, see Benchmark.h)
+        Benchmark::endFrame(m_window);
+
         // Show rendering and get events
         glfwSwapBuffers(m_window);
         glfwPollEvents();
     }
 
     // Cleanup
+    m_cameraUBO.release();
     ImGui_ImplOpenGL3_Shutdown();
     ImGui_ImplGlfw_Shutdown();
     ImGui::DestroyContext();
@@ -1,6 +1,6 @@
 #version 460 core
 
-uniform vec3 cameraPos;
+#include "camera.glsl"
 layout(binding = 0) uniform sampler2D texSkydome;
 uniform bool useFresnel; 
 
@@ -14,7 +14,7 @@ out vec4 oColor;
 void main()
 {
     // Local model
-    vec3 viewDirectionWorld = normalize(cameraPos - fPositionWorld);
+    vec3 viewDirectionWorld = normalize(camera.position.xyz - fPositionWorld);
     vec3 normalWorld = normalize(fNormalWorld);
 
     // Do a reflection
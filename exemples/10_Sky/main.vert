@@ -1,7 +1,6 @@
 #version 460 core
 
-uniform mat4 mvMatrix;
-uniform mat4 projMatrix;
+#include "camera.glsl"
 
 layout(location = 0) in vec4 vPosition;
 layout(location = 1) in vec3 vNormal;
@@ -11,8 +10,8 @@ out vec3 fPositionWorld;
 
 void main()
 {
-     vec4 vEyeCoord = mvMatrix * vPosition;
-     gl_Position = projMatrix * vEyeCoord;
+     // La sphere est en espace monde (pas de matrice modele)
+     gl_Position = camera.viewProjection * vPosition;
 
      // Direction de vue (pour la reflexion)
      // en espace monde
@@ -1,7 +1,6 @@
 #version 460 core
 
-uniform mat3 viewRotMatrix;
-uniform mat4 projMatrix;
+#include "camera.glsl"
 
 layout(location = 0) in vec3 vPosition;
 out vec3 fPosition;
@@ -10,8 +9,8 @@ void
 main()
 {
      // Ici on prends pas en compte la translation de la vue
-     vec3 vEyeCoord = viewRotMatrix * vPosition;
-     gl_Position = projMatrix * vec4(vEyeCoord, 1.0);
+     vec3 vEyeCoord = mat3(camera.view) * vPosition;
+     gl_Position = camera.projection * vec4(vEyeCoord, 1.0);
 
      // Vertex position (world)
      // En effet, cette position peut servir pour calculer directement la direction de vue
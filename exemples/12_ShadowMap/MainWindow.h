@@ -8,6 +8,9 @@
 #include <memory>
 
 #include "ShaderProgram.h"
+#include "GpuTimer.h"
+#include "CpuProfiler.h"
+#include "GLTrace.h"
 
 class MainWindow
 {
@@ -123,4 +126,7 @@ private:
 
 	// GLFW Window
 	GLFWwindow* m_window = nullptr;
+
+	// GPU timings (shadow pass vs main pass)
+	GpuProfiler m_gpuProfiler;
 };
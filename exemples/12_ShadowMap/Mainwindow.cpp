@@ -1,4 +1,5 @@
 #include "MainWindow.h"
+#include "Benchmark.h"
 
 #include <imgui.h>
 #include <imgui_impl_glfw.h>
@@ -47,7 +48,7 @@ int MainWindow::Initialisation()
 
 	// glfw window creation
 	// --------------------
-	m_window = glfwCreateWindow(SCR_WIDTH, SCR_HEIGHT, "Shadow Map", NULL, NULL);
+	m_window = Benchmark::createWindow(SCR_WIDTH, SCR_HEIGHT, "Shadow Map");
 	if (m_window == NULL)
 	{
 		std::cerr << "Failed to create GLFW window" << std::endl;
@@ -61,11 +62,13 @@ int MainWindow::Initialisation()
 
 	// glad: load all OpenGL function pointers
 	// ---------------------------------------
-	if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
+	if (!gladLoadGLLoader((GLADloadproc)Benchmark::getProcAddress))
 	{
 		std::cerr << "Failed to initialize GLAD" << std::endl;
 		return 2;
 	}
+	// Count the OpenGL calls (only if compiled with ENABLE_GL_TRACE)
+	GLTrace::install();
 
 	// imGui: create interface
 	// ---------------------------------------
@@ -232,13 +235,18 @@ int MainWindow::InitializeGL()
 
 void MainWindow::RenderScene()
 {
+	PROFILE_SCOPE("RenderScene");
 	// Compute camera
 	glm::mat4 lookAt = glm::lookAt(m_eye, m_at, m_up);
 
 	/////////////// 
 	//  Shadow pass
 	///////////////
-	ShadowRender();
+	{
+		GpuTimer timer(m_gpuProfiler, "Shadow pass");
+		ShadowRender();
+	}
+	GpuTimer timer(m_gpuProfiler, "Main pass");
 
 	////////////////////
 	// Normal rendering pass
@@ -300,6 +308,7 @@ void MainWindow::RenderScene()
 
 void MainWindow::RenderImgui()
 {
+	PROFILE_SCOPE("RenderImgui");
 	// Start the Dear ImGui frame
 	ImGui_ImplOpenGL3_NewFrame();
 	ImGui_ImplGlfw_NewFrame();
@@ -334,6 +343,9 @@ void MainWindow::RenderImgui()
 
 		ImGui::End();
 	}
+	m_gpuProfiler.drawImgui();
+	CpuProfiler::drawImgui();
+	GLTrace::drawImgui();
 
 	ImGui::Render();
 	ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
@@ -345,6 +357,7 @@ int MainWindow::RenderLoop()
 	float time = (float)glfwGetTime();
 	while (!glfwWindowShouldClose(m_window))
 	{
+		PROFILE_SCOPE("RenderLoop");
 		float new_time = (float)glfwGetTime();
 		const float delta_time = new_time - time;
 		time = new_time;
@@ -355,13 +368,26 @@ int MainWindow::RenderLoop()
 		if (glfwGetKey(m_window, GLFW_KEY_ESCAPE) == GLFW_PRESS)
 			glfwSetWindowShouldClose(m_window, true);
 
+		m_gpuProfiler.beginFrame();
 		RenderScene();
-		RenderImgui();
-
-		glfwSwapBuffers(m_window);
+		{
+			GpuTimer timer(m_gpuProfiler, "ImGui");
+			RenderImgui();
+		}
+		m_gpuProfiler.endFrame();
+		GLTrace::endFrame();
+
+		// Frame measurements (benchmark mode, see Benchmark.h)
+		Benchmark::endFrame(m_window);
+
+		{
+			PROFILE_SCOPE("SwapBuffers");
+			glfwSwapBuffers(m_window);
+		}
 		glfwPollEvents();
 	}
 
+	m_gpuProfiler.release();
 	glfwDestroyWindow(m_window);
 	glfwTerminate();
 
@@ -511,6 +537,7 @@ int MainWindow::InitGeometryFloor()
 
 void MainWindow::ShadowRender()
 {
+	PROFILE_SCOPE("ShadowRender");
 	
 	if (m_frontFaceCulling) {
 		glEnable(GL_CULL_FACE);
@@ -1,5 +1,7 @@
 #version 400 core
 
+#include "phong.glsl"
+
 in vec4 ifColor;
 in vec3 fNormal;
 in vec3 fPosition;
@@ -18,8 +20,7 @@ main()
     float diffuse = max(0.0, abs(dot(nfNormal, LightDirection)));
 
     // Compute specular component
-    vec3 Rl = normalize(-LightDirection+2.0*nfNormal*dot(nfNormal,LightDirection));
-    float specular = pow(max(0.0, dot(Rl, nviewDirection)), 128);
+    float specular = phongSpecular(LightDirection, nfNormal, nviewDirection, 128);
 
     // Compute final color
     fColor = ifColor * diffuse + vec4(vec3(0.5), 1.0) * specular;
@@ -0,0 +1,196 @@
+// CPU microbenchmarks used by the performance regression suite (see run_perf.py)
+// Each benchmark is repeated several times, the median duration is reported.
+//
+// Usage: perf_microbenchmarks [--json results.json] [--repeat N]
+
+#include "OBJLoader.h"
+#include "FrustumCulling.h"
+#include "JobSystem.h"
+#include "RadixSort.h"
+#include "Random.h"
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace
+{
+    // Same layout than the particles of 08_Particules
+    struct Particle
+    {
+        glm::vec3 p;
+        float life;
+        glm::vec3 v;
+        float size;
+        glm::vec3 c;
+        float padd;
+    };
+
+    // Median duration (ms) of the function
+    // setup() is called before each run and is not measured
+    double measure(int repeat, const std::function<void()>& setup, const std::function<void()>& run)
+    {
+        std::vector<double> times;
+        for (int i = 0; i < repeat; ++i)
+        {
+            setup();
+            const auto begin = std::chrono::steady_clock::now();
+            run();
+            const auto end = std::chrono::steady_clock::now();
+            times.push_back(std::chrono::duration<double, std::milli>(end - begin).count());
+        }
+        std::sort(times.begin(), times.end());
+        return times[times.size() / 2];
+    }
+}
+
+int main(int argc, char** argv)
+{
+    std::string jsonPath;
+    int repeat = 15;
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string arg = argv[i];
+        if (arg == "--json" && i + 1 < argc)
+            jsonPath = argv[++i];
+        else if (arg == "--repeat" && i + 1 < argc)
+            repeat = std::max(1, std::atoi(argv[++i]));
+    }
+
+    std::vector<std::pair<std::string, double>> results;
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<float> position(-100.0f, 100.0f);
+    auto nothing = []() {};
+
+    // OBJ loader
+    const std::string objPath = std::string(ASSETS_DIR) + "06_LightingCamera/assets/soccerball.obj";
+    results.emplace_back("obj_load_soccerball_ms", measure(repeat, nothing, [&]() {
+        OBJLoader::Loader loader;
+        if (!loader.loadFile(objPath))
+            std::cerr << "Impossible to load: " << objPath << std::endl;
+    }));
+
+    // Frustum culling (1M spheres)
+    FrustumCulling::Spheres spheres;
+    for (int i = 0; i < (1 << 20); ++i)
+        spheres.add(glm::vec3(position(rng), position(rng), position(rng)), 0.5f);
+    const glm::mat4 viewProj = glm::perspective(glm::radians(60.0f), 1.5f, 0.1f, 300.0f)
+        * glm::lookAt(glm::vec3(0.0f, 0.0f, 50.0f), glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+    glm::vec4 planes[6];
+    FrustumCulling::extractPlanes(viewProj, planes);
+    std::vector<uint32_t> visible;
+    results.emplace_back("cull_spheres_1M_ms", measure(repeat, nothing, [&]() {
+        FrustumCulling::cullSpheres(planes, spheres, visible);
+    }));
+
+    // Back to front sort of the particles (262k)
+    std::vector<Particle> reference(1 << 18);
+    for (Particle& p : reference)
+        p.p = glm::vec3(position(rng), position(rng), position(rng));
+    std::vector<Particle> particles;
+    const glm::vec3 eye(2.0f, 2.0f, 2.0f);
+    results.emplace_back("sort_particles_262k_ms", measure(repeat, [&]() { particles = reference; }, [&]() {
+        std::sort(particles.begin(), particles.end(), [&eye](const Particle& a, const Particle& b) {
+            return glm::dot(eye - a.p, eye - a.p) > glm::dot(eye - b.p, eye - b.p);
+        });
+    }));
+
+    // Same sort with precomputed keys and the parallel radix sort (08_Particules)
+    JobSystem& jobs = JobSystem::instance();
+    RadixSort sorter;
+    std::vector<uint32_t> keys(reference.size());
+    particles.resize(reference.size());
+    results.emplace_back("radix_sort_particles_262k_ms", measure(repeat, nothing, [&]() {
+        jobs.parallelFor(0, int(reference.size()), [&](int begin, int end) {
+            for (int i = begin; i < end; ++i)
+                keys[i] = RadixSort::floatKey(-glm::dot(eye - reference[i].p, eye - reference[i].p));
+        });
+        const std::vector<uint32_t>& order = sorter.sort(keys.data(), keys.size());
+        jobs.parallelFor(0, int(order.size()), [&](int begin, int end) {
+            for (int i = begin; i < end; ++i)
+                particles[i] = reference[order[i]];
+        });
+    }));
+    for (std::size_t i = 1; i < particles.size(); ++i)
+    {
+        if (glm::dot(eye - particles[i - 1].p, eye - particles[i - 1].p) < glm::dot(eye - particles[i].p, eye - particles[i].p))
+        {
+            std::cerr << "Radix sort: wrong order at " << i << std::endl;
+            return 1;
+        }
+    }
+
+    // Job system: scheduling overhead (10k empty jobs)
+    results.emplace_back("jobs_run_wait_10k_ms", measure(repeat, nothing, [&]() {
+        JobCounter counter;
+        for (int i = 0; i < 10000; ++i)
+            jobs.run([]() {}, &counter);
+        jobs.wait(counter);
+    }));
+
+    // Job system: parallelFor against a naive split with one std::thread per core
+    std::vector<float> values(1 << 22);
+    auto work = [&values](int begin, int end) {
+        for (int i = begin; i < end; ++i)
+            values[i] = std::sqrt(float(i)) * 0.5f + values[i] * 0.5f;
+    };
+    results.emplace_back("parallel_for_4M_ms", measure(repeat, nothing, [&]() {
+        jobs.parallelFor(0, int(values.size()), work);
+    }));
+    results.emplace_back("thread_split_4M_ms", measure(repeat, nothing, [&]() {
+        const int threads = std::max(1, jobs.threadCount());
+        const int chunk = (int(values.size()) + threads - 1) / threads;
+        std::vector<std::thread> workers;
+        for (int t = 1; t < threads; ++t)
+            workers.emplace_back(work, t * chunk, std::min(int(values.size()), (t + 1) * chunk));
+        work(0, std::min(int(values.size()), chunk));
+        for (std::thread& w : workers)
+            w.join();
+    }));
+
+    // Counter-based random numbers (SIMD fill), checked against the scalar version
+    results.emplace_back("random_fill_4M_ms", measure(repeat, nothing, [&]() {
+        Random::fill(Random::key(1, 0), 0, values.data(), values.size(), -1.0f, 1.0f);
+    }));
+    for (uint32_t i = 0; i < uint32_t(values.size()); i += 4097)
+    {
+        if (values[i] != Random::uniform(Random::key(1, 0), i, -1.0f, 1.0f))
+        {
+            std::cerr << "Random fill: wrong value at " << i << std::endl;
+            return 1;
+        }
+    }
+
+    // Report
+    std::cout << "CPU microbenchmarks (" << FrustumCulling::instructionSet() << ", " << jobs.threadCount()
+        << " job threads, median of " << repeat << "):\n";
+    for (const auto& r : results)
+        std::cout << "  " << r.first << ": " << r.second << "\n";
+    if (!jsonPath.empty())
+    {
+        std::ofstream file(jsonPath);
+        if (!file.is_open())
+        {
+            std::cerr << "Impossible to write: " << jsonPath << std::endl;
+            return 1;
+        }
+        file << "{\n";
+        for (std::size_t i = 0; i < results.size(); ++i)
+            file << "  \"" << results[i].first << "\": " << results[i].second << (i + 1 < results.size() ? ",\n" : "\n");
+        file << "}\n";
+    }
+    return 0;
+}
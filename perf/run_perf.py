@@ -0,0 +1,224 @@
+#!/usr/bin/env python3
+"""Performance regression suite.
+
+Runs headless scenes of the examples (Benchmark mode, Mesa llvmpipe) and the
+CPU microbenchmarks, then compares the results to a baseline JSON file.
+Fails (exit code 1) with a readable table when a metric regresses more than
+its tolerance.
+
+    python3 perf/run_perf.py --build-dir _build --baseline perf/baseline.json
+    python3 perf/run_perf.py --build-dir _build --baseline perf/baseline.json --update
+
+The timings depend on the machine: regenerate the baseline (--update) when the
+reference machine changes, and commit it with the change that explains it.
+The build needs to be optimized (CMAKE_BUILD_TYPE Release or RelWithDebInfo):
+the build type is stored in the baseline and the comparison is refused when
+it differs.
+"""
+
+import argparse
+import json
+import os
+import subprocess
+import sys
+import tempfile
+
+# name, example, options given to the example
+SCENES = [
+    ("particles_cpu_65k", "08_Particules", ["--set", "particles=65536", "--set", "compute=0"]),
+    ("particles_cpu_262k", "08_Particules", ["--set", "particles=262144", "--set", "compute=0"]),
+    ("particles_compute_65k", "08_Particules", ["--set", "particles=65536", "--set", "compute=1"]),
+    ("particles_compute_262k", "08_Particules", ["--set", "particles=262144", "--set", "compute=1"]),
+    # Same scenes, quads built in the vertex shader instead of the geometry shader
+    ("particles_quads_cpu_65k", "08_Particules", ["--set", "particles=65536", "--set", "compute=0", "--set", "quads=1"]),
+    ("particles_quads_cpu_262k", "08_Particules", ["--set", "particles=262144", "--set", "compute=0", "--set", "quads=1"]),
+    ("particles_quads_compute_65k", "08_Particules", ["--set", "particles=65536", "--set", "compute=1", "--set", "quads=1"]),
+    ("particles_quads_compute_262k", "08_Particules", ["--set", "particles=262144", "--set", "compute=1", "--set", "quads=1"]),
+    # Sorted alpha blending against the weighted blended OIT (no sort)
+    ("particles_alpha_cpu_262k", "08_Particules", ["--set", "particles=262144", "--set", "compute=0", "--set", "blend=0"]),
+    ("particles_oit_cpu_262k", "08_Particules", ["--set", "particles=262144", "--set", "compute=0", "--set", "blend=2"]),
+    ("particles_alpha_compute_262k", "08_Particules", ["--set", "particles=262144", "--set", "compute=1", "--set", "blend=0"]),
+    ("particles_oit_compute_262k", "08_Particules", ["--set", "particles=262144", "--set", "compute=1", "--set", "blend=2"]),
+    ("particles_grid_compute_262k", "08_Particules", ["--set", "particles=262144", "--set", "compute=1", "--set", "interact=1"]),
+    ("obj_lighting_camera", "06_LightingCamera", []),
+    ("obj_geometry_shader", "05_GeometryShader", []),
+    ("shadow_map", "12_ShadowMap", []),
+    ("fbo_filter", "10_SimpleFBO", []),
+]
+SCENE_METRICS = ["p50_ms", "p95_ms"]
+OPTIMIZED_BUILD_TYPES = ["Release", "RelWithDebInfo"]
+
+# Software rendering, identical on every machine without GPU
+# llvmpipe implements the features of OpenGL 4.6 used by the examples,
+# but old versions of Mesa only advertise 4.5
+ENVIRONMENT = {
+    "LIBGL_ALWAYS_SOFTWARE": "1",
+    "GALLIUM_DRIVER": "llvmpipe",
+    "MESA_GL_VERSION_OVERRIDE": "4.6",
+    "MESA_GLSL_VERSION_OVERRIDE": "460",
+}
+
+
+def find_executable(build_dir, name):
+    for sub in ("exemples", "exercices", "perf", ""):
+        for candidate in (os.path.join(build_dir, sub, name, name), os.path.join(build_dir, sub, name)):
+            for suffix in ("", ".exe"):
+                if os.path.isfile(candidate + suffix) and os.access(candidate + suffix, os.X_OK):
+                    return candidate + suffix
+    return None
+
+
+def cached_build_type(build_dir):
+    """CMAKE_BUILD_TYPE of a single configuration build (CMakeCache.txt)"""
+    try:
+        with open(os.path.join(build_dir, "CMakeCache.txt")) as f:
+            for line in f:
+                if line.startswith("CMAKE_BUILD_TYPE:"):
+                    return line.split("=", 1)[1].strip()
+    except OSError:
+        pass
+    return ""
+
+
+def run(command, env, cwd):
+    print("$ " + " ".join(command), flush=True)
+    result = subprocess.run(command, env=env, cwd=cwd, stdout=subprocess.PIPE,
+                            stderr=subprocess.STDOUT, universal_newlines=True)
+    if result.returncode != 0:
+        print(result.stdout)
+        print("  -> failed with exit code %d" % result.returncode)
+        return False
+    return True
+
+
+def collect(args):
+    env = dict(os.environ)
+    env.update(ENVIRONMENT)
+    metrics = {}
+    errors = []
+    with tempfile.TemporaryDirectory() as tmp:
+        for name, example, options in SCENES:
+            exe = find_executable(args.build_dir, example)
+            if exe is None:
+                errors.append("%s: executable %s not found" % (name, example))
+                continue
+            json_path = os.path.join(tmp, name + ".json")
+            command = [exe, "--headless", "--frames", str(args.frames), "--warmup", str(args.warmup),
+                       "--size", args.size, "--json", json_path] + options
+            if not run(command, env, os.path.dirname(exe)) or not os.path.isfile(json_path):
+                errors.append("%s: the scene did not run" % name)
+                continue
+            with open(json_path) as f:
+                stats = json.load(f)
+            for metric in SCENE_METRICS:
+                metrics["scene.%s.%s" % (name, metric)] = stats[metric]
+
+        exe = find_executable(args.build_dir, "perf_microbenchmarks")
+        json_path = os.path.join(tmp, "microbenchmarks.json")
+        if exe is None:
+            errors.append("perf_microbenchmarks not found")
+        elif not run([exe, "--json", json_path], env, tmp):
+            errors.append("perf_microbenchmarks failed")
+        else:
+            with open(json_path) as f:
+                for key, value in json.load(f).items():
+                    metrics["micro." + key] = value
+    return metrics, errors
+
+
+def compare(baseline, metrics):
+    default_tolerance = baseline.get("tolerance", 0.25)
+    rows = []
+    regressions = 0
+    for key, reference in sorted(baseline.get("metrics", {}).items()):
+        value = reference["value"] if isinstance(reference, dict) else reference
+        tolerance = reference.get("tolerance", default_tolerance) if isinstance(reference, dict) else default_tolerance
+        if key not in metrics:
+            rows.append((key, "%.3f" % value, "missing", "", "FAIL"))
+            regressions += 1
+            continue
+        current = metrics[key]
+        change = (current - value) / value if value > 0 else 0.0
+        status = "ok"
+        if change > tolerance:
+            status = "REGRESSION (> +%d%%)" % round(tolerance * 100)
+            regressions += 1
+        elif change < -tolerance:
+            status = "faster (update the baseline?)"
+        rows.append((key, "%.3f" % value, "%.3f" % current, "%+.1f%%" % (change * 100), status))
+    for key in sorted(set(metrics) - set(baseline.get("metrics", {}))):
+        rows.append((key, "", "%.3f" % metrics[key], "", "new (not in the baseline)"))
+
+    header = ("metric (ms)", "baseline", "current", "change", "status")
+    widths = [max(len(str(r[i])) for r in rows + [header]) for i in range(len(header))]
+    line = "  ".join("%-*s" % (w, h) for w, h in zip(widths, header))
+    print("\n" + line + "\n" + "-" * len(line))
+    for r in rows:
+        print("  ".join("%-*s" % (w, c) for w, c in zip(widths, r)))
+    return regressions
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--build-dir", required=True)
+    parser.add_argument("--baseline", required=True)
+    parser.add_argument("--build-type", help="build type of the executables (default: CMAKE_BUILD_TYPE of the build directory)")
+    parser.add_argument("--update", action="store_true", help="write the current results as the baseline")
+    parser.add_argument("--output", help="write the current results in this JSON file")
+    parser.add_argument("--frames", type=int, default=60)
+    parser.add_argument("--warmup", type=int, default=10)
+    parser.add_argument("--size", default="800x600")
+    args = parser.parse_args()
+    args.build_dir = os.path.abspath(args.build_dir)
+    build_type = args.build_type or cached_build_type(args.build_dir)
+    if build_type not in OPTIMIZED_BUILD_TYPES:
+        print("ERROR: the build type is '%s', the performance suite needs an optimized build (%s):"
+              % (build_type, " or ".join(OPTIMIZED_BUILD_TYPES)))
+        print("       configure with -DCMAKE_BUILD_TYPE=Release")
+        return 1
+    if not args.update:
+        with open(args.baseline) as f:
+            baseline = json.load(f)
+        if baseline.get("build_type") != build_type:
+            print("ERROR: the baseline was recorded with the build type '%s', this build is '%s'"
+                  % (baseline.get("build_type", ""), build_type))
+            return 1
+
+    metrics, errors = collect(args)
+    if args.output:
+        with open(args.output, "w") as f:
+            json.dump(metrics, f, indent=2, sort_keys=True)
+
+    if args.update:
+        previous = {}
+        if os.path.isfile(args.baseline):
+            with open(args.baseline) as f:
+                previous = json.load(f)
+        old = previous.get("metrics", {})
+        baseline = {
+            "description": previous.get("description", "Reference timings (ms), Mesa llvmpipe"),
+            "build_type": build_type,
+            "tolerance": previous.get("tolerance", 0.25),
+            "metrics": {},
+        }
+        for key, value in sorted(metrics.items()):
+            entry = {"value": round(value, 4)}
+            if isinstance(old.get(key), dict) and "tolerance" in old[key]:
+                entry["tolerance"] = old[key]["tolerance"]
+            baseline["metrics"][key] = entry
+        with open(args.baseline, "w") as f:
+            json.dump(baseline, f, indent=2)
+            f.write("\n")
+        print("Baseline written: " + args.baseline)
+    else:
+        regressions = compare(baseline, metrics)
+        if regressions:
+            errors.append("%d metric(s) regressed" % regressions)
+
+    for e in errors:
+        print("ERROR: " + e)
+    return 1 if errors else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,453 @@
+#include "Benchmark.h"
+
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+
+#include <stb_image_write.h>
+
+#ifdef BENCHMARK_EGL
+#define EGL_NO_X11
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#endif
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+namespace
+{
+    Benchmark::Settings g_settings;
+
+    // Frame measurements
+    int g_frame = 0;
+    std::chrono::steady_clock::time_point g_lastFrame;
+    std::vector<double> g_frameTimes; // ms
+
+#ifdef BENCHMARK_EGL
+    // Surfaceless context (headless mode)
+    struct Headless
+    {
+        EGLDisplay display = EGL_NO_DISPLAY;
+        EGLContext context = EGL_NO_CONTEXT;
+        GLuint fbo = 0;
+        GLuint color = 0;
+        GLuint depth = 0;
+        GLuint drawFramebuffer = 0; // Bindings seen by the application
+        GLuint readFramebuffer = 0;
+
+        // Original functions
+        PFNGLBINDFRAMEBUFFERPROC bindFramebuffer = nullptr;
+        PFNGLBLITNAMEDFRAMEBUFFERPROC blitNamedFramebuffer = nullptr;
+        PFNGLCLEARNAMEDFRAMEBUFFERFVPROC clearNamedFramebufferfv = nullptr;
+        PFNGLCLEARNAMEDFRAMEBUFFERIVPROC clearNamedFramebufferiv = nullptr;
+        PFNGLCLEARNAMEDFRAMEBUFFERUIVPROC clearNamedFramebufferuiv = nullptr;
+        PFNGLCLEARNAMEDFRAMEBUFFERFIPROC clearNamedFramebufferfi = nullptr;
+        PFNGLDRAWBUFFERPROC drawBuffer = nullptr;
+        PFNGLREADBUFFERPROC readBuffer = nullptr;
+    };
+    Headless g_headless;
+
+    // The default framebuffer (0) is replaced by the offscreen framebuffer
+    GLuint redirect(GLuint framebuffer)
+    {
+        return framebuffer == 0 ? g_headless.fbo : framebuffer;
+    }
+    GLenum redirectBuffer(GLenum buffer)
+    {
+        switch (buffer)
+        {
+        case GL_BACK: case GL_FRONT: case GL_BACK_LEFT: case GL_FRONT_LEFT:
+        case GL_LEFT: case GL_FRONT_AND_BACK:
+            return GL_COLOR_ATTACHMENT0;
+        }
+        return buffer;
+    }
+
+    void APIENTRY bindFramebuffer(GLenum target, GLuint framebuffer)
+    {
+        if (target == GL_FRAMEBUFFER || target == GL_DRAW_FRAMEBUFFER)
+            g_headless.drawFramebuffer = framebuffer;
+        if (target == GL_FRAMEBUFFER || target == GL_READ_FRAMEBUFFER)
+            g_headless.readFramebuffer = framebuffer;
+        g_headless.bindFramebuffer(target, redirect(framebuffer));
+    }
+    void APIENTRY blitNamedFramebuffer(GLuint read, GLuint draw, GLint srcX0, GLint srcY0, GLint srcX1, GLint srcY1,
+        GLint dstX0, GLint dstY0, GLint dstX1, GLint dstY1, GLbitfield mask, GLenum filter)
+    {
+        g_headless.blitNamedFramebuffer(redirect(read), redirect(draw), srcX0, srcY0, srcX1, srcY1,
+            dstX0, dstY0, dstX1, dstY1, mask, filter);
+    }
+    void APIENTRY clearNamedFramebufferfv(GLuint framebuffer, GLenum buffer, GLint drawbuffer, const GLfloat* value)
+    {
+        g_headless.clearNamedFramebufferfv(redirect(framebuffer), buffer, drawbuffer, value);
+    }
+    void APIENTRY clearNamedFramebufferiv(GLuint framebuffer, GLenum buffer, GLint drawbuffer, const GLint* value)
+    {
+        g_headless.clearNamedFramebufferiv(redirect(framebuffer), buffer, drawbuffer, value);
+    }
+    void APIENTRY clearNamedFramebufferuiv(GLuint framebuffer, GLenum buffer, GLint drawbuffer, const GLuint* value)
+    {
+        g_headless.clearNamedFramebufferuiv(redirect(framebuffer), buffer, drawbuffer, value);
+    }
+    void APIENTRY clearNamedFramebufferfi(GLuint framebuffer, GLenum buffer, GLint drawbuffer, GLfloat depth, GLint stencil)
+    {
+        g_headless.clearNamedFramebufferfi(redirect(framebuffer), buffer, drawbuffer, depth, stencil);
+    }
+    void APIENTRY drawBuffer(GLenum buffer)
+    {
+        g_headless.drawBuffer(g_headless.drawFramebuffer == 0 ? redirectBuffer(buffer) : buffer);
+    }
+    void APIENTRY readBuffer(GLenum buffer)
+    {
+        g_headless.readBuffer(g_headless.readFramebuffer == 0 ? redirectBuffer(buffer) : buffer);
+    }
+
+    // Create the surfaceless context and the offscreen framebuffer
+    bool createHeadlessContext(int width, int height)
+    {
+        Headless& h = g_headless;
+        PFNEGLGETPLATFORMDISPLAYEXTPROC getPlatformDisplay =
+            (PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+        if (getPlatformDisplay)
+            h.display = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+        if (h.display == EGL_NO_DISPLAY)
+            h.display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+        EGLint major = 0, minor = 0;
+        if (h.display == EGL_NO_DISPLAY || !eglInitialize(h.display, &major, &minor))
+        {
+            std::cerr << "Benchmark: impossible to initialize EGL\n";
+            return false;
+        }
+        eglBindAPI(EGL_OPENGL_API);
+
+        // No surface type required (the default is EGL_WINDOW_BIT)
+        const EGLint configAttributes[] = { EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT, EGL_SURFACE_TYPE, 0, EGL_NONE };
+        EGLConfig config = nullptr;
+        EGLint count = 0;
+        if (!eglChooseConfig(h.display, configAttributes, &config, 1, &count) || count == 0)
+        {
+            std::cerr << "Benchmark: no EGL configuration for OpenGL\n";
+            return false;
+        }
+
+        // OpenGL 4.6 core, or 4.5 (enough for the DSA functions) if not available
+        for (int version : { 6, 5 })
+        {
+            const EGLint contextAttributes[] = {
+                EGL_CONTEXT_MAJOR_VERSION, 4,
+                EGL_CONTEXT_MINOR_VERSION, version,
+                EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+                EGL_NONE };
+            h.context = eglCreateContext(h.display, config, EGL_NO_CONTEXT, contextAttributes);
+            if (h.context != EGL_NO_CONTEXT)
+                break;
+        }
+        if (h.context == EGL_NO_CONTEXT || !eglMakeCurrent(h.display, EGL_NO_SURFACE, EGL_NO_SURFACE, h.context))
+        {
+            std::cerr << "Benchmark: impossible to create a surfaceless OpenGL context\n";
+            return false;
+        }
+
+        h.bindFramebuffer = (PFNGLBINDFRAMEBUFFERPROC)eglGetProcAddress("glBindFramebuffer");
+        h.blitNamedFramebuffer = (PFNGLBLITNAMEDFRAMEBUFFERPROC)eglGetProcAddress("glBlitNamedFramebuffer");
+        h.clearNamedFramebufferfv = (PFNGLCLEARNAMEDFRAMEBUFFERFVPROC)eglGetProcAddress("glClearNamedFramebufferfv");
+        h.clearNamedFramebufferiv = (PFNGLCLEARNAMEDFRAMEBUFFERIVPROC)eglGetProcAddress("glClearNamedFramebufferiv");
+        h.clearNamedFramebufferuiv = (PFNGLCLEARNAMEDFRAMEBUFFERUIVPROC)eglGetProcAddress("glClearNamedFramebufferuiv");
+        h.clearNamedFramebufferfi = (PFNGLCLEARNAMEDFRAMEBUFFERFIPROC)eglGetProcAddress("glClearNamedFramebufferfi");
+        h.drawBuffer = (PFNGLDRAWBUFFERPROC)eglGetProcAddress("glDrawBuffer");
+        h.readBuffer = (PFNGLREADBUFFERPROC)eglGetProcAddress("glReadBuffer");
+        if (!gladLoadGLLoader((GLADloadproc)Benchmark::getProcAddress))
+        {
+            std::cerr << "Benchmark: impossible to load the OpenGL functions\n";
+            return false;
+        }
+
+        // Offscreen framebuffer, used in place of the default framebuffer
+        glCreateRenderbuffers(1, &h.color);
+        glNamedRenderbufferStorage(h.color, GL_RGBA8, width, height);
+        glCreateRenderbuffers(1, &h.depth);
+        glNamedRenderbufferStorage(h.depth, GL_DEPTH24_STENCIL8, width, height);
+        glCreateFramebuffers(1, &h.fbo);
+        glNamedFramebufferRenderbuffer(h.fbo, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, h.color);
+        glNamedFramebufferRenderbuffer(h.fbo, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, h.depth);
+        if (glCheckNamedFramebufferStatus(h.fbo, GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+        {
+            std::cerr << "Benchmark: incomplete offscreen framebuffer\n";
+            return false;
+        }
+        h.bindFramebuffer(GL_FRAMEBUFFER, h.fbo);
+        // No surface: the viewport is not initialized by the context
+        glViewport(0, 0, width, height);
+
+        std::cout << "Benchmark: headless EGL context (" << glGetString(GL_RENDERER) << ", "
+                  << glGetString(GL_VERSION) << ")\n";
+        return true;
+    }
+#endif
+
+    double percentile(const std::vector<double>& sorted, double p)
+    {
+        if (sorted.empty())
+            return 0.0;
+        const std::size_t i = std::size_t(p * double(sorted.size() - 1) + 0.5);
+        return sorted[std::min(i, sorted.size() - 1)];
+    }
+
+    void printStatistics(GLFWwindow* window)
+    {
+        std::vector<double> sorted = g_frameTimes;
+        std::sort(sorted.begin(), sorted.end());
+        double sum = 0.0;
+        for (double t : sorted)
+            sum += t;
+        const double mean = sorted.empty() ? 0.0 : sum / double(sorted.size());
+
+        int width = 0, height = 0;
+        glfwGetFramebufferSize(window, &width, &height);
+        char text[512];
+        std::snprintf(text, sizeof(text),
+            "Benchmark: %d frames measured (%dx%d, %s)\n"
+            "  mean %.3f ms (%.1f fps)\n"
+            "  p50 %.3f ms, p95 %.3f ms, p99 %.3f ms\n"
+            "  min %.3f ms, max %.3f ms\n",
+            int(sorted.size()), width, height, (const char*)glGetString(GL_RENDERER),
+            mean, mean > 0.0 ? 1000.0 / mean : 0.0,
+            percentile(sorted, 0.50), percentile(sorted, 0.95), percentile(sorted, 0.99),
+            sorted.empty() ? 0.0 : sorted.front(), sorted.empty() ? 0.0 : sorted.back());
+        std::cout << text;
+        std::cout.flush();
+
+        if (g_settings.json.empty())
+            return;
+        std::ofstream file(g_settings.json);
+        if (!file.is_open())
+        {
+            std::cerr << "Impossible to write: " << g_settings.json << std::endl;
+            return;
+        }
+        std::snprintf(text, sizeof(text),
+            "{\n"
+            "  \"frames\": %d,\n"
+            "  \"width\": %d,\n"
+            "  \"height\": %d,\n"
+            "  \"mean_ms\": %.4f,\n"
+            "  \"p50_ms\": %.4f,\n"
+            "  \"p95_ms\": %.4f,\n"
+            "  \"p99_ms\": %.4f,\n"
+            "  \"min_ms\": %.4f,\n"
+            "  \"max_ms\": %.4f\n"
+            "}\n",
+            int(sorted.size()), width, height, mean,
+            percentile(sorted, 0.50), percentile(sorted, 0.95), percentile(sorted, 0.99),
+            sorted.empty() ? 0.0 : sorted.front(), sorted.empty() ? 0.0 : sorted.back());
+        file << text;
+    }
+
+    bool saveScreenshot(GLFWwindow* window, const std::string& path)
+    {
+        int width = 0, height = 0;
+        glfwGetFramebufferSize(window, &width, &height);
+        std::vector<unsigned char> pixels(std::size_t(width) * height * 4);
+        // Back buffer of the default framebuffer (before the swap)
+        // Note: redirected to the offscreen framebuffer in headless mode
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+        glReadBuffer(GL_BACK);
+        glPixelStorei(GL_PACK_ALIGNMENT, 1);
+        glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+
+        stbi_flip_vertically_on_write(1);
+        if (!stbi_write_png(path.c_str(), width, height, 4, pixels.data(), width * 4))
+        {
+            std::cerr << "Impossible to write: " << path << std::endl;
+            return false;
+        }
+        std::cout << "Screenshot saved: " << path << "\n";
+        return true;
+    }
+}
+
+bool Benchmark::parseArguments(int argc, char** argv)
+{
+    bool valid = true;
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string arg = argv[i];
+        const bool hasValue = i + 1 < argc;
+        if (arg == "--headless")
+        {
+            g_settings.headless = true;
+        }
+        else if (arg == "--egl")
+        {
+            g_settings.egl = true;
+        }
+        else if (arg == "--frames" && hasValue)
+        {
+            g_settings.frames = std::max(0, std::atoi(argv[++i]));
+        }
+        else if (arg == "--warmup" && hasValue)
+        {
+            g_settings.warmup = std::max(0, std::atoi(argv[++i]));
+        }
+        else if (arg == "--size" && hasValue)
+        {
+            int w = 0, h = 0;
+            if (std::sscanf(argv[++i], "%dx%d", &w, &h) == 2 && w > 0 && h > 0)
+            {
+                g_settings.width = w;
+                g_settings.height = h;
+            }
+            else
+            {
+                std::cerr << "Invalid size (expected WxH): " << argv[i] << std::endl;
+                valid = false;
+            }
+        }
+        else if (arg == "--screenshot" && hasValue)
+        {
+            g_settings.screenshot = argv[++i];
+        }
+        else if (arg == "--camera-path" && hasValue)
+        {
+            g_settings.cameraPath = argv[++i];
+        }
+        else if (arg == "--json" && hasValue)
+        {
+            g_settings.json = argv[++i];
+        }
+        else if (arg == "--set" && hasValue)
+        {
+            const std::string option = argv[++i];
+            const std::size_t pos = option.find('=');
+            if (pos == std::string::npos || pos == 0)
+            {
+                std::cerr << "Invalid option (expected key=value): " << option << std::endl;
+                valid = false;
+            }
+            else
+            {
+                g_settings.options[option.substr(0, pos)] = option.substr(pos + 1);
+            }
+        }
+        else if (arg == "--help")
+        {
+            std::cout << "Options: --headless --frames N --size WxH --warmup N "
+                         "--screenshot file.png --camera-path file --json file.json "
+                         "--set key=value --egl\n";
+        }
+    }
+    return valid;
+}
+
+const Benchmark::Settings& Benchmark::settings()
+{
+    return g_settings;
+}
+
+int Benchmark::option(const std::string& key, int defaultValue)
+{
+    auto it = g_settings.options.find(key);
+    return it == g_settings.options.end() ? defaultValue : std::atoi(it->second.c_str());
+}
+
+GLFWwindow* Benchmark::createWindow(int width, int height, const char* title)
+{
+    if (g_settings.headless)
+        glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+    if (g_settings.egl)
+        glfwWindowHint(GLFW_CONTEXT_CREATION_API, GLFW_EGL_CONTEXT_API);
+    if (g_settings.width > 0)
+    {
+        width = g_settings.width;
+        height = g_settings.height;
+    }
+
+#ifdef BENCHMARK_EGL
+    if (g_settings.headless)
+    {
+        // The window only provides the (empty) inputs, the context is created by EGL
+        glfwWindowHint(GLFW_CLIENT_API, GLFW_NO_API);
+        GLFWwindow* window = glfwCreateWindow(width, height, title, nullptr, nullptr);
+        if (window && !createHeadlessContext(width, height))
+        {
+            glfwDestroyWindow(window);
+            return nullptr;
+        }
+        return window;
+    }
+#endif
+    return glfwCreateWindow(width, height, title, nullptr, nullptr);
+}
+
+void* Benchmark::getProcAddress(const char* name)
+{
+#ifdef BENCHMARK_EGL
+    if (g_headless.context != EGL_NO_CONTEXT)
+    {
+        struct Redirection { const char* name; void* function; };
+        const Redirection redirections[] = {
+            { "glBindFramebuffer", (void*)&bindFramebuffer },
+            { "glBlitNamedFramebuffer", (void*)&blitNamedFramebuffer },
+            { "glClearNamedFramebufferfv", (void*)&clearNamedFramebufferfv },
+            { "glClearNamedFramebufferiv", (void*)&clearNamedFramebufferiv },
+            { "glClearNamedFramebufferuiv", (void*)&clearNamedFramebufferuiv },
+            { "glClearNamedFramebufferfi", (void*)&clearNamedFramebufferfi },
+            { "glDrawBuffer", (void*)&drawBuffer },
+            { "glReadBuffer", (void*)&readBuffer },
+        };
+        for (const Redirection& r : redirections)
+        {
+            if (std::strcmp(name, r.name) == 0)
+                return r.function;
+        }
+        return (void*)eglGetProcAddress(name);
+    }
+#endif
+    return (void*)glfwGetProcAddress(name);
+}
+
+void Benchmark::endFrame(GLFWwindow* window)
+{
+#ifdef BENCHMARK_EGL
+    // No swap to throttle the CPU: wait for the rendering of the frame
+    if (g_headless.context != EGL_NO_CONTEXT)
+        glFinish();
+#endif
+    const auto now = std::chrono::steady_clock::now();
+    if (g_frame == 0)
+    {
+        if ((g_settings.headless || g_settings.frames > 0) && glfwGetCurrentContext())
+            glfwSwapInterval(0);
+        // The example sets its viewport/projection inside its framebuffer size
+        // callback: notify it of the size chosen by the benchmark
+        if (g_settings.width > 0)
+        {
+            GLFWframebuffersizefun callback = glfwSetFramebufferSizeCallback(window, nullptr);
+            glfwSetFramebufferSizeCallback(window, callback);
+            int width = 0, height = 0;
+            glfwGetFramebufferSize(window, &width, &height);
+            if (callback)
+                callback(window, width, height);
+        }
+    }
+    else if (g_frame > g_settings.warmup)
+    {
+        g_frameTimes.push_back(std::chrono::duration<double, std::milli>(now - g_lastFrame).count());
+    }
+    g_lastFrame = now;
+    g_frame++;
+
+    if (g_settings.frames > 0 && g_frame >= g_settings.frames + g_settings.warmup + 1)
+    {
+        if (!g_settings.screenshot.empty())
+            saveScreenshot(window, g_settings.screenshot);
+        printStatistics(window);
+        glfwSetWindowShouldClose(window, true);
+    }
+}
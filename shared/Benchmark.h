@@ -0,0 +1,71 @@
+#pragma once
+
+#include <map>
+#include <string>
+
+struct GLFWwindow;
+
+// Benchmark mode shared by all the examples (command line options)
+//   --headless        offscreen rendering, no vsync (see below)
+//   --frames N        measure N frames (after the warm-up), print the frame
+//                     time statistics and exit
+//   --size WxH        size of the window (framebuffer)
+//   --warmup N        first frames ignored by the statistics (default: 5)
+//   --screenshot F    save the last frame inside a PNG file
+//   --camera-path F   camera path to play (examples using CameraPath)
+//   --json F          write the statistics inside a JSON file
+//   --set key=value   option read by the example (see Benchmark::option)
+//   --egl             create the context of the window with EGL instead of GLX/WGL
+//
+// Headless rendering:
+//  - if EGL is found by CMake (BENCHMARK_EGL), a surfaceless EGL context is
+//    created (Mesa llvmpipe works without display and without GPU).
+//    The window has no context, the default framebuffer (0) is redirected
+//    to an offscreen framebuffer object of the benchmark size.
+//  - otherwise the window is only hidden. On machines without display,
+//    configure with -DGLFW_USE_OSMESA=ON (GLFW renders offscreen with OSMesa).
+//
+// Usage:
+//   int main(int argc, char** argv) { Benchmark::parseArguments(argc, argv); ... }
+//   m_window = Benchmark::createWindow(SCR_WIDTH, SCR_HEIGHT, "Title");
+//   gladLoadGLLoader((GLADloadproc)Benchmark::getProcAddress);
+//   ...
+//   Benchmark::endFrame(m_window); // Before glfwSwapBuffers
+namespace Benchmark
+{
+    struct Settings
+    {
+        bool headless = false;
+        int frames = 0; // 0 = run until the window is closed
+        int width = 0;  // 0 = size chosen by the example
+        int height = 0;
+        int warmup = 5;
+        bool egl = false;
+        std::string screenshot;
+        std::string cameraPath;
+        std::string json;
+        std::map<std::string, std::string> options;
+    };
+
+    // ------------------------------------------------------------------------
+    // read the options (the unknown ones are ignored)
+    // return false if an option is invalid
+    bool parseArguments(int argc, char** argv);
+    const Settings& settings();
+    // value of an option given with --set key=value
+    int option(const std::string& key, int defaultValue);
+
+    // ------------------------------------------------------------------------
+    // replace glfwCreateWindow (window hints, size and headless context)
+    GLFWwindow* createWindow(int width, int height, const char* title);
+
+    // ------------------------------------------------------------------------
+    // replace glfwGetProcAddress (needed by the headless context)
+    void* getProcAddress(const char* name);
+
+    // ------------------------------------------------------------------------
+    // measure the frame, to call before glfwSwapBuffers
+    // When the number of frames is reached: save the screenshot, print the
+    // statistics and ask the window to close
+    void endFrame(GLFWwindow* window);
+}
@@ -10,6 +10,7 @@
  */
 
 #include "Camera.h"
+#include "FrustumCulling.h"
 
 Camera::Camera(int width, int height,
     const glm::vec3& position,
@@ -20,7 +21,6 @@ Camera::Camera(int width, int height,
 {;
     m_direction = glm::normalize(m_direction);
     computeAngles();
-    updateProjectionMatrix();
 }
 
 void Camera::keybordEvents(GLFWwindow * w, const float delta_time) {
@@ -49,7 +49,7 @@ void Camera::keybordEvents(GLFWwindow * w, const float delta_time) {
     }
 
     if(update_position) {
-        updateProjectionMatrix();
+        viewChanged();
     }
 }
 
@@ -75,7 +75,7 @@ void Camera::mouseEvents(const glm::vec2& mousePos, bool clicked) {
         m_direction.z = sin(glm::radians(yaw)) * cos(glm::radians(pitch));
         m_direction = glm::normalize(m_direction); // Unecessary in case of 
 
-        updateProjectionMatrix();
+        viewChanged();
     }
     m_mouse_was_clicked = clicked;
 }
@@ -83,7 +83,7 @@ void Camera::mouseEvents(const glm::vec2& mousePos, bool clicked) {
 void Camera::viewportEvents(int width, int height) {
     // Update the matrix
     m_image_ratio = float(width) / height;
-    if (m_image_ratio > 1e-6) updateProjectionMatrix();
+    if (m_image_ratio > 1e-6) projectionChanged();
 }
 
 void Camera::computeAngles() {
@@ -109,6 +109,18 @@ void Camera::computeAngles() {
     pitch = glm::degrees(asin(m_direction.y));
 }
 
-void Camera::updateProjectionMatrix() {
-    m_proj_matrix = glm::perspective(m_fov, m_image_ratio, 0.1f, 300.0f);
+void Camera::computeMatrices() const {
+    if (m_view_dirty) {
+        m_view_matrix = glm::lookAt(m_position, m_position + m_direction, m_up);
+        m_inv_view_matrix = glm::inverse(m_view_matrix);
+        m_view_dirty = false;
+    }
+    if (m_proj_dirty) {
+        m_proj_matrix = glm::perspective(m_fov, m_image_ratio, m_near, m_far);
+        m_inv_proj_matrix = glm::inverse(m_proj_matrix);
+        m_proj_dirty = false;
+    }
+    m_view_proj_matrix = m_proj_matrix * m_view_matrix;
+
+    FrustumCulling::extractPlanes(m_view_proj_matrix, m_frustum_planes);
 }
\ No newline at end of file
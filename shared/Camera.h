@@ -6,6 +6,7 @@
 
 #include <GLFW/glfw3.h>
 
+#include <cstdint>
 #include <iostream>
 
 class Camera {
@@ -21,38 +22,78 @@ public:
     void mouseEvents(const glm::vec2& mousePos, bool clicked) ;
     void viewportEvents(int width, int height);
 
-    // Compute view matrix
-    glm::mat4 viewMatrix() const {
-        return glm::lookAt(m_position, m_position+m_direction, m_up);
+    // Matrices are cached and only recomputed when the camera changes
+    // View matrix
+    const glm::mat4& viewMatrix() const {
+        updateMatrices();
+        return m_view_matrix;
     }
-    // Compute (perspective) projection matrix
-    glm::mat4 projectionMatrix() const {
+    // (Perspective) projection matrix
+    const glm::mat4& projectionMatrix() const {
+        updateMatrices();
         return m_proj_matrix;
     }
+    // projection * view
+    const glm::mat4& viewProjectionMatrix() const {
+        updateMatrices();
+        return m_view_proj_matrix;
+    }
+    const glm::mat4& inverseViewMatrix() const {
+        updateMatrices();
+        return m_inv_view_matrix;
+    }
+    const glm::mat4& inverseProjectionMatrix() const {
+        updateMatrices();
+        return m_inv_proj_matrix;
+    }
+    // Frustum planes in world space (left, right, bottom, top, near, far)
+    // xyz: normalized normal pointing inside, w: distance
+    // A point p is inside a plane if dot(plane.xyz, p) + plane.w >= 0
+    // (see FrustumCulling to test many bounding volumes)
+    const glm::vec4* frustumPlanes() const {
+        updateMatrices();
+        return m_frustum_planes;
+    }
+    // Incremented each time the camera changes
+    // (can be used to know if a value depending on the camera is outdated)
+    uint64_t version() const { return m_version; }
 
     void setPosition(const glm::vec3& pos) {
         m_position = pos;
         computeAngles();
+        viewChanged();
     }
     void setDirection(const glm::vec3& dir) {
         m_direction = dir;
         computeAngles();
+        viewChanged();
     }
     void setFar(float far) {
         m_far = far;
-        updateProjectionMatrix();
+        projectionChanged();
     }
     void setNear(float near) {
         m_near = near;
-        updateProjectionMatrix();
+        projectionChanged();
     }
     const glm::vec3& position() const { return m_position;  }
+    const glm::vec3& direction() const { return m_direction; }
     float fieldOfView() const { return m_fov;  }
+    float nearPlane() const { return m_near; }
+    float farPlane() const { return m_far; }
 private:
     // Compute yaw and vertical angles for the view direction
     void computeAngles();
 
-    void updateProjectionMatrix();
+    // Invalidate the cached matrices
+    void viewChanged() { m_view_dirty = true; m_version++; }
+    void projectionChanged() { m_proj_dirty = true; m_version++; }
+    // Recompute the invalidated matrices
+    void updateMatrices() const {
+        if (m_view_dirty || m_proj_dirty)
+            computeMatrices();
+    }
+    void computeMatrices() const;
 
 private:
     // Camera parameters
@@ -67,8 +108,18 @@ private:
     const float m_fov = glm::radians(45.0f);
 	float m_image_ratio;
     float m_near = 0.1f;
-    float m_far = 100.0f;
-    glm::mat4 m_proj_matrix;
+    float m_far = 300.0f;
+
+    // Cached matrices
+    mutable bool m_view_dirty = true;
+    mutable bool m_proj_dirty = true;
+    mutable glm::mat4 m_view_matrix;
+    mutable glm::mat4 m_proj_matrix;
+    mutable glm::mat4 m_view_proj_matrix;
+    mutable glm::mat4 m_inv_view_matrix;
+    mutable glm::mat4 m_inv_proj_matrix;
+    mutable glm::vec4 m_frustum_planes[6];
+    uint64_t m_version = 1;
 
     // Orientation in degrees
     float yaw;
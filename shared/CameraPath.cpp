@@ -0,0 +1,232 @@
+#include "CameraPath.h"
+#include "Camera.h"
+
+#include <imgui.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+namespace
+{
+    // File header
+    const char Magic[4] = { 'C', 'P', 'T', 'H' };
+    const uint32_t Version = 1;
+
+    // Uniform Catmull-Rom spline between p1 and p2
+    glm::vec3 catmullRom(const glm::vec3& p0, const glm::vec3& p1, const glm::vec3& p2, const glm::vec3& p3, float u)
+    {
+        const float u2 = u * u;
+        const float u3 = u2 * u;
+        return 0.5f * ((2.0f * p1) + (-p0 + p2) * u
+            + (2.0f * p0 - 5.0f * p1 + 4.0f * p2 - p3) * u2
+            + (-p0 + 3.0f * p1 - 3.0f * p2 + p3) * u3);
+    }
+}
+
+void CameraPath::startRecording()
+{
+    stopPlayback();
+    m_keys.clear();
+    m_recordStart = -1.0;
+    m_recording = true;
+}
+
+void CameraPath::stopRecording()
+{
+    m_recording = false;
+}
+
+void CameraPath::record(const Camera& camera, double time)
+{
+    if (!m_recording)
+        return;
+    if (m_recordStart < 0.0)
+        m_recordStart = time;
+
+    const float t = float(time - m_recordStart);
+    if (!m_keys.empty() && t - m_keys.back().time < sampleInterval)
+        return;
+
+    Key k;
+    k.time = t;
+    k.position = camera.position();
+    k.direction = camera.direction();
+    m_keys.push_back(k);
+}
+
+void CameraPath::startPlayback(float timeStep)
+{
+    stopRecording();
+    if (m_keys.empty())
+    {
+        std::cerr << "CameraPath: nothing to play\n";
+        return;
+    }
+    m_timeStep = timeStep;
+    m_playTime = 0.0f;
+    m_playing = true;
+}
+
+void CameraPath::stopPlayback()
+{
+    m_playing = false;
+}
+
+bool CameraPath::step(Camera& camera)
+{
+    if (!m_playing)
+        return false;
+
+    const Key k = evaluate(m_playTime);
+    camera.setPosition(k.position);
+    camera.setDirection(k.direction);
+
+    m_playTime += m_timeStep;
+    if (m_playTime > duration())
+        m_playing = false;
+    return m_playing;
+}
+
+CameraPath::Key CameraPath::evaluate(float time) const
+{
+    if (m_keys.empty())
+        return Key();
+    if (m_keys.size() == 1 || time <= 0.0f)
+        return m_keys.front();
+    if (time >= duration())
+        return m_keys.back();
+
+    // Segment [i, i + 1] containing the time
+    auto it = std::upper_bound(m_keys.begin(), m_keys.end(), time,
+        [](float t, const Key& k) { return t < k.time; });
+    const std::size_t i2 = std::size_t(it - m_keys.begin());
+    const std::size_t i1 = i2 - 1;
+    const std::size_t i0 = i1 > 0 ? i1 - 1 : i1;
+    const std::size_t i3 = std::min(i2 + 1, m_keys.size() - 1);
+    const float u = (time - m_keys[i1].time) / std::max(m_keys[i2].time - m_keys[i1].time, 1e-6f);
+
+    Key k;
+    k.time = time;
+    k.position = catmullRom(m_keys[i0].position, m_keys[i1].position, m_keys[i2].position, m_keys[i3].position, u);
+    k.direction = catmullRom(m_keys[i0].direction, m_keys[i1].direction, m_keys[i2].direction, m_keys[i3].direction, u);
+    const float length = glm::length(k.direction);
+    k.direction = length > 1e-6f ? k.direction / length : m_keys[i1].direction;
+    return k;
+}
+
+bool CameraPath::save(const std::string& path) const
+{
+    std::ofstream file(path, std::ios::binary);
+    if (!file.is_open())
+    {
+        std::cerr << "Impossible to write: " << path << std::endl;
+        return false;
+    }
+
+    // Header, then 7 floats per key (time, position, direction)
+    const uint32_t count = uint32_t(m_keys.size());
+    file.write(Magic, sizeof(Magic));
+    file.write(reinterpret_cast<const char*>(&Version), sizeof(Version));
+    file.write(reinterpret_cast<const char*>(&count), sizeof(count));
+    for (const Key& k : m_keys)
+    {
+        const float data[7] = { k.time, k.position.x, k.position.y, k.position.z,
+            k.direction.x, k.direction.y, k.direction.z };
+        file.write(reinterpret_cast<const char*>(data), sizeof(data));
+    }
+    std::cout << "Camera path saved: " << path << " (" << count << " keys)\n";
+    return true;
+}
+
+bool CameraPath::load(const std::string& path)
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open())
+    {
+        std::cerr << "Impossible to open: " << path << std::endl;
+        return false;
+    }
+
+    char magic[4];
+    uint32_t version = 0, count = 0;
+    file.read(magic, sizeof(magic));
+    file.read(reinterpret_cast<char*>(&version), sizeof(version));
+    file.read(reinterpret_cast<char*>(&count), sizeof(count));
+    if (!file || std::memcmp(magic, Magic, sizeof(Magic)) != 0 || version != Version)
+    {
+        std::cerr << "Invalid camera path file: " << path << std::endl;
+        return false;
+    }
+
+    // The count comes from the file: check it against the size of the data
+    // before allocating (corrupted or foreign file)
+    const std::streamoff header = file.tellg();
+    file.seekg(0, std::ios::end);
+    const std::streamoff remaining = file.tellg() - header;
+    file.seekg(header);
+    const std::streamoff keySize = 7 * sizeof(float);
+    if (!file || remaining < 0 || std::streamoff(count) > remaining / keySize)
+    {
+        std::cerr << "Truncated camera path file: " << path << " (" << count << " keys announced)" << std::endl;
+        return false;
+    }
+
+    std::vector<Key> keys(count);
+    for (Key& k : keys)
+    {
+        float data[7];
+        file.read(reinterpret_cast<char*>(data), sizeof(data));
+        k.time = data[0];
+        k.position = glm::vec3(data[1], data[2], data[3]);
+        k.direction = glm::vec3(data[4], data[5], data[6]);
+    }
+    if (!file)
+    {
+        std::cerr << "Truncated camera path file: " << path << std::endl;
+        return false;
+    }
+
+    stopRecording();
+    stopPlayback();
+    m_keys = keys;
+    return true;
+}
+
+void CameraPath::drawImgui(const std::string& path)
+{
+    ImGui::Begin("Camera path");
+    ImGui::Text("%d keys, %.2f s", int(m_keys.size()), duration());
+    if (!m_recording)
+    {
+        if (ImGui::Button("Record"))
+            startRecording();
+    }
+    else if (ImGui::Button("Stop recording"))
+    {
+        stopRecording();
+    }
+    ImGui::SameLine();
+    if (!m_playing)
+    {
+        if (ImGui::Button("Play"))
+            startPlayback(m_timeStep);
+    }
+    else if (ImGui::Button("Stop playback"))
+    {
+        stopPlayback();
+    }
+    if (m_playing)
+        ImGui::ProgressBar(duration() > 0.0f ? m_playTime / duration() : 0.0f);
+    ImGui::InputFloat("Time step", &m_timeStep, 0.001f, 0.01f, "%.4f");
+    m_timeStep = std::max(m_timeStep, 1e-4f);
+
+    if (ImGui::Button("Save"))
+        save(path);
+    ImGui::SameLine();
+    if (ImGui::Button("Load"))
+        load(path);
+    ImGui::End();
+}
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <string>
+#include <vector>
+
+class Camera;
+
+// Camera path used to make reproducible performance measurements
+// - Recording: the camera poses (position, direction) are captured with
+//   their timestamps while the user moves the camera
+// - Playback: the camera follows a Catmull-Rom spline through the recorded
+//   poses, the time is advanced by a fixed step at each frame
+//   (independent of the real frame time)
+// The path can be saved in a compact binary file.
+//
+// Usage:
+//   // Each frame
+//   if (m_cameraPath.isPlaying())
+//      m_cameraPath.step(m_camera);
+//   else
+//      m_camera.keybordEvents(m_window, delta_time);
+//   m_cameraPath.record(m_camera, glfwGetTime());
+class CameraPath
+{
+public:
+    // Recorded pose
+    struct Key
+    {
+        float time = 0.0f; // In seconds, from the first key
+        glm::vec3 position = glm::vec3(0.0f);
+        glm::vec3 direction = glm::vec3(0.0f, 0.0f, -1.0f);
+    };
+
+public:
+    // ------------------------------------------------------------------------
+    // recording (the previous keys are discarded)
+    void startRecording();
+    void stopRecording();
+    bool isRecording() const { return m_recording; }
+    // add the current pose (only if recording)
+    // time: real time in seconds (glfwGetTime)
+    void record(const Camera& camera, double time);
+
+    // ------------------------------------------------------------------------
+    // playback with a fixed simulated time step (in seconds)
+    void startPlayback(float timeStep = 1.0f / 60.0f);
+    void stopPlayback();
+    bool isPlaying() const { return m_playing; }
+    // advance the simulated time by one step and move the camera
+    // return false when the end of the path is reached (the playback stops)
+    bool step(Camera& camera);
+    float timeStep() const { return m_timeStep; }
+
+    // ------------------------------------------------------------------------
+    // pose on the spline at a given time (clamped to the path duration)
+    Key evaluate(float time) const;
+    float duration() const { return m_keys.empty() ? 0.0f : m_keys.back().time; }
+    const std::vector<Key>& keys() const { return m_keys; }
+
+    // ------------------------------------------------------------------------
+    // binary file (little endian)
+    // return true if sucessfull
+    bool save(const std::string& path) const;
+    bool load(const std::string& path);
+
+    // ------------------------------------------------------------------------
+    // record/play/save/load buttons inside an ImGui window
+    void drawImgui(const std::string& path = "camera_path.bin");
+
+    // Minimum time between two recorded keys (seconds)
+    float sampleInterval = 1.0f / 30.0f;
+
+private:
+    std::vector<Key> m_keys;
+
+    bool m_recording = false;
+    double m_recordStart = -1.0;
+
+    bool m_playing = false;
+    float m_timeStep = 1.0f / 60.0f;
+    float m_playTime = 0.0f;
+};
@@ -0,0 +1,39 @@
+#include "CameraUBO.h"
+#include "Camera.h"
+
+#include <cstring>
+
+void CameraUBO::update(const Camera& camera)
+{
+    if (m_buffer == 0)
+    {
+        glCreateBuffers(1, &m_buffer);
+        glNamedBufferStorage(m_buffer, sizeof(Block), nullptr, GL_DYNAMIC_STORAGE_BIT);
+        m_version = 0;
+    }
+
+    if (m_version != camera.version())
+    {
+        Block block;
+        block.view = camera.viewMatrix();
+        block.projection = camera.projectionMatrix();
+        block.viewProjection = camera.viewProjectionMatrix();
+        block.invView = camera.inverseViewMatrix();
+        block.invProjection = camera.inverseProjectionMatrix();
+        block.position = glm::vec4(camera.position(), 1.0f);
+        block.clip = glm::vec4(camera.nearPlane(), camera.farPlane(), 0.0f, 0.0f);
+        std::memcpy(block.frustumPlanes, camera.frustumPlanes(), sizeof(block.frustumPlanes));
+        glNamedBufferSubData(m_buffer, 0, sizeof(Block), &block);
+        m_version = camera.version();
+    }
+
+    glBindBufferBase(GL_UNIFORM_BUFFER, Binding, m_buffer);
+}
+
+void CameraUBO::release()
+{
+    if (m_buffer != 0)
+        glDeleteBuffers(1, &m_buffer);
+    m_buffer = 0;
+    m_version = 0;
+}
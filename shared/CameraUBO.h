@@ -0,0 +1,53 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <cstdint>
+
+class Camera;
+
+// Uniform buffer shared by all the programs with the camera data
+// (GLSL declaration: shared/shaders/camera.glsl, #include "camera.glsl")
+// The buffer is only uploaded when the camera changed (Camera::version)
+// and is bound once per frame, the programs do not need to upload
+// the view/projection matrices anymore.
+//
+// Usage:
+//   m_cameraUBO.update(m_camera); // Beginning of each frame
+//   ...
+//   m_cameraUBO.release(); // Cleanup
+class CameraUBO
+{
+public:
+    // Binding point of the block (see camera.glsl)
+    static const GLuint Binding = 0;
+
+    // Block layout (std140, every member is 16 bytes aligned)
+    struct Block
+    {
+        glm::mat4 view;
+        glm::mat4 projection;
+        glm::mat4 viewProjection;
+        glm::mat4 invView;
+        glm::mat4 invProjection;
+        glm::vec4 position;         // xyz: camera position (world)
+        glm::vec4 clip;             // x: near, y: far
+        glm::vec4 frustumPlanes[6]; // see Camera::frustumPlanes
+    };
+
+public:
+    // ------------------------------------------------------------------------
+    // upload the camera data if needed and bind the buffer
+    void update(const Camera& camera);
+
+    // ------------------------------------------------------------------------
+    // destroy the buffer (the OpenGL context needs to be current)
+    void release();
+
+    GLuint buffer() const { return m_buffer; }
+
+private:
+    GLuint m_buffer = 0;
+    uint64_t m_version = 0; // Camera version inside the buffer
+};
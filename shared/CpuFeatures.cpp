@@ -0,0 +1,55 @@
+#include "CpuFeatures.h"
+
+namespace
+{
+#ifdef SIMD_AVX2
+    bool hasAVX2()
+    {
+#if defined(_MSC_VER)
+        int info[4];
+        __cpuid(info, 0);
+        if (info[0] < 7)
+            return false;
+        __cpuid(info, 1);
+        const bool osxsave = (info[2] & (1 << 27)) != 0;
+        if (!osxsave || (_xgetbv(0) & 6) != 6) // YMM registers saved by the OS
+            return false;
+        __cpuidex(info, 7, 0);
+        return (info[1] & (1 << 5)) != 0;
+#else
+        __builtin_cpu_init(); // Needed before main (static initialization)
+        return __builtin_cpu_supports("avx2");
+#endif
+    }
+#endif
+
+    CpuFeatures::Level detectLevel()
+    {
+#ifdef SIMD_AVX2
+        if (hasAVX2())
+            return CpuFeatures::Level::AVX2;
+#endif
+#ifdef SIMD_SSE2
+        return CpuFeatures::Level::SSE2;
+#else
+        return CpuFeatures::Level::Scalar;
+#endif
+    }
+}
+
+// ----------------------------------------------------------------------------
+CpuFeatures::Level CpuFeatures::level()
+{
+    static const Level detected = detectLevel();
+    return detected;
+}
+
+const char* CpuFeatures::name(Level level)
+{
+    switch (level)
+    {
+    case Level::AVX2: return "AVX2";
+    case Level::SSE2: return "SSE2";
+    default: return "Scalar";
+    }
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+// SIMD instruction sets available for the CPU code (x86 only, the other
+// architectures use the scalar paths)
+// SIMD_SSE2: SSE2 is always supported by the target (x86-64)
+// SIMD_AVX2: AVX2 functions can be compiled (SIMD_AVX2_TARGET), they must
+//            only be called when CpuFeatures::level() is Level::AVX2
+//
+// Usage:
+//   #ifdef SIMD_AVX2
+//   SIMD_AVX2_TARGET void stepAVX2(...) { ... }
+//   #endif
+//   ...
+//   switch (CpuFeatures::level())
+//   {
+//   #ifdef SIMD_AVX2
+//   case CpuFeatures::Level::AVX2: stepAVX2(...); break;
+//   #endif
+//   ...
+//   }
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#include <immintrin.h>
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define SIMD_SSE2 1
+#endif
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define SIMD_AVX2 1
+#define SIMD_AVX2_TARGET
+#elif defined(__GNUC__)
+#define SIMD_AVX2 1
+#define SIMD_AVX2_TARGET __attribute__((target("avx2")))
+#endif
+#endif
+
+namespace CpuFeatures
+{
+    enum class Level { Scalar, SSE2, AVX2 };
+
+    // ------------------------------------------------------------------------
+    // best instruction set compiled and supported by the CPU (detected once,
+    // can be called during the static initialization)
+    Level level();
+
+    // ------------------------------------------------------------------------
+    // "AVX2", "SSE2" or "Scalar"
+    const char* name(Level level);
+}
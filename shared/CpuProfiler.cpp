@@ -0,0 +1,194 @@
+#include "CpuProfiler.h"
+
+#include <imgui.h>
+
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    struct Event
+    {
+        const char* name;
+        uint64_t begin;
+        uint64_t end;
+    };
+
+    // Ring buffer owned by a single thread (single producer).
+    // The reader only needs to load the head to know which events are valid.
+    struct ThreadBuffer
+    {
+        ThreadBuffer(uint32_t id) : id(id), events(CpuProfiler::BufferCapacity) {}
+
+        uint32_t id;
+        std::string name;
+        std::vector<Event> events;
+        std::atomic<uint64_t> head{ 0 };
+    };
+
+    std::atomic<bool> g_enabled{ true };
+    // Time origin of the trace
+    const uint64_t g_start = CpuProfiler::now();
+    // Zones older than this time are ignored (see clear())
+    std::atomic<uint64_t> g_clearTime{ 0 };
+    // Static initialization is done by the main thread
+    const std::thread::id g_mainThread = std::this_thread::get_id();
+
+    // All the buffers (the mutex is only used to register a new thread and to flush)
+    std::mutex g_mutex;
+    std::vector<std::unique_ptr<ThreadBuffer>> g_buffers;
+    // Buffers of the threads that have exited, reused by the next new threads
+    // (a restarted worker does not allocate a new buffer)
+    std::vector<ThreadBuffer*> g_freeBuffers;
+
+    // Gives the buffer back to the free list when its thread exits.
+    // Its zones are kept: the next owner continues the same ring buffer
+    // (the threads do not overlap in time, so they can share the trace row)
+    struct BufferOwner
+    {
+        ThreadBuffer* buffer = nullptr;
+
+        ~BufferOwner()
+        {
+            if (buffer)
+            {
+                std::lock_guard<std::mutex> lock(g_mutex);
+                g_freeBuffers.push_back(buffer);
+            }
+        }
+    };
+
+    ThreadBuffer* threadBuffer()
+    {
+        thread_local BufferOwner owner;
+        if (!owner.buffer)
+        {
+            std::lock_guard<std::mutex> lock(g_mutex);
+            if (!g_freeBuffers.empty())
+            {
+                owner.buffer = g_freeBuffers.back();
+                g_freeBuffers.pop_back();
+            }
+            else
+            {
+                g_buffers.push_back(std::make_unique<ThreadBuffer>(uint32_t(g_buffers.size())));
+                owner.buffer = g_buffers.back().get();
+            }
+            owner.buffer->name = std::this_thread::get_id() == g_mainThread ? "Main thread" : "Thread " + std::to_string(owner.buffer->id);
+        }
+        return owner.buffer;
+    }
+
+    void writeEscaped(std::ostream& out, const std::string& s)
+    {
+        for (char c : s)
+        {
+            if (c == '"' || c == '\\')
+                out << '\\';
+            out << c;
+        }
+    }
+}
+
+void CpuProfiler::record(const char* name, uint64_t begin, uint64_t end)
+{
+    ThreadBuffer* buffer = threadBuffer();
+    const uint64_t h = buffer->head.load(std::memory_order_relaxed);
+    buffer->events[h % BufferCapacity] = { name, begin, end };
+    buffer->head.store(h + 1, std::memory_order_release);
+}
+
+void CpuProfiler::setThreadName(const std::string& name)
+{
+    ThreadBuffer* buffer = threadBuffer();
+    std::lock_guard<std::mutex> lock(g_mutex);
+    buffer->name = name;
+}
+
+void CpuProfiler::setEnabled(bool enabled)
+{
+    g_enabled.store(enabled, std::memory_order_relaxed);
+}
+
+bool CpuProfiler::isEnabled()
+{
+    return g_enabled.load(std::memory_order_relaxed);
+}
+
+bool CpuProfiler::writeChromeTrace(const std::string& path)
+{
+    std::ofstream file(path);
+    if (!file.is_open())
+    {
+        std::cerr << "Impossible to write: " << path << std::endl;
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(g_mutex);
+    file << "{\"traceEvents\":[\n";
+    bool first = true;
+    std::size_t count = 0;
+    for (const std::unique_ptr<ThreadBuffer>& buffer : g_buffers)
+    {
+        // Thread name (metadata)
+        file << (first ? "" : ",\n") << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":" << buffer->id << ",\"args\":{\"name\":\"";
+        writeEscaped(file, buffer->name);
+        file << "\"}}";
+        first = false;
+
+        // Copy the events, then discard the ones that the owner thread
+        // may have overwritten during the copy
+        const uint64_t head = buffer->head.load(std::memory_order_acquire);
+        uint64_t start = head > BufferCapacity ? head - BufferCapacity : 0;
+        std::vector<Event> events;
+        events.reserve(std::size_t(head - start));
+        for (uint64_t i = start; i < head; ++i)
+            events.push_back(buffer->events[i % BufferCapacity]);
+        const uint64_t headAfter = buffer->head.load(std::memory_order_acquire);
+        const uint64_t overwritten = headAfter > BufferCapacity ? headAfter - BufferCapacity : 0;
+        const std::size_t skip = std::size_t(std::min(head - start, overwritten > start ? overwritten - start : 0));
+
+        const uint64_t clearTime = g_clearTime.load();
+        for (std::size_t i = skip; i < events.size(); ++i)
+        {
+            const Event& e = events[i];
+            if (e.begin < g_start || e.begin < clearTime)
+                continue;
+            file << ",\n{\"name\":\"";
+            writeEscaped(file, e.name);
+            file << "\",\"ph\":\"X\",\"pid\":0,\"tid\":" << buffer->id
+                << ",\"ts\":" << double(e.begin - g_start) * 1e-3
+                << ",\"dur\":" << double(e.end - e.begin) * 1e-3 << "}";
+            count++;
+        }
+    }
+    file << "\n]}\n";
+    std::cout << "CPU trace exported: " << path << " (" << count << " zones)\n";
+    return true;
+}
+
+void CpuProfiler::clear()
+{
+    // The buffers belong to their threads, only ignore the previous zones
+    g_clearTime.store(now());
+}
+
+void CpuProfiler::drawImgui()
+{
+    ImGui::Begin("CPU profiler");
+    bool enabled = isEnabled();
+    if (ImGui::Checkbox("Record", &enabled))
+        setEnabled(enabled);
+    if (ImGui::Button("Save trace"))
+        writeChromeTrace("cpu_trace.json");
+    ImGui::SameLine();
+    if (ImGui::Button("Clear"))
+        clear();
+    ImGui::End();
+}
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+// Low overhead CPU profiler
+// Each thread records its zones inside its own ring buffer (no lock), given
+// back to a free list when the thread exits and reused by the next thread.
+// The zones can be saved on demand as a Chrome trace file
+// (open it with chrome://tracing or https://ui.perfetto.dev).
+//
+// Usage:
+//   void MainWindow::RenderScene() {
+//       PROFILE_SCOPE("RenderScene");
+//       ...
+//   }
+//   CpuProfiler::writeChromeTrace("cpu_trace.json");
+//
+// Note: the zone names need to be string literals (only the pointer is stored).
+// Define PROFILER_DISABLED to remove all the instrumentation at compile time.
+namespace CpuProfiler
+{
+    // Number of zones kept per thread (the oldest are overwritten)
+    const std::size_t BufferCapacity = 1 << 16;
+
+    // ------------------------------------------------------------------------
+    // current time in nanoseconds (steady clock)
+    inline uint64_t now()
+    {
+        return uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count());
+    }
+
+    // ------------------------------------------------------------------------
+    // record a zone for the current thread
+    void record(const char* name, uint64_t begin, uint64_t end);
+
+    // ------------------------------------------------------------------------
+    // name of the current thread (shown in the trace)
+    void setThreadName(const std::string& name);
+
+    // ------------------------------------------------------------------------
+    // enable/disable the recording (enabled by default)
+    void setEnabled(bool enabled);
+    bool isEnabled();
+
+    // ------------------------------------------------------------------------
+    // write the recorded zones of all the threads in the Chrome trace_event format
+    // return true if sucessfull
+    bool writeChromeTrace(const std::string& path);
+
+    // ------------------------------------------------------------------------
+    // forget all the recorded zones
+    void clear();
+
+    // ------------------------------------------------------------------------
+    // small ImGui window (enable + save trace)
+    void drawImgui();
+}
+
+// Scoped CPU zone (RAII)
+class ProfileScope
+{
+public:
+    explicit ProfileScope(const char* name) : m_name(name) {
+        m_begin = CpuProfiler::isEnabled() ? CpuProfiler::now() : 0;
+    }
+    ~ProfileScope() {
+        if (m_begin != 0)
+            CpuProfiler::record(m_name, m_begin, CpuProfiler::now());
+    }
+    ProfileScope(const ProfileScope&) = delete;
+    ProfileScope& operator=(const ProfileScope&) = delete;
+
+private:
+    const char* m_name;
+    uint64_t m_begin;
+};
+
+#define PROFILE_CONCAT_IMPL(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_IMPL(a, b)
+#ifndef PROFILER_DISABLED
+#define PROFILE_SCOPE(name) ProfileScope PROFILE_CONCAT(profileScope_, __LINE__)(name)
+#else
+#define PROFILE_SCOPE(name)
+#endif
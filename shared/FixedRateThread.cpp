@@ -0,0 +1,58 @@
+#include "FixedRateThread.h"
+#include "CpuProfiler.h"
+
+#include <chrono>
+
+void FixedRateThread::start(const std::string& name, double rate, std::function<void(double)> step)
+{
+    stop();
+    m_rate = rate > 0.0 ? rate : 60.0;
+    m_stop.store(false);
+    m_droppedSteps.store(0);
+    m_thread = std::thread(&FixedRateThread::run, this, name, std::move(step));
+}
+
+void FixedRateThread::stop()
+{
+    if (!m_thread.joinable())
+        return;
+    m_stop.store(true);
+    m_thread.join();
+}
+
+void FixedRateThread::run(std::string name, std::function<void(double)> step)
+{
+    typedef std::chrono::steady_clock Clock;
+    CpuProfiler::setThreadName(name);
+
+    const double dt = 1.0 / m_rate;
+    const Clock::duration period = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(dt));
+    Clock::time_point next = Clock::now();
+    Clock::time_point measureBegin = next;
+    int measuredSteps = 0;
+    while (!m_stop.load(std::memory_order_relaxed))
+    {
+        step(dt);
+        measuredSteps++;
+
+        // Next deadline (no drift), drop the steps if too late
+        next += period;
+        const Clock::time_point now = Clock::now();
+        if (now > next + maxLateSteps * period)
+        {
+            const uint64_t late = uint64_t((now - next) / period);
+            m_droppedSteps.fetch_add(late, std::memory_order_relaxed);
+            next += late * period;
+        }
+        if (next > now)
+            std::this_thread::sleep_until(next);
+
+        const double elapsed = std::chrono::duration<double>(Clock::now() - measureBegin).count();
+        if (elapsed >= 0.5)
+        {
+            m_measuredRate.store(measuredSteps / elapsed, std::memory_order_relaxed);
+            measureBegin = Clock::now();
+            measuredSteps = 0;
+        }
+    }
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <thread>
+
+// Thread calling a function at a fixed rate (ex: simulation step)
+// If a step takes longer than the period, the next steps are called without
+// waiting until the thread catches up (at most maxLateSteps, then the
+// late steps are dropped). The state is given to the render thread with a
+// TripleBuffer (see TripleBuffer.h).
+//
+// Usage:
+//   m_simulation.start("Simulation", 120.0, [this](double dt) { step(dt); });
+//   ...
+//   m_simulation.stop(); // Before changing the data used by step
+class FixedRateThread
+{
+public:
+    ~FixedRateThread() { stop(); }
+
+    // ------------------------------------------------------------------------
+    // start the thread (the name is shown by the CPU profiler)
+    // step is called with the fixed time step (1 / rate) in seconds
+    void start(const std::string& name, double rate, std::function<void(double)> step);
+
+    // ------------------------------------------------------------------------
+    // stop the thread and wait the end of the current step
+    void stop();
+
+    bool isRunning() const { return m_thread.joinable(); }
+    double rate() const { return m_rate; }
+
+    // ------------------------------------------------------------------------
+    // steps really executed per second (measured)
+    double measuredRate() const { return m_measuredRate.load(std::memory_order_relaxed); }
+    // steps dropped because the thread was too late
+    uint64_t droppedSteps() const { return m_droppedSteps.load(std::memory_order_relaxed); }
+
+    int maxLateSteps = 4;
+
+private:
+    void run(std::string name, std::function<void(double)> step);
+
+private:
+    std::thread m_thread;
+    std::atomic<bool> m_stop{ false };
+    double m_rate = 60.0;
+    std::atomic<double> m_measuredRate{ 0.0 };
+    std::atomic<uint64_t> m_droppedSteps{ 0 };
+};
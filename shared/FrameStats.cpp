@@ -0,0 +1,358 @@
+#include "FrameStats.h"
+
+#include <GLFW/glfw3.h>
+#include <imgui.h>
+
+#include <algorithm>
+#include <cmath>
+#include <thread>
+
+namespace
+{
+    // Histogram layout: values (in us) below 128 have their own bucket,
+    // then each power of two is split in 64 buckets (relative error < 1/64)
+    const uint64_t LinearBuckets = 128;
+    const uint64_t SubBuckets = 64;
+    const int MaxExponent = 32; // ~ 2^38 us, much more than any frame
+    const std::size_t BucketCount = LinearBuckets + SubBuckets * MaxExponent;
+
+    std::size_t bucketIndex(uint64_t us)
+    {
+        if (us < LinearBuckets)
+            return std::size_t(us);
+        int e = 1;
+        while ((us >> e) >= LinearBuckets && e < MaxExponent)
+            e++;
+        const uint64_t sub = std::min<uint64_t>(us >> e, LinearBuckets - 1) - SubBuckets;
+        return std::size_t(LinearBuckets + (e - 1) * SubBuckets + sub);
+    }
+
+    // Middle of the values stored in the bucket (in us)
+    double bucketValue(std::size_t index)
+    {
+        if (index < LinearBuckets)
+            return double(index);
+        const uint64_t e = (index - LinearBuckets) / SubBuckets + 1;
+        const uint64_t sub = (index - LinearBuckets) % SubBuckets + SubBuckets;
+        const uint64_t lower = sub << e;
+        const uint64_t upper = ((sub + 1) << e) - 1;
+        return 0.5 * double(lower + upper);
+    }
+
+    double toMs(std::chrono::steady_clock::duration d)
+    {
+        return std::chrono::duration<double, std::milli>(d).count();
+    }
+}
+
+// ----------------------------------------------------------------------------
+FrameStats::Histogram::Histogram()
+    : m_buckets(BucketCount, 0)
+{
+}
+
+void FrameStats::Histogram::record(double ms)
+{
+    const uint64_t us = uint64_t(std::max(0.0, ms) * 1000.0 + 0.5);
+    m_buckets[bucketIndex(us)]++;
+    m_count++;
+    m_sum += ms;
+    m_max = std::max(m_max, ms);
+}
+
+void FrameStats::Histogram::reset()
+{
+    std::fill(m_buckets.begin(), m_buckets.end(), 0);
+    m_count = 0;
+    m_sum = 0.0;
+    m_max = 0.0;
+}
+
+double FrameStats::Histogram::percentile(double p) const
+{
+    if (m_count == 0)
+        return 0.0;
+    // Rank of the value (1 based)
+    const uint64_t rank = std::max<uint64_t>(1, uint64_t(std::ceil(p / 100.0 * double(m_count))));
+    uint64_t seen = 0;
+    for (std::size_t i = 0; i < m_buckets.size(); ++i)
+    {
+        seen += m_buckets[i];
+        if (seen >= rank)
+            return std::min(bucketValue(i) * 1e-3, m_max);
+    }
+    return m_max;
+}
+
+// ----------------------------------------------------------------------------
+FrameStats::FrameStats(std::size_t historySize)
+    : m_history(std::max<std::size_t>(historySize, 2))
+{
+}
+
+void FrameStats::beginFrame()
+{
+    const Clock::time_point now = Clock::now();
+    if (m_started && !m_pause)
+    {
+        Frame& f = m_current;
+        f.frameMs = float(toMs(now - m_frameBegin));
+        f.cpuMs = std::max(0.0f, f.frameMs - f.limiterMs - f.swapMs);
+
+        // Hitch: compared to the median of the previous frames
+        // (the first frames are only used to build the median)
+        if (m_frameHistogram.count() >= 30)
+            f.hitch = f.frameMs > hitchFactor * m_frameHistogram.percentile(50.0);
+
+        m_frameHistogram.record(f.frameMs);
+        m_cpuHistogram.record(f.cpuMs);
+        m_swapHistogram.record(f.swapMs);
+        if (f.gpuMs > 0.0f)
+            m_gpuHistogram.record(f.gpuMs);
+
+        m_history[m_head] = f;
+        m_head = (m_head + 1) % m_history.size();
+        m_size = std::min(m_size + 1, m_history.size());
+    }
+
+    const uint64_t index = m_current.index + 1;
+    m_current = Frame();
+    m_current.index = index;
+    m_frameBegin = now;
+    m_started = true;
+}
+
+void FrameStats::annotate(const std::string& event)
+{
+    if (!m_current.events.empty())
+        m_current.events += ", ";
+    m_current.events += event;
+}
+
+void FrameStats::setGpuTime(double ms)
+{
+    m_current.gpuMs = float(ms);
+}
+
+void FrameStats::sleepUntil(Clock::time_point deadline)
+{
+    // Sleep by steps of 1 ms while the (pessimistic) estimation of the sleep
+    // duration fits before the deadline, then spin: the OS scheduler can wake
+    // up the thread several ms late, the spin gives a sub-ms precision
+    for (;;)
+    {
+        const double remaining = std::chrono::duration<double>(deadline - Clock::now()).count();
+        const double stddev = std::sqrt(m_sleepM2 / double(m_sleepCount));
+        if (remaining <= m_sleepMean + stddev)
+            break;
+
+        const Clock::time_point start = Clock::now();
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        const double observed = std::chrono::duration<double>(Clock::now() - start).count();
+
+        // Welford online mean/variance (reset from time to time to follow the system load)
+        if (m_sleepCount > 1000)
+        {
+            m_sleepCount = 1;
+            m_sleepM2 = 0.0;
+        }
+        m_sleepCount++;
+        const double delta = observed - m_sleepMean;
+        m_sleepMean += delta / double(m_sleepCount);
+        m_sleepM2 += delta * (observed - m_sleepMean);
+    }
+    while (Clock::now() < deadline)
+    {
+        // Spin
+    }
+}
+
+void FrameStats::waitFrameLimit()
+{
+    if (!limiterEnabled || targetFps <= 0.0f)
+        return;
+    const Clock::time_point start = Clock::now();
+    const Clock::duration period = std::chrono::duration_cast<Clock::duration>(
+        std::chrono::duration<double>(1.0 / double(targetFps)));
+
+    // The deadlines follow each other (no drift), unless the frame was
+    // already late: in this case restart from now
+    m_deadline += period;
+    if (m_deadline < start || m_deadline > start + 2 * period)
+        m_deadline = start;
+    else
+        sleepUntil(m_deadline);
+
+    m_current.limiterMs = float(toMs(Clock::now() - start));
+}
+
+void FrameStats::beginSwap()
+{
+    m_swapBegin = Clock::now();
+}
+
+void FrameStats::endSwap()
+{
+    m_current.swapMs = float(toMs(Clock::now() - m_swapBegin));
+}
+
+void FrameStats::reset()
+{
+    m_frameHistogram.reset();
+    m_cpuHistogram.reset();
+    m_gpuHistogram.reset();
+    m_swapHistogram.reset();
+    m_size = 0;
+    m_head = 0;
+}
+
+void FrameStats::drawImgui()
+{
+    ImGui::Begin("Frame statistics");
+
+    // Percentiles since the last reset
+    ImGui::Text("%llu frames", (unsigned long long)m_frameHistogram.count());
+    ImGui::SameLine();
+    if (ImGui::Button("Reset"))
+        reset();
+    ImGui::SameLine();
+    ImGui::Checkbox("Pause", &m_pause);
+
+    ImGui::Columns(7);
+    const char* headers[] = { "ms", "mean", "p50", "p90", "p99", "p99.9", "max" };
+    for (const char* h : headers)
+    {
+        ImGui::Text("%s", h);
+        ImGui::NextColumn();
+    }
+    ImGui::Separator();
+    const std::pair<const char*, const Histogram*> rows[] = {
+        { "Frame", &m_frameHistogram }, { "CPU", &m_cpuHistogram },
+        { "GPU", &m_gpuHistogram }, { "Swap", &m_swapHistogram } };
+    for (const auto& row : rows)
+    {
+        const Histogram& h = *row.second;
+        ImGui::Text("%s", row.first); ImGui::NextColumn();
+        ImGui::Text("%.2f", h.mean()); ImGui::NextColumn();
+        ImGui::Text("%.2f", h.percentile(50.0)); ImGui::NextColumn();
+        ImGui::Text("%.2f", h.percentile(90.0)); ImGui::NextColumn();
+        ImGui::Text("%.2f", h.percentile(99.0)); ImGui::NextColumn();
+        ImGui::Text("%.2f", h.percentile(99.9)); ImGui::NextColumn();
+        ImGui::Text("%.2f", h.max()); ImGui::NextColumn();
+    }
+    ImGui::Columns(1);
+
+    // Graph of the last frames: stacked bars (CPU, limiter, swap), GPU line
+    const ImU32 cpuColor = IM_COL32(80, 160, 230, 255);
+    const ImU32 limiterColor = IM_COL32(120, 120, 120, 255);
+    const ImU32 swapColor = IM_COL32(230, 200, 60, 255);
+    const ImU32 gpuColor = IM_COL32(240, 120, 40, 255);
+    const ImU32 hitchColor = IM_COL32(255, 40, 40, 255);
+
+    float scale = 1000.0f / 60.0f;
+    for (std::size_t i = 0; i < m_size; ++i)
+        scale = std::max(scale, m_history[i].frameMs);
+    scale *= 1.1f;
+
+    ImGui::Separator();
+    ImGui::TextColored(ImColor(cpuColor), "CPU");
+    ImGui::SameLine(); ImGui::TextColored(ImColor(limiterColor), "Limiter");
+    ImGui::SameLine(); ImGui::TextColored(ImColor(swapColor), "Swap");
+    ImGui::SameLine(); ImGui::TextColored(ImColor(gpuColor), "GPU");
+    ImGui::SameLine(); ImGui::TextColored(ImColor(hitchColor), "Hitch");
+    ImGui::SameLine(); ImGui::Text("(scale %.1f ms)", scale);
+
+    const ImVec2 origin = ImGui::GetCursorScreenPos();
+    const ImVec2 size(std::max(ImGui::GetContentRegionAvail().x, 100.0f), 120.0f);
+    ImGui::InvisibleButton("FrameGraph", size);
+    const bool hovered = ImGui::IsItemHovered();
+    ImDrawList* draw = ImGui::GetWindowDrawList();
+    draw->AddRectFilled(origin, ImVec2(origin.x + size.x, origin.y + size.y), IM_COL32(20, 20, 20, 255));
+
+    // Reference lines at 60 and 30 fps
+    for (float ms : { 1000.0f / 60.0f, 1000.0f / 30.0f })
+    {
+        if (ms < scale)
+        {
+            const float y = origin.y + size.y * (1.0f - ms / scale);
+            draw->AddLine(ImVec2(origin.x, y), ImVec2(origin.x + size.x, y), IM_COL32(90, 90, 90, 255));
+        }
+    }
+
+    const std::size_t capacity = m_history.size();
+    const float barWidth = size.x / float(capacity);
+    const Frame* hoveredFrame = nullptr;
+    ImVec2 lastGpu(0.0f, 0.0f);
+    for (std::size_t i = 0; i < m_size; ++i)
+    {
+        // Oldest frame first, aligned on the right of the graph
+        const Frame& f = m_history[(m_head + capacity - m_size + i) % capacity];
+        const float x0 = origin.x + (float(capacity - m_size + i)) * barWidth;
+        const float x1 = x0 + std::max(barWidth - 1.0f, 1.0f);
+        float y = origin.y + size.y;
+        auto stack = [&](float ms, ImU32 color) {
+            const float h = size.y * ms / scale;
+            draw->AddRectFilled(ImVec2(x0, y - h), ImVec2(x1, y), color);
+            y -= h;
+        };
+        stack(f.cpuMs, cpuColor);
+        stack(f.limiterMs, limiterColor);
+        stack(f.swapMs, swapColor);
+        if (f.hitch)
+        {
+            draw->AddRectFilled(ImVec2(x0, origin.y), ImVec2(x1, origin.y + 4.0f), hitchColor);
+            draw->AddLine(ImVec2(x0, origin.y + 4.0f), ImVec2(x0, y), IM_COL32(255, 40, 40, 120));
+        }
+
+        const ImVec2 gpu(0.5f * (x0 + x1), origin.y + size.y * (1.0f - std::min(f.gpuMs / scale, 1.0f)));
+        if (i > 0)
+            draw->AddLine(lastGpu, gpu, gpuColor);
+        lastGpu = gpu;
+
+        if (hovered && ImGui::GetIO().MousePos.x >= x0 && ImGui::GetIO().MousePos.x < x0 + barWidth)
+            hoveredFrame = &f;
+    }
+    if (hoveredFrame)
+    {
+        const Frame& f = *hoveredFrame;
+        ImGui::BeginTooltip();
+        ImGui::Text("Frame %llu%s", (unsigned long long)f.index, f.hitch ? " (hitch)" : "");
+        ImGui::Text("Frame %.3f ms, CPU %.3f ms, GPU %.3f ms", f.frameMs, f.cpuMs, f.gpuMs);
+        ImGui::Text("Limiter %.3f ms, swap %.3f ms", f.limiterMs, f.swapMs);
+        if (!f.events.empty())
+            ImGui::Text("Events: %s", f.events.c_str());
+        ImGui::EndTooltip();
+    }
+
+    // Last hitches with their annotations
+    if (ImGui::CollapsingHeader("Hitches"))
+    {
+        int shown = 0;
+        for (std::size_t i = 0; i < m_size && shown < 10; ++i)
+        {
+            const Frame& f = m_history[(m_head + capacity - 1 - i) % capacity];
+            if (!f.hitch)
+                continue;
+            ImGui::Text("Frame %llu: %.2f ms %s", (unsigned long long)f.index, f.frameMs,
+                f.events.empty() ? "" : f.events.c_str());
+            shown++;
+        }
+        if (shown == 0)
+            ImGui::Text("No hitch in the history");
+    }
+
+    // Pacing controls
+    if (ImGui::CollapsingHeader("Frame pacing", ImGuiTreeNodeFlags_DefaultOpen))
+    {
+        const char* intervals[] = { "0 (no vsync)", "1 (vsync)", "2 (half rate)" };
+        if (ImGui::Combo("Swap interval", &swapInterval, intervals, 3) && glfwGetCurrentContext())
+            glfwSwapInterval(swapInterval);
+        ImGui::Checkbox("Frame limiter", &limiterEnabled);
+        ImGui::SameLine();
+        ImGui::SliderFloat("Target FPS", &targetFps, 10.0f, 500.0f, "%.0f");
+        ImGui::SliderFloat("Hitch factor", &hitchFactor, 1.2f, 5.0f, "%.1f x median");
+        ImGui::Text("Sleep(1 ms) takes %.3f ms (+/- %.3f), the rest is spinned",
+            m_sleepMean * 1e3, std::sqrt(m_sleepM2 / double(m_sleepCount)) * 1e3);
+    }
+    ImGui::End();
+}
@@ -0,0 +1,142 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Frame time statistics and frame pacing
+// ImGui::GetIO().Framerate is a moving average, it hides the hitches.
+// This module keeps, for each frame, the CPU time, the GPU time, the time
+// waited by the frame limiter and the time spent inside the swap (present).
+// The percentiles are computed from log-linear histograms (HDR histogram
+// style, ~1.6% of precision) over all the frames since the last reset.
+// The graph shows the last frames, the hitches are marked and annotated
+// with the events that happened during the frame (buffer reallocation, ...).
+//
+// Usage:
+//   while (...) {
+//       m_frameStats.beginFrame(); // Closes the previous frame
+//       ...
+//       m_frameStats.annotate("initializeParticles"); // Anywhere during the frame
+//       m_frameStats.setGpuTime(gpuMs);
+//       m_frameStats.drawImgui(); // Inside the ImGui frame
+//       m_frameStats.waitFrameLimit(); // Optional frame limiter
+//       m_frameStats.beginSwap();
+//       glfwSwapBuffers(m_window);
+//       m_frameStats.endSwap();
+//       glfwPollEvents();
+//   }
+class FrameStats
+{
+public:
+    // Log-linear histogram of durations (microsecond resolution)
+    class Histogram
+    {
+    public:
+        Histogram();
+        void record(double ms);
+        void reset();
+        // p in [0, 100], return a duration in ms
+        double percentile(double p) const;
+        double max() const { return m_max; }
+        double mean() const { return m_count == 0 ? 0.0 : m_sum / double(m_count); }
+        uint64_t count() const { return m_count; }
+
+    private:
+        std::vector<uint64_t> m_buckets;
+        uint64_t m_count = 0;
+        double m_sum = 0.0;
+        double m_max = 0.0;
+    };
+
+    // One measured frame
+    struct Frame
+    {
+        uint64_t index = 0;
+        float frameMs = 0.0f; // Between two beginFrame()
+        float cpuMs = 0.0f;   // Work of the frame (without the waits)
+        float gpuMs = 0.0f;   // Last GPU time given (the GPU results are late)
+        float limiterMs = 0.0f;
+        float swapMs = 0.0f;
+        bool hitch = false;
+        std::string events;   // Annotations, separated by ", "
+    };
+
+public:
+    // ------------------------------------------------------------------------
+    // number of frames kept for the graph
+    FrameStats(std::size_t historySize = 512);
+
+    // ------------------------------------------------------------------------
+    // start a frame and record the previous one
+    void beginFrame();
+
+    // ------------------------------------------------------------------------
+    // what happened during the current frame (shown with the hitches)
+    void annotate(const std::string& event);
+
+    // ------------------------------------------------------------------------
+    // GPU time of the frame (ex: "Frame" zone of the GpuProfiler)
+    void setGpuTime(double ms);
+
+    // ------------------------------------------------------------------------
+    // frame limiter: sleep then spin until the target frame time
+    // (does nothing if the limiter is disabled)
+    void waitFrameLimit();
+
+    // ------------------------------------------------------------------------
+    // measure the swap/present wait
+    void beginSwap();
+    void endSwap();
+
+    // ------------------------------------------------------------------------
+    // forget the percentiles and the history
+    void reset();
+
+    // ------------------------------------------------------------------------
+    // show the statistics, the graph and the pacing controls in an ImGui window
+    // (a new swap interval is applied on the current GLFW context)
+    void drawImgui();
+
+    const Histogram& frameTimes() const { return m_frameHistogram; }
+    const Histogram& cpuTimes() const { return m_cpuHistogram; }
+    const Histogram& gpuTimes() const { return m_gpuHistogram; }
+    const Histogram& swapTimes() const { return m_swapHistogram; }
+
+    // Pacing settings
+    int swapInterval = 1;
+    bool limiterEnabled = false;
+    float targetFps = 60.0f;
+    // A frame is a hitch if it is longer than hitchFactor * median
+    float hitchFactor = 2.0f;
+
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    void sleepUntil(Clock::time_point deadline);
+
+private:
+    std::vector<Frame> m_history; // Ring buffer
+    std::size_t m_head = 0;       // Next frame written
+    std::size_t m_size = 0;
+    Frame m_current;
+    bool m_started = false;
+
+    Clock::time_point m_frameBegin;
+    Clock::time_point m_swapBegin;
+    Clock::time_point m_deadline;
+
+    // Estimation of the duration of sleep_for(1ms) (mean + stddev),
+    // the limiter spins the remaining time
+    double m_sleepMean = 1.0e-3;
+    double m_sleepM2 = 0.0;
+    uint64_t m_sleepCount = 1;
+
+    Histogram m_frameHistogram;
+    Histogram m_cpuHistogram;
+    Histogram m_gpuHistogram;
+    Histogram m_swapHistogram;
+
+    bool m_pause = false;
+};
@@ -0,0 +1,378 @@
+#include "FrustumCulling.h"
+#include "CpuFeatures.h"
+#include "JobSystem.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace
+{
+    using CpuFeatures::Level;
+
+    // Planes coefficients (one array per coefficient)
+    struct Planes
+    {
+        float nx[6], ny[6], nz[6], w[6];
+        float ax[6], ay[6], az[6]; // Absolute value of the normal (boxes)
+    };
+
+    Planes makePlanes(const glm::vec4 planes[6])
+    {
+        Planes p;
+        for (int k = 0; k < 6; ++k)
+        {
+            p.nx[k] = planes[k].x;
+            p.ny[k] = planes[k].y;
+            p.nz[k] = planes[k].z;
+            p.w[k] = planes[k].w;
+            p.ax[k] = std::abs(planes[k].x);
+            p.ay[k] = std::abs(planes[k].y);
+            p.az[k] = std::abs(planes[k].z);
+        }
+        return p;
+    }
+
+    // For each visibility mask: the positions of the visible lanes
+    // (packed at the beginning) and their number
+    struct CompactTable
+    {
+        CompactTable()
+        {
+            for (uint32_t mask = 0; mask < 256; ++mask)
+            {
+                uint32_t n = 0;
+                for (uint32_t lane = 0; lane < 8; ++lane)
+                {
+                    perm[mask][lane] = 0;
+                    if (mask & (1u << lane))
+                        perm[mask][n++] = lane;
+                }
+                count[mask] = n;
+            }
+        }
+        uint32_t perm[256][8];
+        uint32_t count[256];
+    };
+    const CompactTable g_compact;
+
+    // ------------------------------------------------------------------------
+    // Scalar
+    std::size_t cullSpheresScalar(const Planes& p, const FrustumCulling::Spheres& s,
+        std::size_t begin, std::size_t end, uint32_t* out)
+    {
+        std::size_t n = 0;
+        for (std::size_t i = begin; i < end; ++i)
+        {
+            bool visible = true;
+            for (int k = 0; k < 6 && visible; ++k)
+                visible = p.nx[k] * s.x[i] + p.ny[k] * s.y[i] + p.nz[k] * s.z[i] + p.w[k] >= -s.radius[i];
+            out[n] = uint32_t(i);
+            n += visible ? 1 : 0;
+        }
+        return n;
+    }
+
+    std::size_t cullBoxesScalar(const Planes& p, const FrustumCulling::Boxes& b,
+        std::size_t begin, std::size_t end, uint32_t* out)
+    {
+        std::size_t n = 0;
+        for (std::size_t i = begin; i < end; ++i)
+        {
+            // Center and half extent
+            const float cx = (b.minX[i] + b.maxX[i]) * 0.5f, ex = (b.maxX[i] - b.minX[i]) * 0.5f;
+            const float cy = (b.minY[i] + b.maxY[i]) * 0.5f, ey = (b.maxY[i] - b.minY[i]) * 0.5f;
+            const float cz = (b.minZ[i] + b.maxZ[i]) * 0.5f, ez = (b.maxZ[i] - b.minZ[i]) * 0.5f;
+            bool visible = true;
+            for (int k = 0; k < 6 && visible; ++k)
+            {
+                const float d = p.nx[k] * cx + p.ny[k] * cy + p.nz[k] * cz + p.w[k];
+                const float r = p.ax[k] * ex + p.ay[k] * ey + p.az[k] * ez;
+                visible = d >= -r;
+            }
+            out[n] = uint32_t(i);
+            n += visible ? 1 : 0;
+        }
+        return n;
+    }
+
+#ifdef SIMD_SSE2
+    // ------------------------------------------------------------------------
+    // SSE2 (4 volumes at a time)
+    inline std::size_t compact4(int mask, std::size_t i, uint32_t* out)
+    {
+        const __m128i lanes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(g_compact.perm[mask]));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out), _mm_add_epi32(lanes, _mm_set1_epi32(int(i))));
+        return g_compact.count[mask];
+    }
+
+    std::size_t cullSpheresSSE2(const Planes& p, const FrustumCulling::Spheres& s,
+        std::size_t begin, std::size_t end, uint32_t* out)
+    {
+        std::size_t n = 0, i = begin;
+        for (; i + 4 <= end; i += 4)
+        {
+            const __m128 x = _mm_loadu_ps(&s.x[i]);
+            const __m128 y = _mm_loadu_ps(&s.y[i]);
+            const __m128 z = _mm_loadu_ps(&s.z[i]);
+            const __m128 minusR = _mm_sub_ps(_mm_setzero_ps(), _mm_loadu_ps(&s.radius[i]));
+            __m128 visible = _mm_castsi128_ps(_mm_set1_epi32(-1));
+            for (int k = 0; k < 6; ++k)
+            {
+                __m128 d = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(p.nx[k]), x), _mm_set1_ps(p.w[k]));
+                d = _mm_add_ps(d, _mm_mul_ps(_mm_set1_ps(p.ny[k]), y));
+                d = _mm_add_ps(d, _mm_mul_ps(_mm_set1_ps(p.nz[k]), z));
+                visible = _mm_and_ps(visible, _mm_cmpge_ps(d, minusR));
+            }
+            n += compact4(_mm_movemask_ps(visible), i, out + n);
+        }
+        return n + cullSpheresScalar(p, s, i, end, out + n);
+    }
+
+    std::size_t cullBoxesSSE2(const Planes& p, const FrustumCulling::Boxes& b,
+        std::size_t begin, std::size_t end, uint32_t* out)
+    {
+        const __m128 half = _mm_set1_ps(0.5f);
+        std::size_t n = 0, i = begin;
+        for (; i + 4 <= end; i += 4)
+        {
+            const __m128 minX = _mm_loadu_ps(&b.minX[i]), maxX = _mm_loadu_ps(&b.maxX[i]);
+            const __m128 minY = _mm_loadu_ps(&b.minY[i]), maxY = _mm_loadu_ps(&b.maxY[i]);
+            const __m128 minZ = _mm_loadu_ps(&b.minZ[i]), maxZ = _mm_loadu_ps(&b.maxZ[i]);
+            const __m128 cx = _mm_mul_ps(_mm_add_ps(minX, maxX), half), ex = _mm_mul_ps(_mm_sub_ps(maxX, minX), half);
+            const __m128 cy = _mm_mul_ps(_mm_add_ps(minY, maxY), half), ey = _mm_mul_ps(_mm_sub_ps(maxY, minY), half);
+            const __m128 cz = _mm_mul_ps(_mm_add_ps(minZ, maxZ), half), ez = _mm_mul_ps(_mm_sub_ps(maxZ, minZ), half);
+            __m128 visible = _mm_castsi128_ps(_mm_set1_epi32(-1));
+            for (int k = 0; k < 6; ++k)
+            {
+                __m128 d = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(p.nx[k]), cx), _mm_set1_ps(p.w[k]));
+                d = _mm_add_ps(d, _mm_mul_ps(_mm_set1_ps(p.ny[k]), cy));
+                d = _mm_add_ps(d, _mm_mul_ps(_mm_set1_ps(p.nz[k]), cz));
+                __m128 r = _mm_mul_ps(_mm_set1_ps(p.ax[k]), ex);
+                r = _mm_add_ps(r, _mm_mul_ps(_mm_set1_ps(p.ay[k]), ey));
+                r = _mm_add_ps(r, _mm_mul_ps(_mm_set1_ps(p.az[k]), ez));
+                visible = _mm_and_ps(visible, _mm_cmpge_ps(_mm_add_ps(d, r), _mm_setzero_ps()));
+            }
+            n += compact4(_mm_movemask_ps(visible), i, out + n);
+        }
+        return n + cullBoxesScalar(p, b, i, end, out + n);
+    }
+#endif
+
+#ifdef SIMD_AVX2
+    // ------------------------------------------------------------------------
+    // AVX2 (8 volumes at a time)
+    SIMD_AVX2_TARGET
+    inline std::size_t compact8(int mask, std::size_t i, uint32_t* out)
+    {
+        const __m256i lanes = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(g_compact.perm[mask]));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out), _mm256_add_epi32(lanes, _mm256_set1_epi32(int(i))));
+        return g_compact.count[mask];
+    }
+
+    SIMD_AVX2_TARGET
+    std::size_t cullSpheresAVX2(const Planes& p, const FrustumCulling::Spheres& s,
+        std::size_t begin, std::size_t end, uint32_t* out)
+    {
+        __m256 nx[6], ny[6], nz[6], w[6];
+        for (int k = 0; k < 6; ++k)
+        {
+            nx[k] = _mm256_set1_ps(p.nx[k]);
+            ny[k] = _mm256_set1_ps(p.ny[k]);
+            nz[k] = _mm256_set1_ps(p.nz[k]);
+            w[k] = _mm256_set1_ps(p.w[k]);
+        }
+        std::size_t n = 0, i = begin;
+        for (; i + 8 <= end; i += 8)
+        {
+            const __m256 x = _mm256_loadu_ps(&s.x[i]);
+            const __m256 y = _mm256_loadu_ps(&s.y[i]);
+            const __m256 z = _mm256_loadu_ps(&s.z[i]);
+            const __m256 minusR = _mm256_sub_ps(_mm256_setzero_ps(), _mm256_loadu_ps(&s.radius[i]));
+            __m256 visible = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+            for (int k = 0; k < 6; ++k)
+            {
+                __m256 d = _mm256_add_ps(_mm256_mul_ps(nx[k], x), w[k]);
+                d = _mm256_add_ps(d, _mm256_mul_ps(ny[k], y));
+                d = _mm256_add_ps(d, _mm256_mul_ps(nz[k], z));
+                visible = _mm256_and_ps(visible, _mm256_cmp_ps(d, minusR, _CMP_GE_OQ));
+            }
+            n += compact8(_mm256_movemask_ps(visible), i, out + n);
+        }
+        return n + cullSpheresScalar(p, s, i, end, out + n);
+    }
+
+    SIMD_AVX2_TARGET
+    std::size_t cullBoxesAVX2(const Planes& p, const FrustumCulling::Boxes& b,
+        std::size_t begin, std::size_t end, uint32_t* out)
+    {
+        const __m256 half = _mm256_set1_ps(0.5f);
+        std::size_t n = 0, i = begin;
+        for (; i + 8 <= end; i += 8)
+        {
+            const __m256 minX = _mm256_loadu_ps(&b.minX[i]), maxX = _mm256_loadu_ps(&b.maxX[i]);
+            const __m256 minY = _mm256_loadu_ps(&b.minY[i]), maxY = _mm256_loadu_ps(&b.maxY[i]);
+            const __m256 minZ = _mm256_loadu_ps(&b.minZ[i]), maxZ = _mm256_loadu_ps(&b.maxZ[i]);
+            const __m256 cx = _mm256_mul_ps(_mm256_add_ps(minX, maxX), half), ex = _mm256_mul_ps(_mm256_sub_ps(maxX, minX), half);
+            const __m256 cy = _mm256_mul_ps(_mm256_add_ps(minY, maxY), half), ey = _mm256_mul_ps(_mm256_sub_ps(maxY, minY), half);
+            const __m256 cz = _mm256_mul_ps(_mm256_add_ps(minZ, maxZ), half), ez = _mm256_mul_ps(_mm256_sub_ps(maxZ, minZ), half);
+            __m256 visible = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+            for (int k = 0; k < 6; ++k)
+            {
+                __m256 d = _mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(p.nx[k]), cx), _mm256_set1_ps(p.w[k]));
+                d = _mm256_add_ps(d, _mm256_mul_ps(_mm256_set1_ps(p.ny[k]), cy));
+                d = _mm256_add_ps(d, _mm256_mul_ps(_mm256_set1_ps(p.nz[k]), cz));
+                __m256 r = _mm256_mul_ps(_mm256_set1_ps(p.ax[k]), ex);
+                r = _mm256_add_ps(r, _mm256_mul_ps(_mm256_set1_ps(p.ay[k]), ey));
+                r = _mm256_add_ps(r, _mm256_mul_ps(_mm256_set1_ps(p.az[k]), ez));
+                visible = _mm256_and_ps(visible, _mm256_cmp_ps(_mm256_add_ps(d, r), _mm256_setzero_ps(), _CMP_GE_OQ));
+            }
+            n += compact8(_mm256_movemask_ps(visible), i, out + n);
+        }
+        return n + cullBoxesScalar(p, b, i, end, out + n);
+    }
+#endif
+
+    // Split [0, count[ in chunks executed by the job system, each one writes
+    // its indices at the beginning of its own range, then the ranges are packed
+    template <typename Cull>
+    void cullAll(std::size_t count, std::vector<uint32_t>& visible, unsigned int threads, Cull cull)
+    {
+        visible.resize(count);
+        if (threads == 0)
+            threads = unsigned(JobSystem::instance().threadCount());
+        // Splitting is only worth it for large sets
+        const std::size_t MinPerThread = 1 << 16;
+        threads = unsigned(std::min<std::size_t>(threads, std::max<std::size_t>(1, count / MinPerThread)));
+        if (threads <= 1)
+        {
+            visible.resize(cull(0, count, visible.data()));
+            return;
+        }
+
+        // Chunks aligned on 8 volumes (SIMD width)
+        const std::size_t chunk = ((count + threads - 1) / threads + 7) & ~std::size_t(7);
+        std::vector<std::size_t> counts(threads, 0);
+        JobSystem::instance().parallelFor(0, int(threads), [&](int begin, int end) {
+            for (int t = begin; t < end; ++t)
+            {
+                const std::size_t b = std::min(count, t * chunk), e = std::min(count, b + chunk);
+                counts[t] = cull(b, e, visible.data() + b);
+            }
+        }, 1);
+
+        std::size_t n = counts[0];
+        for (unsigned int t = 1; t < threads; ++t)
+        {
+            std::memmove(visible.data() + n, visible.data() + std::min(count, t * chunk), counts[t] * sizeof(uint32_t));
+            n += counts[t];
+        }
+        visible.resize(n);
+    }
+}
+
+void FrustumCulling::Spheres::add(const glm::vec3& center, float r)
+{
+    x.push_back(center.x);
+    y.push_back(center.y);
+    z.push_back(center.z);
+    radius.push_back(r);
+}
+
+void FrustumCulling::Spheres::reserve(std::size_t n)
+{
+    x.reserve(n); y.reserve(n); z.reserve(n); radius.reserve(n);
+}
+
+void FrustumCulling::Spheres::clear()
+{
+    x.clear(); y.clear(); z.clear(); radius.clear();
+}
+
+void FrustumCulling::Boxes::add(const glm::vec3& min, const glm::vec3& max)
+{
+    minX.push_back(min.x); minY.push_back(min.y); minZ.push_back(min.z);
+    maxX.push_back(max.x); maxY.push_back(max.y); maxZ.push_back(max.z);
+}
+
+void FrustumCulling::Boxes::reserve(std::size_t n)
+{
+    minX.reserve(n); minY.reserve(n); minZ.reserve(n);
+    maxX.reserve(n); maxY.reserve(n); maxZ.reserve(n);
+}
+
+void FrustumCulling::Boxes::clear()
+{
+    minX.clear(); minY.clear(); minZ.clear();
+    maxX.clear(); maxY.clear(); maxZ.clear();
+}
+
+void FrustumCulling::extractPlanes(const glm::mat4& m, glm::vec4 planes[6])
+{
+    // Gribb and Hartmann: combinations of the rows of the matrix
+    const glm::vec4 row0(m[0][0], m[1][0], m[2][0], m[3][0]);
+    const glm::vec4 row1(m[0][1], m[1][1], m[2][1], m[3][1]);
+    const glm::vec4 row2(m[0][2], m[1][2], m[2][2], m[3][2]);
+    const glm::vec4 row3(m[0][3], m[1][3], m[2][3], m[3][3]);
+    planes[0] = row3 + row0; // Left
+    planes[1] = row3 - row0; // Right
+    planes[2] = row3 + row1; // Bottom
+    planes[3] = row3 - row1; // Top
+    planes[4] = row3 + row2; // Near
+    planes[5] = row3 - row2; // Far
+    for (int k = 0; k < 6; ++k)
+        planes[k] /= glm::length(glm::vec3(planes[k]));
+}
+
+std::size_t FrustumCulling::cullSpheres(const glm::vec4 planes[6], const Spheres& spheres,
+    std::size_t begin, std::size_t end, uint32_t* visible)
+{
+    const Planes p = makePlanes(planes);
+    switch (CpuFeatures::level())
+    {
+#ifdef SIMD_AVX2
+    case Level::AVX2: return cullSpheresAVX2(p, spheres, begin, end, visible);
+#endif
+#ifdef SIMD_SSE2
+    case Level::SSE2: return cullSpheresSSE2(p, spheres, begin, end, visible);
+#endif
+    default: return cullSpheresScalar(p, spheres, begin, end, visible);
+    }
+}
+
+std::size_t FrustumCulling::cullBoxes(const glm::vec4 planes[6], const Boxes& boxes,
+    std::size_t begin, std::size_t end, uint32_t* visible)
+{
+    const Planes p = makePlanes(planes);
+    switch (CpuFeatures::level())
+    {
+#ifdef SIMD_AVX2
+    case Level::AVX2: return cullBoxesAVX2(p, boxes, begin, end, visible);
+#endif
+#ifdef SIMD_SSE2
+    case Level::SSE2: return cullBoxesSSE2(p, boxes, begin, end, visible);
+#endif
+    default: return cullBoxesScalar(p, boxes, begin, end, visible);
+    }
+}
+
+void FrustumCulling::cullSpheres(const glm::vec4 planes[6], const Spheres& spheres,
+    std::vector<uint32_t>& visible, unsigned int threads)
+{
+    cullAll(spheres.size(), visible, threads, [&](std::size_t b, std::size_t e, uint32_t* out) {
+        return cullSpheres(planes, spheres, b, e, out);
+    });
+}
+
+void FrustumCulling::cullBoxes(const glm::vec4 planes[6], const Boxes& boxes,
+    std::vector<uint32_t>& visible, unsigned int threads)
+{
+    cullAll(boxes.size(), visible, threads, [&](std::size_t b, std::size_t e, uint32_t* out) {
+        return cullBoxes(planes, boxes, b, e, out);
+    });
+}
+
+const char* FrustumCulling::instructionSet()
+{
+    return CpuFeatures::name(CpuFeatures::level());
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Frustum culling of bounding volumes stored as structure of arrays (SoA)
+// The volumes are tested 8 at a time (AVX2) or 4 at a time (SSE2),
+// the instruction set is chosen at runtime. The result is a compacted list
+// of the indices of the visible volumes.
+//
+// Usage:
+//   FrustumCulling::Spheres spheres; // Filled once (spheres.add(...))
+//   std::vector<uint32_t> visible;
+//   FrustumCulling::cullSpheres(m_camera.frustumPlanes(), spheres, visible);
+//   for (uint32_t i : visible) ... draw object i ...
+namespace FrustumCulling
+{
+    // Bounding spheres
+    struct Spheres
+    {
+        std::vector<float> x, y, z, radius;
+
+        void add(const glm::vec3& center, float r);
+        void reserve(std::size_t n);
+        void clear();
+        std::size_t size() const { return x.size(); }
+    };
+
+    // Axis aligned bounding boxes
+    struct Boxes
+    {
+        std::vector<float> minX, minY, minZ;
+        std::vector<float> maxX, maxY, maxZ;
+
+        void add(const glm::vec3& min, const glm::vec3& max);
+        void reserve(std::size_t n);
+        void clear();
+        std::size_t size() const { return minX.size(); }
+    };
+
+    // ------------------------------------------------------------------------
+    // extract the 6 planes (left, right, bottom, top, near, far) of the frustum
+    // defined by a projection * view (* model) matrix
+    // The planes are expressed in the space before the matrix (world, object, ...)
+    // xyz: normalized normal pointing inside, w: distance
+    void extractPlanes(const glm::mat4& m, glm::vec4 planes[6]);
+
+    // ------------------------------------------------------------------------
+    // test the volumes [begin, end[ and write the indices of the visible ones
+    // inside visible (needs a capacity of end - begin)
+    // return the number of visible volumes
+    std::size_t cullSpheres(const glm::vec4 planes[6], const Spheres& spheres,
+        std::size_t begin, std::size_t end, uint32_t* visible);
+    std::size_t cullBoxes(const glm::vec4 planes[6], const Boxes& boxes,
+        std::size_t begin, std::size_t end, uint32_t* visible);
+
+    // ------------------------------------------------------------------------
+    // test all the volumes, visible is resized to the number of visible volumes
+    // Large sets are split between several threads (0 = threads of the JobSystem)
+    void cullSpheres(const glm::vec4 planes[6], const Spheres& spheres,
+        std::vector<uint32_t>& visible, unsigned int threads = 1);
+    void cullBoxes(const glm::vec4 planes[6], const Boxes& boxes,
+        std::vector<uint32_t>& visible, unsigned int threads = 1);
+
+    // ------------------------------------------------------------------------
+    // instruction set used: "AVX2", "SSE2" or "Scalar"
+    const char* instructionSet();
+}
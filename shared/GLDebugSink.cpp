@@ -0,0 +1,306 @@
+#include "GLDebugSink.h"
+#include "ShaderProgram.h"
+
+#include <imgui.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <sstream>
+
+namespace
+{
+    const char* sourceString(GLenum source)
+    {
+        switch (source)
+        {
+            case GL_DEBUG_SOURCE_API:             return "API";
+            case GL_DEBUG_SOURCE_WINDOW_SYSTEM:   return "Window System";
+            case GL_DEBUG_SOURCE_SHADER_COMPILER: return "Shader Compiler";
+            case GL_DEBUG_SOURCE_THIRD_PARTY:     return "Third Party";
+            case GL_DEBUG_SOURCE_APPLICATION:     return "Application";
+            case GL_DEBUG_SOURCE_OTHER:           return "Other";
+        }
+        return "Unknown";
+    }
+
+    const char* typeString(GLenum type)
+    {
+        switch (type)
+        {
+            case GL_DEBUG_TYPE_ERROR:               return "Error";
+            case GL_DEBUG_TYPE_DEPRECATED_BEHAVIOR: return "Deprecated Behaviour";
+            case GL_DEBUG_TYPE_UNDEFINED_BEHAVIOR:  return "Undefined Behaviour";
+            case GL_DEBUG_TYPE_PORTABILITY:         return "Portability";
+            case GL_DEBUG_TYPE_PERFORMANCE:         return "Performance";
+            case GL_DEBUG_TYPE_MARKER:              return "Marker";
+            case GL_DEBUG_TYPE_PUSH_GROUP:          return "Push Group";
+            case GL_DEBUG_TYPE_POP_GROUP:           return "Pop Group";
+            case GL_DEBUG_TYPE_OTHER:               return "Other";
+        }
+        return "Unknown";
+    }
+
+    const char* severityString(GLenum severity)
+    {
+        switch (severity)
+        {
+            case GL_DEBUG_SEVERITY_HIGH:         return "high";
+            case GL_DEBUG_SEVERITY_MEDIUM:       return "medium";
+            case GL_DEBUG_SEVERITY_LOW:          return "low";
+            case GL_DEBUG_SEVERITY_NOTIFICATION: return "notification";
+        }
+        return "unknown";
+    }
+
+    void writeMessage(std::ostream& out, const GLDebugSink::Message& m)
+    {
+        out << "---------------\n";
+        out << "Debug message (" << m.id << "): " << m.text << "\n";
+        out << "Source: " << sourceString(m.source) << "\n";
+        out << "Type: " << typeString(m.type) << "\n";
+        out << "Severity: " << severityString(m.severity) << "\n\n";
+    }
+
+    uint64_t currentSecond()
+    {
+        return uint64_t(std::chrono::duration_cast<std::chrono::seconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count());
+    }
+}
+
+GLDebugSink& GLDebugSink::instance()
+{
+    static GLDebugSink sink;
+    return sink;
+}
+
+GLDebugSink::GLDebugSink()
+    : m_cells(new Cell[QueueCapacity]),
+      m_counters(new Counter[CounterCapacity])
+{
+    for (std::size_t i = 0; i < QueueCapacity; ++i)
+        m_cells[i].sequence.store(i, std::memory_order_relaxed);
+}
+
+GLDebugSink::~GLDebugSink()
+{
+    // Messages queued after the last drain (last frame, initialization failure)
+    drain();
+}
+
+bool GLDebugSink::install(bool synchronous)
+{
+    int flags; glGetIntegerv(GL_CONTEXT_FLAGS, &flags);
+    if (!(flags & GL_CONTEXT_FLAG_DEBUG_BIT))
+        return false;
+
+    glEnable(GL_DEBUG_OUTPUT);
+    if (synchronous)
+        glEnable(GL_DEBUG_OUTPUT_SYNCHRONOUS);
+    else
+        glDisable(GL_DEBUG_OUTPUT_SYNCHRONOUS);
+    glDebugMessageCallback(glDebugOutput, nullptr);
+    glDebugMessageControl(GL_DONT_CARE, GL_DONT_CARE, GL_DONT_CARE, 0, nullptr, GL_TRUE);
+    return true;
+}
+
+GLDebugSink::Counter* GLDebugSink::counter(GLuint id)
+{
+    const uint64_t key = uint64_t(id) + 1;
+    std::size_t index = (id * 2654435761u) & (CounterCapacity - 1);
+    for (std::size_t i = 0; i < CounterCapacity; ++i)
+    {
+        Counter& c = m_counters[(index + i) & (CounterCapacity - 1)];
+        uint64_t current = c.key.load(std::memory_order_acquire);
+        if (current == key)
+            return &c;
+        if (current == 0)
+        {
+            // Try to take this empty slot
+            if (c.key.compare_exchange_strong(current, key, std::memory_order_acq_rel))
+                return &c;
+            if (current == key)
+                return &c;
+        }
+    }
+    // Table full
+    return nullptr;
+}
+
+bool GLDebugSink::enqueue(const Message& m)
+{
+    std::size_t pos = m_enqueuePos.load(std::memory_order_relaxed);
+    Cell* cell;
+    for (;;)
+    {
+        cell = &m_cells[pos & (QueueCapacity - 1)];
+        std::size_t seq = cell->sequence.load(std::memory_order_acquire);
+        std::ptrdiff_t diff = std::ptrdiff_t(seq) - std::ptrdiff_t(pos);
+        if (diff == 0)
+        {
+            if (m_enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                break;
+        }
+        else if (diff < 0)
+        {
+            // Full
+            return false;
+        }
+        else
+        {
+            pos = m_enqueuePos.load(std::memory_order_relaxed);
+        }
+    }
+    cell->message = m;
+    cell->sequence.store(pos + 1, std::memory_order_release);
+    return true;
+}
+
+bool GLDebugSink::dequeue(Message& m)
+{
+    std::size_t pos = m_dequeuePos.load(std::memory_order_relaxed);
+    Cell* cell;
+    for (;;)
+    {
+        cell = &m_cells[pos & (QueueCapacity - 1)];
+        std::size_t seq = cell->sequence.load(std::memory_order_acquire);
+        std::ptrdiff_t diff = std::ptrdiff_t(seq) - std::ptrdiff_t(pos + 1);
+        if (diff == 0)
+        {
+            if (m_dequeuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                break;
+        }
+        else if (diff < 0)
+        {
+            // Empty
+            return false;
+        }
+        else
+        {
+            pos = m_dequeuePos.load(std::memory_order_relaxed);
+        }
+    }
+    m = cell->message;
+    cell->sequence.store(pos + QueueCapacity, std::memory_order_release);
+    return true;
+}
+
+void GLDebugSink::push(GLenum source, GLenum type, GLuint id, GLenum severity, GLsizei length, const char* message)
+{
+    Counter* c = counter(id);
+    if (c)
+    {
+        c->count.fetch_add(1, std::memory_order_relaxed);
+
+        // Rate limit (per ID and per second)
+        const uint64_t second = currentSecond();
+        uint64_t window = c->window.load(std::memory_order_relaxed);
+        if (window != second && c->window.compare_exchange_strong(window, second, std::memory_order_relaxed))
+            c->windowCount.store(0, std::memory_order_relaxed);
+        if (c->windowCount.fetch_add(1, std::memory_order_relaxed) >= maxPerSecond.load(std::memory_order_relaxed))
+        {
+            c->suppressed.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+    }
+
+    Message m;
+    m.source = source;
+    m.type = type;
+    m.severity = severity;
+    m.id = id;
+    std::size_t size = length < 0 ? std::strlen(message) : std::size_t(length);
+    size = std::min(size, sizeof(m.text) - 1);
+    std::memcpy(m.text, message, size);
+    m.text[size] = '\0';
+
+    // Errors are printed right away (single write), in case the application
+    // stops before the next drain. They are still queued for the panel.
+    if (severity == GL_DEBUG_SEVERITY_HIGH)
+    {
+        std::stringstream ss;
+        writeMessage(ss, m);
+        std::cerr << ss.str();
+        std::cerr.flush();
+        m.printed = true;
+    }
+
+    if (!enqueue(m))
+        m_dropped.fetch_add(1, std::memory_order_relaxed);
+}
+
+std::size_t GLDebugSink::drain(std::ostream& out)
+{
+    // Format everything in memory, then write it once
+    std::stringstream ss;
+    std::size_t printed = 0;
+    Message m;
+    while (dequeue(m))
+    {
+        if (!m.printed)
+        {
+            writeMessage(ss, m);
+            printed++;
+        }
+
+        Info& info = m_infos[m.id];
+        info.text = m.text;
+        info.type = m.type;
+        info.severity = m.severity;
+    }
+
+    // Update the counters and report the suppressed messages
+    for (std::size_t i = 0; i < CounterCapacity; ++i)
+    {
+        const Counter& c = m_counters[i];
+        const uint64_t key = c.key.load(std::memory_order_acquire);
+        if (key == 0)
+            continue;
+        Info& info = m_infos[GLuint(key - 1)];
+        info.count = c.count.load(std::memory_order_relaxed);
+        info.suppressed = c.suppressed.load(std::memory_order_relaxed);
+        if (info.suppressed != info.suppressedPrinted)
+        {
+            ss << "Debug message (" << key - 1 << "): " << info.suppressed - info.suppressedPrinted
+               << " more message(s) suppressed (rate limit)\n";
+            info.suppressedPrinted = info.suppressed;
+        }
+    }
+
+    const std::string text = ss.str();
+    if (!text.empty())
+    {
+        out << text;
+        out.flush();
+    }
+    return printed;
+}
+
+void GLDebugSink::drawImgui()
+{
+    ImGui::Begin("GL debug messages");
+    int perSecond = int(maxPerSecond.load());
+    if (ImGui::InputInt("Max per second", &perSecond))
+        maxPerSecond.store(uint32_t(std::max(perSecond, 0)));
+    ImGui::Text("Dropped (queue full): %llu", (unsigned long long)m_dropped.load());
+    ImGui::Separator();
+    ImGui::Columns(4);
+    ImGui::Text("ID"); ImGui::NextColumn();
+    ImGui::Text("Count"); ImGui::NextColumn();
+    ImGui::Text("Suppressed"); ImGui::NextColumn();
+    ImGui::Text("Type / Severity"); ImGui::NextColumn();
+    ImGui::Separator();
+    for (const auto& it : m_infos)
+    {
+        ImGui::Text("%u", it.first); ImGui::NextColumn();
+        ImGui::Text("%llu", (unsigned long long)it.second.count); ImGui::NextColumn();
+        ImGui::Text("%llu", (unsigned long long)it.second.suppressed); ImGui::NextColumn();
+        ImGui::Text("%s / %s", typeString(it.second.type), severityString(it.second.severity));
+        if (!it.second.text.empty() && ImGui::IsItemHovered())
+            ImGui::SetTooltip("%s", it.second.text.c_str());
+        ImGui::NextColumn();
+    }
+    ImGui::Columns(1);
+    ImGui::End();
+}
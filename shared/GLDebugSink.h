@@ -0,0 +1,117 @@
+#pragma once
+
+#include <glad/glad.h>
+
+#include <atomic>
+#include <cstdint>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <string>
+
+// Destination of the OpenGL debug messages (see glDebugOutput)
+// The debug callback only copies the message inside a bounded lock-free queue.
+// The messages are formatted and printed later by drain() (end of the frame),
+// with a single write to the console. The high severity messages (errors) are
+// also printed immediately on std::cerr, and the messages still queued when
+// the application exits are printed by the destructor.
+//
+// To avoid slowing down the application with a storm of identical messages:
+//  - each message ID is counted
+//  - only a few messages per ID and per second are kept (rate limit),
+//    the others are counted as suppressed
+//
+// Usage:
+//   GLDebugSink::install(); // After gladLoadGLLoader (needs a debug context)
+//   ...
+//   GLDebugSink::instance().drain(); // At the end of each frame
+//   GLDebugSink::instance().drawImgui(); // Inside the ImGui frame
+class GLDebugSink
+{
+public:
+    // Copy of a debug message
+    struct Message
+    {
+        GLenum source = 0;
+        GLenum type = 0;
+        GLenum severity = 0;
+        GLuint id = 0;
+        bool printed = false; // Already printed by push() (high severity)
+        char text[256] = { 0 };
+    };
+
+public:
+    // ------------------------------------------------------------------------
+    // unique instance (the debug callback is global)
+    static GLDebugSink& instance();
+
+    // ------------------------------------------------------------------------
+    // enable the debug output and install the callback (glDebugOutput)
+    // return false if the context is not a debug context
+    static bool install(bool synchronous = true);
+
+    // ------------------------------------------------------------------------
+    // called from the debug callback (any thread, lock-free)
+    void push(GLenum source, GLenum type, GLuint id, GLenum severity, GLsizei length, const char* message);
+
+    // ------------------------------------------------------------------------
+    // format and print the queued messages
+    // return the number of messages printed
+    std::size_t drain(std::ostream& out = std::cout);
+
+    // ------------------------------------------------------------------------
+    // show the number of messages per ID inside an ImGui window
+    // Note: the table is updated by drain()
+    void drawImgui();
+
+    // Maximum number of messages kept per ID and per second
+    std::atomic<uint32_t> maxPerSecond{ 5 };
+
+private:
+    GLDebugSink();
+    ~GLDebugSink();
+
+    // Counters of a message ID (lock-free open addressing table)
+    struct Counter
+    {
+        std::atomic<uint64_t> key{ 0 };         // id + 1 (0 = empty)
+        std::atomic<uint64_t> count{ 0 };       // Total number of messages
+        std::atomic<uint64_t> suppressed{ 0 };  // Rate limited messages
+        std::atomic<uint64_t> window{ 0 };      // Second of the current rate window
+        std::atomic<uint32_t> windowCount{ 0 }; // Messages inside this window
+    };
+    Counter* counter(GLuint id);
+
+    // Bounded MPMC queue (Dmitry Vyukov)
+    struct Cell
+    {
+        std::atomic<std::size_t> sequence;
+        Message message;
+    };
+    bool enqueue(const Message& m);
+    bool dequeue(Message& m);
+
+    // Information shown by the panel (only accessed by the thread calling drain)
+    struct Info
+    {
+        std::string text;
+        GLenum type = 0;
+        GLenum severity = 0;
+        uint64_t count = 0;
+        uint64_t suppressed = 0;
+        uint64_t suppressedPrinted = 0;
+    };
+
+private:
+    static const std::size_t QueueCapacity = 1024; // Power of two
+    static const std::size_t CounterCapacity = 512; // Power of two
+
+    std::unique_ptr<Cell[]> m_cells;
+    std::atomic<std::size_t> m_enqueuePos{ 0 };
+    std::atomic<std::size_t> m_dequeuePos{ 0 };
+    // Messages lost because the queue was full
+    std::atomic<uint64_t> m_dropped{ 0 };
+
+    std::unique_ptr<Counter[]> m_counters;
+    std::map<GLuint, Info> m_infos;
+};
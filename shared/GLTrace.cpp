@@ -0,0 +1,471 @@
+#include "GLTrace.h"
+
+#ifndef GL_TRACE
+
+// Tracing not compiled (CMake option ENABLE_GL_TRACE)
+bool GLTrace::install() { return false; }
+void GLTrace::uninstall() {}
+bool GLTrace::isInstalled() { return false; }
+void GLTrace::endFrame() {}
+void GLTrace::drawImgui() {}
+bool GLTrace::startDump(const std::string&) { return false; }
+void GLTrace::stopDump() {}
+void GLTrace::printSyncPoints() {}
+
+#else
+
+#include <glad/glad.h>
+#include <imgui.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <unordered_map>
+#include <vector>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define GL_TRACE_RETURN_ADDRESS() _ReturnAddress()
+#else
+#define GL_TRACE_RETURN_ADDRESS() __builtin_return_address(0)
+#endif
+
+#if !defined(_WIN32)
+#include <dlfcn.h>
+#endif
+#if defined(__GNUC__)
+#include <cxxabi.h>
+#endif
+
+namespace
+{
+    // One identifier per OpenGL function
+    enum FunctionId
+    {
+#define GL_TRACE_FUNCTION(name) Id_##name,
+#include "GLTraceFunctions.inl"
+#undef GL_TRACE_FUNCTION
+        FunctionCount
+    };
+
+    struct Function
+    {
+        const char* name = nullptr;
+        bool sync = false;      // Known synchronization point
+        bool roundTrip = false; // Query answered by the driver (glGet*, glIs*)
+        bool installed = false;
+        uint32_t calls = 0;     // Current frame
+        uint32_t syncCalls = 0; // Current frame (calls that really synchronize)
+        uint32_t roundTripCalls = 0; // Current frame (driver round-trips)
+        uint32_t lastCalls = 0; // Last frame
+        uint32_t lastSyncCalls = 0;
+        uint32_t lastRoundTripCalls = 0;
+        uint64_t total = 0;
+    };
+
+    struct CallSite
+    {
+        std::size_t id = 0;
+        std::string description;
+        uint32_t calls = 0;
+        uint32_t lastCalls = 0;
+        uint64_t total = 0;
+    };
+
+    Function g_functions[FunctionCount];
+    // Call sites of the synchronization points and of the driver round-trips
+    std::unordered_map<const void*, CallSite> g_callSites;
+    std::unordered_map<const void*, CallSite> g_roundTripSites;
+    bool g_installed = false;
+    uint64_t g_frameIndex = 0;
+    std::ofstream g_dump;
+    bool g_onlySync = false;
+    // Original functions used by the checks done at call time (not traced)
+    PFNGLGETINTEGERVPROC g_getIntegerv = nullptr;
+    PFNGLGETQUERYOBJECTUIVPROC g_getQueryObjectuiv = nullptr;
+
+    // Functions that can wait for the GPU (see SyncCheck for the ones that
+    // only synchronize with some arguments or bindings). The other queries
+    // (glGetIntegerv, glGetUniformLocation, glIsEnabled, ...) do not wait for
+    // the GPU but are driver round-trips: with a threaded driver (Mesa
+    // glthread, NVIDIA threaded optimization) they wait for the driver thread
+    // to process all the commands already submitted.
+    const char* const SyncPoints[] = {
+        "glFinish", "glClientWaitSync", "glGetError",
+        // Pixels read into client memory
+        "glReadPixels", "glReadnPixels",
+        "glGetTexImage", "glGetnTexImage", "glGetTextureImage", "glGetTextureSubImage",
+        "glGetCompressedTexImage", "glGetnCompressedTexImage",
+        "glGetCompressedTextureImage", "glGetCompressedTextureSubImage",
+        // Buffers read or mapped
+        "glGetBufferSubData", "glGetNamedBufferSubData",
+        "glMapBuffer", "glMapNamedBuffer", "glMapBufferRange", "glMapNamedBufferRange",
+        // Query results
+        "glGetQueryObjectiv", "glGetQueryObjectuiv", "glGetQueryObjecti64v", "glGetQueryObjectui64v",
+    };
+
+    bool isSyncPoint(const char* name)
+    {
+        for (const char* s : SyncPoints)
+        {
+            if (std::strcmp(s, name) == 0)
+                return true;
+        }
+        return false;
+    }
+
+    bool isRoundTrip(const char* name)
+    {
+        return std::strncmp(name, "glGet", 5) == 0 || std::strncmp(name, "glIs", 4) == 0;
+    }
+
+    bool isBound(GLenum binding)
+    {
+        GLint buffer = 0;
+        if (g_getIntegerv)
+            g_getIntegerv(binding, &buffer);
+        return buffer != 0;
+    }
+
+    // Checks done at call time with the arguments of a synchronization point
+    // (default: always synchronize)
+    template <std::size_t Id>
+    struct SyncCheck
+    {
+        template <typename... A>
+        static bool synchronizes(A...) { return true; }
+    };
+
+    // Pixels read inside a buffer (PBO) are asynchronous
+    struct PackCheck
+    {
+        template <typename... A>
+        static bool synchronizes(A...) { return !isBound(GL_PIXEL_PACK_BUFFER_BINDING); }
+    };
+    template <> struct SyncCheck<Id_glReadPixels> : PackCheck {};
+    template <> struct SyncCheck<Id_glReadnPixels> : PackCheck {};
+    template <> struct SyncCheck<Id_glGetTexImage> : PackCheck {};
+    template <> struct SyncCheck<Id_glGetnTexImage> : PackCheck {};
+    template <> struct SyncCheck<Id_glGetTextureImage> : PackCheck {};
+    template <> struct SyncCheck<Id_glGetTextureSubImage> : PackCheck {};
+    template <> struct SyncCheck<Id_glGetCompressedTexImage> : PackCheck {};
+    template <> struct SyncCheck<Id_glGetnCompressedTexImage> : PackCheck {};
+    template <> struct SyncCheck<Id_glGetCompressedTextureImage> : PackCheck {};
+    template <> struct SyncCheck<Id_glGetCompressedTextureSubImage> : PackCheck {};
+
+    // Unsynchronized and persistent mappings do not wait for the GPU
+    struct MapRangeCheck
+    {
+        template <typename B, typename O, typename L>
+        static bool synchronizes(B, O, L, GLbitfield access)
+        {
+            return (access & (GL_MAP_UNSYNCHRONIZED_BIT | GL_MAP_PERSISTENT_BIT)) == 0;
+        }
+    };
+    template <> struct SyncCheck<Id_glMapBufferRange> : MapRangeCheck {};
+    template <> struct SyncCheck<Id_glMapNamedBufferRange> : MapRangeCheck {};
+
+    // Only GL_QUERY_RESULT waits, when the result is not available yet and
+    // is not written inside a query buffer
+    struct QueryCheck
+    {
+        template <typename T>
+        static bool synchronizes(GLuint id, GLenum pname, T*)
+        {
+            if (pname != GL_QUERY_RESULT || isBound(GL_QUERY_BUFFER_BINDING))
+                return false;
+            GLuint available = GL_FALSE;
+            if (g_getQueryObjectuiv)
+                g_getQueryObjectuiv(id, GL_QUERY_RESULT_AVAILABLE, &available);
+            return available == GL_FALSE;
+        }
+    };
+    template <> struct SyncCheck<Id_glGetQueryObjectiv> : QueryCheck {};
+    template <> struct SyncCheck<Id_glGetQueryObjectuiv> : QueryCheck {};
+    template <> struct SyncCheck<Id_glGetQueryObjecti64v> : QueryCheck {};
+    template <> struct SyncCheck<Id_glGetQueryObjectui64v> : QueryCheck {};
+
+    // Human readable call site: "symbol (module+0xoffset)"
+    // The offset can be given to addr2line
+    std::string describe(const void* address)
+    {
+        std::stringstream ss;
+#if !defined(_WIN32)
+        Dl_info info;
+        if (dladdr(address, &info) && info.dli_fname)
+        {
+            std::string symbol = info.dli_sname ? info.dli_sname : "?";
+#if defined(__GNUC__)
+            int status = 0;
+            char* demangled = abi::__cxa_demangle(symbol.c_str(), nullptr, nullptr, &status);
+            if (status == 0 && demangled)
+                symbol = demangled;
+            std::free(demangled);
+#endif
+            std::string module = info.dli_fname;
+            std::size_t pos = module.find_last_of("/\\");
+            if (pos != std::string::npos)
+                module = module.substr(pos + 1);
+            ss << symbol << " (" << module << "+0x" << std::hex
+               << (uintptr_t(address) - uintptr_t(info.dli_fbase)) << ")";
+            return ss.str();
+        }
+#endif
+        ss << address;
+        return ss.str();
+    }
+
+    // Call sites sorted by total number of calls
+    std::vector<const CallSite*> sortedSites(const std::unordered_map<const void*, CallSite>& map)
+    {
+        std::vector<const CallSite*> sites;
+        for (const auto& it : map)
+            sites.push_back(&it.second);
+        std::sort(sites.begin(), sites.end(), [](const CallSite* a, const CallSite* b) {
+            return a->total > b->total;
+        });
+        return sites;
+    }
+
+    inline void onCall(std::size_t id, const void* caller, bool synchronizes)
+    {
+        Function& f = g_functions[id];
+        f.calls++;
+        // A query that does not wait for the GPU is still a round-trip
+        // (e.g. glGetQueryObjectuiv(GL_QUERY_RESULT_AVAILABLE))
+        if (synchronizes)
+            f.syncCalls++;
+        else if (f.roundTrip)
+            f.roundTripCalls++;
+        else
+            return;
+
+        CallSite& c = synchronizes ? g_callSites[caller] : g_roundTripSites[caller];
+        if (c.description.empty())
+        {
+            c.id = id;
+            c.description = describe(caller);
+        }
+        c.calls++;
+    }
+
+    // Wrapper with the same signature than the original function
+    template <std::size_t Id, typename F> struct Hook;
+    template <std::size_t Id, typename R, typename... A>
+    struct Hook<Id, R (APIENTRYP)(A...)>
+    {
+        typedef R (APIENTRYP Pointer)(A...);
+        static Pointer& original()
+        {
+            static Pointer p = nullptr;
+            return p;
+        }
+        static R APIENTRY call(A... args)
+        {
+            // The arguments are only checked for the synchronization points
+            const bool synchronizes = g_functions[Id].sync && SyncCheck<Id>::synchronizes(args...);
+            onCall(Id, GL_TRACE_RETURN_ADDRESS(), synchronizes);
+            return original()(args...);
+        }
+    };
+
+    template <std::size_t Id, typename F>
+    void hook(F& pointer, const char* name)
+    {
+        Function& f = g_functions[Id];
+        f.name = name;
+        f.sync = isSyncPoint(name);
+        f.roundTrip = isRoundTrip(name);
+        if (!pointer || f.installed)
+            return; // Function not loaded by glad
+        Hook<Id, F>::original() = pointer;
+        pointer = &Hook<Id, F>::call;
+        f.installed = true;
+    }
+
+    template <std::size_t Id, typename F>
+    void unhook(F& pointer)
+    {
+        Function& f = g_functions[Id];
+        if (!f.installed)
+            return;
+        pointer = Hook<Id, F>::original();
+        f.installed = false;
+    }
+}
+
+bool GLTrace::install()
+{
+    if (g_installed)
+        return true;
+    g_getIntegerv = glad_glGetIntegerv;
+    g_getQueryObjectuiv = glad_glGetQueryObjectuiv;
+#define GL_TRACE_FUNCTION(name) hook<Id_##name>(glad_##name, #name);
+#include "GLTraceFunctions.inl"
+#undef GL_TRACE_FUNCTION
+    g_installed = true;
+    std::cout << "OpenGL call tracing installed\n";
+    return true;
+}
+
+void GLTrace::uninstall()
+{
+    if (!g_installed)
+        return;
+#define GL_TRACE_FUNCTION(name) unhook<Id_##name>(glad_##name);
+#include "GLTraceFunctions.inl"
+#undef GL_TRACE_FUNCTION
+    g_installed = false;
+}
+
+bool GLTrace::isInstalled()
+{
+    return g_installed;
+}
+
+void GLTrace::endFrame()
+{
+    if (!g_installed)
+        return;
+    for (Function& f : g_functions)
+    {
+        if (g_dump.is_open() && f.calls != 0)
+            g_dump << g_frameIndex << "," << f.name << "," << f.calls << "," << f.syncCalls
+                   << "," << f.roundTripCalls << "\n";
+        f.lastCalls = f.calls;
+        f.lastSyncCalls = f.syncCalls;
+        f.lastRoundTripCalls = f.roundTripCalls;
+        f.total += f.calls;
+        f.calls = 0;
+        f.syncCalls = 0;
+        f.roundTripCalls = 0;
+    }
+    for (auto* sites : { &g_callSites, &g_roundTripSites })
+    {
+        for (auto& it : *sites)
+        {
+            CallSite& c = it.second;
+            c.lastCalls = c.calls;
+            c.total += c.calls;
+            c.calls = 0;
+        }
+    }
+    g_frameIndex++;
+}
+
+void GLTrace::drawImgui()
+{
+    if (!g_installed)
+        return;
+
+    ImGui::Begin("GL calls");
+    uint32_t calls = 0, syncCalls = 0, roundTripCalls = 0;
+    std::vector<const Function*> functions;
+    for (const Function& f : g_functions)
+    {
+        calls += f.lastCalls;
+        syncCalls += f.lastSyncCalls;
+        roundTripCalls += f.lastRoundTripCalls;
+        if (f.lastCalls != 0 && (!g_onlySync || f.lastSyncCalls != 0 || f.lastRoundTripCalls != 0))
+            functions.push_back(&f);
+    }
+    std::sort(functions.begin(), functions.end(), [](const Function* a, const Function* b) {
+        return a->lastCalls > b->lastCalls;
+    });
+
+    ImGui::Text("Last frame: %u calls, %u synchronization points, %u driver round-trips",
+        calls, syncCalls, roundTripCalls);
+    ImGui::Checkbox("Only synchronization points and round-trips", &g_onlySync);
+    if (!g_dump.is_open())
+    {
+        if (ImGui::Button("Start dump"))
+            startDump("gl_trace.csv");
+    }
+    else if (ImGui::Button("Stop dump"))
+    {
+        stopDump();
+    }
+    ImGui::SameLine();
+    if (ImGui::Button("Print sync points"))
+        printSyncPoints();
+
+    if (ImGui::CollapsingHeader("Calls per entry point", ImGuiTreeNodeFlags_DefaultOpen))
+    {
+        ImGui::Columns(4);
+        ImGui::Text("Function"); ImGui::NextColumn();
+        ImGui::Text("Calls"); ImGui::NextColumn();
+        ImGui::Text("Sync"); ImGui::NextColumn();
+        ImGui::Text("Round-trip"); ImGui::NextColumn();
+        ImGui::Separator();
+        for (const Function* f : functions)
+        {
+            if (f->lastSyncCalls != 0)
+                ImGui::TextColored(ImVec4(1.0f, 0.4f, 0.3f, 1.0f), "%s", f->name);
+            else if (f->lastRoundTripCalls != 0)
+                ImGui::TextColored(ImVec4(1.0f, 0.8f, 0.3f, 1.0f), "%s", f->name);
+            else
+                ImGui::Text("%s", f->name);
+            ImGui::NextColumn();
+            ImGui::Text("%u", f->lastCalls); ImGui::NextColumn();
+            ImGui::Text("%u", f->lastSyncCalls); ImGui::NextColumn();
+            ImGui::Text("%u", f->lastRoundTripCalls); ImGui::NextColumn();
+        }
+        ImGui::Columns(1);
+    }
+
+    auto drawSites = [](const char* header, const std::unordered_map<const void*, CallSite>& map) {
+        if (!ImGui::CollapsingHeader(header, ImGuiTreeNodeFlags_DefaultOpen))
+            return;
+        for (const CallSite* c : sortedSites(map))
+        {
+            ImGui::Text("%-16s %6u / frame %10llu total  %s", g_functions[c->id].name, c->lastCalls,
+                (unsigned long long)c->total, c->description.c_str());
+        }
+    };
+    drawSites("Synchronization call sites", g_callSites);
+    drawSites("Driver round-trip call sites", g_roundTripSites);
+    ImGui::End();
+}
+
+bool GLTrace::startDump(const std::string& path)
+{
+    if (!g_installed)
+        return false;
+    g_dump.close();
+    g_dump.open(path);
+    if (!g_dump.is_open())
+    {
+        std::cerr << "Impossible to write: " << path << std::endl;
+        return false;
+    }
+    g_dump << "frame,function,calls,sync,roundtrip\n";
+    std::cout << "OpenGL calls dumped in: " << path << "\n";
+    return true;
+}
+
+void GLTrace::stopDump()
+{
+    g_dump.close();
+}
+
+void GLTrace::printSyncPoints()
+{
+    if (!g_installed)
+        return;
+    std::stringstream ss;
+    auto printSites = [&ss](const char* title, const std::unordered_map<const void*, CallSite>& map) {
+        ss << title << " (" << map.size() << " call sites):\n";
+        for (const CallSite* c : sortedSites(map))
+            ss << " - " << g_functions[c->id].name << ": " << c->total + c->calls << " calls from " << c->description << "\n";
+    };
+    printSites("OpenGL synchronization points", g_callSites);
+    printSites("OpenGL driver round-trips", g_roundTripSites);
+    std::cout << ss.str();
+    std::cout.flush();
+}
+
+#endif
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <string>
+
+// Opt-in OpenGL call tracing (CMake option ENABLE_GL_TRACE)
+// The glad function pointers are replaced by wrappers that count the calls
+// of each entry point per frame. The calls that synchronize the CPU with the GPU
+// (glFinish, glClientWaitSync, glGetError, pixels read into client memory,
+// buffer reads, synchronized maps, query results not available yet) are
+// flagged and their call sites are recorded in a histogram. The arguments and
+// the bindings (pixel pack buffer, query buffer, map flags) are checked at
+// call time. The other queries (glGet*, glIs*) are flagged as driver
+// round-trips, with their own histogram: they do not wait for the GPU but
+// stall a threaded driver (Mesa glthread, NVIDIA threaded optimization).
+//
+// Note: the OpenGL calls of the ImGui backend are not traced (own loader).
+// When ENABLE_GL_TRACE is OFF, all these functions do nothing.
+//
+// Usage:
+//   GLTrace::install(); // After gladLoadGLLoader
+//   ...
+//   GLTrace::endFrame(); // At the end of each frame
+//   GLTrace::drawImgui(); // Inside the ImGui frame
+namespace GLTrace
+{
+    // ------------------------------------------------------------------------
+    // replace/restore the glad function pointers
+    // return false if the tracing is not compiled (ENABLE_GL_TRACE)
+    bool install();
+    void uninstall();
+    bool isInstalled();
+
+    // ------------------------------------------------------------------------
+    // delimit a frame (the statistics shown are the ones of the last frame)
+    void endFrame();
+
+    // ------------------------------------------------------------------------
+    // show the statistics inside an ImGui window
+    void drawImgui();
+
+    // ------------------------------------------------------------------------
+    // write the statistics of each frame inside a CSV file
+    // (frame, function, calls, sync, roundtrip) until stopDump()
+    bool startDump(const std::string& path);
+    void stopDump();
+
+    // ------------------------------------------------------------------------
+    // print the synchronization points, the driver round-trips and their call sites
+    void printSyncPoints();
+}
@@ -0,0 +1,255 @@
+#include "GpuTimer.h"
+
+#include <imgui.h>
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+
+namespace
+{
+    // Zone name inside a JSON string
+    void writeEscaped(std::ostream& out, const std::string& s)
+    {
+        for (char c : s)
+        {
+            if (c == '"' || c == '\\')
+                out << '\\';
+            out << c;
+        }
+    }
+}
+
+GpuProfiler::GpuProfiler(int latency)
+    : m_frames(std::max(latency, 2))
+{
+}
+
+GLuint GpuProfiler::allocateQuery(Frame& f)
+{
+    if (f.usedQueries == f.queries.size())
+    {
+        // Grow the pool (the queries are reused at each frame)
+        std::size_t oldSize = f.queries.size();
+        f.queries.resize(std::max<std::size_t>(16, oldSize * 2));
+        glCreateQueries(GL_TIMESTAMP, GLsizei(f.queries.size() - oldSize), &f.queries[oldSize]);
+    }
+    return f.queries[f.usedQueries++];
+}
+
+void GpuProfiler::beginFrame()
+{
+    if (!m_initialized)
+    {
+        // Software rasterizers (or old drivers) may not implement the timestamps
+        GLint bits = 0;
+        glGetQueryiv(GL_TIMESTAMP, GL_QUERY_COUNTER_BITS, &bits);
+        m_supported = bits > 0;
+        m_initialized = true;
+        if (!m_supported)
+            std::cerr << "GpuProfiler: timestamp queries are not supported\n";
+    }
+    if (!enabled || !m_supported)
+        return;
+
+    // Reuse the oldest frame, its results should be ready by now
+    m_current = (m_current + 1) % m_frames.size();
+    Frame& f = m_frames[m_current];
+    if (f.pending)
+        collect(f);
+    f.zones.clear();
+    f.usedQueries = 0;
+    f.index = m_frameIndex++;
+    m_stack.clear();
+    m_inFrame = true;
+
+    push("Frame");
+}
+
+void GpuProfiler::endFrame()
+{
+    if (!m_inFrame)
+        return;
+    while (!m_stack.empty())
+        pop();
+    m_frames[m_current].pending = true;
+    m_inFrame = false;
+}
+
+void GpuProfiler::push(const std::string& name)
+{
+    if (!m_inFrame)
+        return;
+    Frame& f = m_frames[m_current];
+    Zone z;
+    z.name = name;
+    z.depth = int(m_stack.size());
+    z.queryBegin = allocateQuery(f);
+    glQueryCounter(z.queryBegin, GL_TIMESTAMP);
+    m_stack.push_back(f.zones.size());
+    f.zones.push_back(z);
+}
+
+void GpuProfiler::pop()
+{
+    if (!m_inFrame || m_stack.empty())
+        return;
+    Frame& f = m_frames[m_current];
+    Zone& z = f.zones[m_stack.back()];
+    z.queryEnd = allocateQuery(f);
+    glQueryCounter(z.queryEnd, GL_TIMESTAMP);
+    m_stack.pop_back();
+}
+
+void GpuProfiler::collect(Frame& f)
+{
+    f.pending = false;
+    if (f.zones.empty())
+        return;
+
+    // The last query issued is the end of the "Frame" zone.
+    // If it is not available, skip this frame instead of waiting the GPU.
+    GLint available = 0;
+    glGetQueryObjectiv(f.zones[0].queryEnd, GL_QUERY_RESULT_AVAILABLE, &available);
+    if (!available)
+    {
+        m_droppedFrames++;
+        return;
+    }
+
+    FrameResult frame;
+    frame.index = f.index;
+    std::vector<std::string> path;
+    for (const Zone& z : f.zones)
+    {
+        GLuint64 begin = 0, end = 0;
+        glGetQueryObjectui64v(z.queryBegin, GL_QUERY_RESULT, &begin);
+        glGetQueryObjectui64v(z.queryEnd, GL_QUERY_RESULT, &end);
+
+        ZoneResult r;
+        r.name = z.name;
+        r.depth = z.depth;
+        r.ms = double(end - begin) * 1e-6;
+
+        // Average identified by the full path of the zone
+        path.resize(z.depth);
+        path.push_back(z.name);
+        std::string key;
+        for (const std::string& p : path)
+            key += "/" + p;
+        auto it = m_averages.find(key);
+        if (it == m_averages.end())
+            it = m_averages.insert({ key, r.ms }).first;
+        else
+            it->second = 0.95 * it->second + 0.05 * r.ms;
+        r.avgMs = it->second;
+
+        frame.zones.push_back(r);
+    }
+
+    m_results = frame.zones;
+    m_history.push_back(std::move(frame));
+    while (m_history.size() > m_historySize)
+        m_history.pop_front();
+}
+
+void GpuProfiler::drawImgui()
+{
+    ImGui::Begin("GPU timings");
+    ImGui::Checkbox("Enabled", &enabled);
+    if (!m_supported)
+    {
+        ImGui::Text("Timestamp queries not supported");
+        ImGui::End();
+        return;
+    }
+    ImGui::Text("Dropped frames (not ready): %llu", (unsigned long long)m_droppedFrames);
+    ImGui::Separator();
+    // Collapsible tree: the zones are in begin order with their depth,
+    // the children of a closed zone are skipped
+    int opened = 0; // Tree nodes pushed (open zones)
+    for (std::size_t i = 0; i < m_results.size(); ++i)
+    {
+        const ZoneResult& r = m_results[i];
+        while (opened > r.depth)
+        {
+            ImGui::TreePop();
+            opened--;
+        }
+        if (r.depth > opened)
+            continue;
+        const bool leaf = i + 1 == m_results.size() || m_results[i + 1].depth <= r.depth;
+        ImGuiTreeNodeFlags flags = ImGuiTreeNodeFlags_DefaultOpen | ImGuiTreeNodeFlags_SpanAvailWidth;
+        if (leaf)
+            flags |= ImGuiTreeNodeFlags_Leaf | ImGuiTreeNodeFlags_NoTreePushOnOpen;
+        const bool open = ImGui::TreeNodeEx(r.name.c_str(), flags, "%-20s %7.3f ms (avg %7.3f ms)", r.name.c_str(), r.ms, r.avgMs);
+        if (open && !leaf)
+            opened++;
+    }
+    while (opened-- > 0)
+        ImGui::TreePop();
+    ImGui::Separator();
+    if (ImGui::Button("Export CSV"))
+        exportCSV("gpu_timings.csv");
+    ImGui::SameLine();
+    if (ImGui::Button("Export JSON"))
+        exportJSON("gpu_timings.json");
+    ImGui::End();
+}
+
+bool GpuProfiler::exportCSV(const std::string& path) const
+{
+    std::ofstream file(path);
+    if (!file.is_open())
+    {
+        std::cerr << "Impossible to write: " << path << std::endl;
+        return false;
+    }
+    file << "frame,zone,depth,ms\n";
+    for (const FrameResult& f : m_history)
+        for (const ZoneResult& z : f.zones)
+            file << f.index << "," << z.name << "," << z.depth << "," << z.ms << "\n";
+    std::cout << "GPU timings exported: " << path << "\n";
+    return true;
+}
+
+bool GpuProfiler::exportJSON(const std::string& path) const
+{
+    std::ofstream file(path);
+    if (!file.is_open())
+    {
+        std::cerr << "Impossible to write: " << path << std::endl;
+        return false;
+    }
+    file << "{\n  \"frames\": [";
+    for (std::size_t i = 0; i < m_history.size(); ++i)
+    {
+        const FrameResult& f = m_history[i];
+        file << (i == 0 ? "\n" : ",\n") << "    { \"frame\": " << f.index << ", \"zones\": [";
+        for (std::size_t j = 0; j < f.zones.size(); ++j)
+        {
+            const ZoneResult& z = f.zones[j];
+            file << (j == 0 ? "" : ", ") << "{ \"name\": \"";
+            writeEscaped(file, z.name);
+            file << "\", \"depth\": " << z.depth << ", \"ms\": " << z.ms << " }";
+        }
+        file << "] }";
+    }
+    file << "\n  ]\n}\n";
+    std::cout << "GPU timings exported: " << path << "\n";
+    return true;
+}
+
+void GpuProfiler::release()
+{
+    for (Frame& f : m_frames)
+    {
+        if (!f.queries.empty())
+            glDeleteQueries(GLsizei(f.queries.size()), f.queries.data());
+        f.queries.clear();
+        f.usedQueries = 0;
+        f.zones.clear();
+        f.pending = false;
+    }
+    m_inFrame = false;
+}
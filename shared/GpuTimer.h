@@ -0,0 +1,132 @@
+#pragma once
+
+#include <glad/glad.h>
+
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <string>
+#include <vector>
+
+// GPU profiler based on timestamp queries (glQueryCounter)
+// The results are read back several frames later to avoid any stall.
+// Zones can be nested, this gives a hierarchical view of a frame.
+//
+// Usage:
+//   m_gpuProfiler.beginFrame();
+//   {
+//      GpuTimer timer(m_gpuProfiler, "Shadow pass");
+//      ... OpenGL calls ...
+//   }
+//   m_gpuProfiler.endFrame();
+//   m_gpuProfiler.drawImgui(); // Inside the ImGui frame
+class GpuProfiler
+{
+public:
+    // Measured zone
+    struct ZoneResult
+    {
+        std::string name;
+        int depth = 0;
+        double ms = 0.0;    // Duration of the last measured frame
+        double avgMs = 0.0; // Smoothed duration
+    };
+
+public:
+    // ------------------------------------------------------------------------
+    // latency (in frames) before reading back the queries
+    GpuProfiler(int latency = 4);
+
+    // ------------------------------------------------------------------------
+    // delimit a frame (beginFrame push automatically a zone "Frame")
+    void beginFrame();
+    void endFrame();
+
+    // ------------------------------------------------------------------------
+    // begin/end a zone (prefer GpuTimer)
+    void push(const std::string& name);
+    void pop();
+
+    // ------------------------------------------------------------------------
+    // last results (in the order of the zones inside the frame)
+    const std::vector<ZoneResult>& results() const { return m_results; }
+
+    // ------------------------------------------------------------------------
+    // show the timings inside an ImGui window
+    void drawImgui();
+
+    // ------------------------------------------------------------------------
+    // export the history of the timings
+    // return true if sucessfull
+    bool exportCSV(const std::string& path) const;
+    bool exportJSON(const std::string& path) const;
+
+    // ------------------------------------------------------------------------
+    // delete the OpenGL queries (need to be called before destroying the context)
+    void release();
+
+    bool isSupported() const { return m_supported; }
+    bool enabled = true;
+
+private:
+    struct Zone
+    {
+        std::string name;
+        int depth = 0;
+        GLuint queryBegin = 0;
+        GLuint queryEnd = 0;
+    };
+    struct Frame
+    {
+        std::vector<GLuint> queries; // Pool of timestamp queries
+        std::size_t usedQueries = 0;
+        std::vector<Zone> zones;
+        uint64_t index = 0;
+        bool pending = false;        // Results not read yet
+    };
+    struct FrameResult
+    {
+        uint64_t index;
+        std::vector<ZoneResult> zones;
+    };
+
+    // Get a query from the frame pool
+    GLuint allocateQuery(Frame& f);
+    // Read the queries of a frame (only if they are available)
+    void collect(Frame& f);
+
+private:
+    std::vector<Frame> m_frames;
+    std::size_t m_current = 0;
+    uint64_t m_frameIndex = 0;
+    bool m_inFrame = false;
+    bool m_initialized = false;
+    bool m_supported = true;
+    // Index of the opened zones
+    std::vector<std::size_t> m_stack;
+
+    // Results
+    std::vector<ZoneResult> m_results;
+    std::map<std::string, double> m_averages;
+    std::deque<FrameResult> m_history;
+    const std::size_t m_historySize = 600;
+    // Number of frames where the results were not ready
+    uint64_t m_droppedFrames = 0;
+};
+
+// Scoped GPU zone (RAII)
+class GpuTimer
+{
+public:
+    GpuTimer(GpuProfiler& profiler, const std::string& name) : m_profiler(profiler) {
+        m_profiler.push(name);
+    }
+    ~GpuTimer() {
+        m_profiler.pop();
+    }
+    GpuTimer(const GpuTimer&) = delete;
+    GpuTimer& operator=(const GpuTimer&) = delete;
+
+private:
+    GpuProfiler& m_profiler;
+};
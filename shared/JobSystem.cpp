@@ -0,0 +1,406 @@
+#include "JobSystem.h"
+#include "CpuProfiler.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <string>
+
+struct Job
+{
+    std::function<void()> function;
+    JobCounter* counter = nullptr;
+    Job* next = nullptr; // Free list
+};
+
+namespace
+{
+    // Index of the deque of the current thread (-1 = no deque)
+    thread_local int t_index = -1;
+    // Random start of the victim search (xorshift)
+    thread_local uint32_t t_random = 0x9E3779B9u;
+
+    // Recycled jobs of the current thread (no allocation in the steady state)
+    struct JobPool
+    {
+        Job* free = nullptr;
+        int size = 0;
+
+        ~JobPool()
+        {
+            while (free)
+            {
+                Job* next = free->next;
+                delete free;
+                free = next;
+            }
+        }
+
+        Job* allocate()
+        {
+            if (!free)
+                return new Job();
+            Job* job = free;
+            free = job->next;
+            size--;
+            return job;
+        }
+
+        void release(Job* job)
+        {
+            job->function = nullptr;
+            job->counter = nullptr;
+            // The jobs freed by another thread than the allocating one
+            // accumulate here: keep a reasonable amount
+            if (size >= 4096)
+            {
+                delete job;
+                return;
+            }
+            job->next = free;
+            free = job;
+            size++;
+        }
+    };
+    thread_local JobPool t_pool;
+
+    uint32_t nextRandom()
+    {
+        uint32_t x = t_random;
+        x ^= x << 13;
+        x ^= x >> 17;
+        x ^= x << 5;
+        t_random = x;
+        return x;
+    }
+
+    // Spins before a worker goes to sleep
+    const int SpinCount = 256;
+}
+
+// ----------------------------------------------------------------------------
+bool JobSystem::WorkQueue::push(Job* job)
+{
+    const int64_t b = m_bottom.load(std::memory_order_relaxed);
+    const int64_t t = m_top.load(std::memory_order_acquire);
+    if (b - t >= Capacity)
+        return false;
+    m_jobs[b & (Capacity - 1)].store(job, std::memory_order_relaxed);
+    // release: the job is visible before the new bottom
+    m_bottom.store(b + 1, std::memory_order_release);
+    return true;
+}
+
+Job* JobSystem::WorkQueue::pop()
+{
+    const int64_t b = m_bottom.load(std::memory_order_relaxed) - 1;
+    // seq_cst: the new bottom is visible to the thieves before reading top
+    m_bottom.store(b, std::memory_order_seq_cst);
+    int64_t t = m_top.load(std::memory_order_seq_cst);
+    if (t > b)
+    {
+        // Empty
+        m_bottom.store(b + 1, std::memory_order_relaxed);
+        return nullptr;
+    }
+    Job* job = m_jobs[b & (Capacity - 1)].load(std::memory_order_relaxed);
+    if (t == b)
+    {
+        // Last job: race with the thieves
+        if (!m_top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+            job = nullptr;
+        m_bottom.store(b + 1, std::memory_order_relaxed);
+    }
+    return job;
+}
+
+Job* JobSystem::WorkQueue::steal()
+{
+    int64_t t = m_top.load(std::memory_order_seq_cst);
+    const int64_t b = m_bottom.load(std::memory_order_seq_cst);
+    if (t >= b)
+        return nullptr;
+    Job* job = m_jobs[t & (Capacity - 1)].load(std::memory_order_relaxed);
+    // Another thief (or the owner) took it first
+    if (!m_top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+        return nullptr;
+    return job;
+}
+
+bool JobSystem::WorkQueue::empty() const
+{
+    const int64_t b = m_bottom.load(std::memory_order_relaxed);
+    const int64_t t = m_top.load(std::memory_order_relaxed);
+    return b <= t;
+}
+
+// ----------------------------------------------------------------------------
+JobSystem& JobSystem::instance()
+{
+    static JobSystem jobSystem([]() {
+        if (const char* value = std::getenv("JOB_SYSTEM_WORKERS"))
+            return std::max(0, std::atoi(value));
+        return int(std::max(1u, std::thread::hardware_concurrency())) - 1;
+    }());
+    return jobSystem;
+}
+
+JobSystem::JobSystem(int workers)
+{
+    for (int i = 0; i <= workers; ++i)
+        m_queues.emplace_back(new WorkQueue());
+    // The creating thread helps with its own deque
+    t_index = 0;
+    for (int i = 1; i <= workers; ++i)
+        m_workers.emplace_back(&JobSystem::workerLoop, this, i);
+}
+
+JobSystem::~JobSystem()
+{
+    m_stop.store(true);
+    {
+        std::lock_guard<std::mutex> lock(m_sleepMutex);
+        m_wake.notify_all();
+    }
+    for (std::thread& worker : m_workers)
+        worker.join();
+}
+
+// ----------------------------------------------------------------------------
+void JobSystem::run(std::function<void()> function, JobCounter* counter, JobCounter* dependency)
+{
+    Job* job = t_pool.allocate();
+    job->function = std::move(function);
+    job->counter = counter;
+    if (counter)
+        counter->m_pending.fetch_add(1, std::memory_order_relaxed);
+
+    if (dependency && !dependency->isDone())
+    {
+        // The counter is checked again under the lock taken by finish()
+        std::lock_guard<std::mutex> lock(dependency->m_mutex);
+        if (!dependency->isDone())
+        {
+            dependency->m_continuations.push_back(job);
+            return;
+        }
+    }
+    submit(job);
+}
+
+void JobSystem::wait(JobCounter& counter)
+{
+    int spins = 0;
+    while (!counter.isDone())
+    {
+        if (Job* job = findJob(t_index))
+        {
+            execute(job);
+            spins = 0;
+        }
+        else if (++spins > SpinCount)
+        {
+            // The last jobs are executed by other threads
+            std::this_thread::yield();
+        }
+    }
+    // finish() can still hold the lock of the counter
+    std::lock_guard<std::mutex> lock(counter.m_mutex);
+}
+
+// ----------------------------------------------------------------------------
+void JobSystem::parallelFor(int begin, int end, const std::function<void(int, int)>& body, int grain)
+{
+    const int count = end - begin;
+    if (count <= 0)
+        return;
+    if (grain <= 0)
+        grain = std::max(1, count / (threadCount() * 16));
+    if (m_workers.empty() || count <= grain)
+    {
+        body(begin, end);
+        return;
+    }
+
+    PROFILE_SCOPE("JobSystem::parallelFor");
+    JobCounter counter;
+    const ParallelRange range = { this, &body, &counter, grain };
+    range.execute(begin, end);
+    wait(counter);
+}
+
+void JobSystem::ParallelRange::execute(int begin, int end) const
+{
+    while (end - begin > grain)
+    {
+        if (system->localQueueEmpty())
+        {
+            // Nobody has work waiting: give the second half to the other threads
+            // (small capture: stored inside the std::function, no allocation)
+            const ParallelRange* range = this;
+            const int middle = begin + (end - begin) / 2;
+            const int e = end;
+            system->run([range, middle, e]() { range->execute(middle, e); }, counter);
+            end = middle;
+        }
+        else
+        {
+            // The other threads are busy: keep the work for this thread
+            (*body)(begin, begin + grain);
+            begin += grain;
+        }
+    }
+    (*body)(begin, end);
+}
+
+// ----------------------------------------------------------------------------
+void JobSystem::workerLoop(int index)
+{
+    t_index = index;
+    t_random = 0x9E3779B9u * uint32_t(index + 1);
+#ifndef PROFILER_DISABLED
+    CpuProfiler::setThreadName("Job worker " + std::to_string(index));
+#endif
+
+    int spins = 0;
+    while (!m_stop.load(std::memory_order_relaxed))
+    {
+        if (Job* job = findJob(index))
+        {
+            execute(job);
+            spins = 0;
+            continue;
+        }
+        if (++spins < SpinCount)
+        {
+            std::this_thread::yield();
+            continue;
+        }
+
+        // Sleep until a job is submitted
+        // The counter is incremented before checking the queues, and submit()
+        // checks the counter after pushing: one of them sees the other
+        std::unique_lock<std::mutex> lock(m_sleepMutex);
+        m_sleeping.fetch_add(1, std::memory_order_seq_cst);
+        if (!hasWork() && !m_stop.load())
+            m_wake.wait_for(lock, std::chrono::milliseconds(100));
+        m_sleeping.fetch_sub(1, std::memory_order_relaxed);
+        spins = 0;
+    }
+}
+
+void JobSystem::submit(Job* job)
+{
+    if (t_index < 0 || !m_queues[t_index]->push(job))
+    {
+        std::lock_guard<std::mutex> lock(m_sharedMutex);
+        m_shared.push_back(job);
+        m_sharedCount.fetch_add(1, std::memory_order_relaxed);
+    }
+    wakeWorkers();
+}
+
+Job* JobSystem::findJob(int index)
+{
+    // Own deque (newest job, still in cache)
+    if (index >= 0)
+    {
+        if (Job* job = m_queues[index]->pop())
+            return job;
+    }
+
+    // Shared queue
+    if (m_sharedCount.load(std::memory_order_relaxed) > 0)
+    {
+        std::lock_guard<std::mutex> lock(m_sharedMutex);
+        if (!m_shared.empty())
+        {
+            Job* job = m_shared.front();
+            m_shared.pop_front();
+            m_sharedCount.fetch_sub(1, std::memory_order_relaxed);
+            return job;
+        }
+    }
+
+    // Steal the oldest job (the biggest part of a range) of another thread
+    const int n = int(m_queues.size());
+    const int start = int(nextRandom() % uint32_t(n));
+    for (int i = 0; i < n; ++i)
+    {
+        const int victim = (start + i) % n;
+        if (victim == index)
+            continue;
+        if (Job* job = m_queues[victim]->steal())
+        {
+            m_stolen.fetch_add(1, std::memory_order_relaxed);
+            return job;
+        }
+    }
+    return nullptr;
+}
+
+void JobSystem::execute(Job* job)
+{
+    job->function();
+    JobCounter* counter = job->counter;
+    t_pool.release(job);
+    m_executed.fetch_add(1, std::memory_order_relaxed);
+    if (counter)
+        finish(counter);
+}
+
+void JobSystem::finish(JobCounter* counter)
+{
+    // Not the last job: no lock
+    int pending = counter->m_pending.load(std::memory_order_relaxed);
+    while (pending > 1)
+    {
+        if (counter->m_pending.compare_exchange_weak(pending, pending - 1, std::memory_order_acq_rel, std::memory_order_relaxed))
+            return;
+    }
+
+    std::vector<Job*> continuations;
+    {
+        // Last decrement under the lock: run() cannot add a continuation
+        // between the decrement and the release of the continuations, and
+        // wait() does not return (and destroy the counter) before the unlock
+        std::lock_guard<std::mutex> lock(counter->m_mutex);
+        if (counter->m_pending.fetch_sub(1, std::memory_order_acq_rel) != 1)
+            return;
+        continuations.swap(counter->m_continuations);
+    }
+    for (Job* job : continuations)
+        submit(job);
+}
+
+void JobSystem::wakeWorkers()
+{
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (m_sleeping.load(std::memory_order_relaxed) == 0)
+        return;
+    // Taking the lock: the worker is either before the check of the queues
+    // (it sees the job) or inside wait (it receives the notification)
+    {
+        std::lock_guard<std::mutex> lock(m_sleepMutex);
+    }
+    m_wake.notify_one();
+}
+
+bool JobSystem::hasWork() const
+{
+    if (m_sharedCount.load(std::memory_order_relaxed) > 0)
+        return true;
+    for (const std::unique_ptr<WorkQueue>& queue : m_queues)
+    {
+        if (!queue->empty())
+            return true;
+    }
+    return false;
+}
+
+bool JobSystem::localQueueEmpty() const
+{
+    if (t_index >= 0)
+        return m_queues[t_index]->empty();
+    return m_sharedCount.load(std::memory_order_relaxed) == 0;
+}
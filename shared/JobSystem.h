@@ -0,0 +1,157 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Work-stealing job system
+// Each worker thread owns a deque of jobs (Chase-Lev): it pushes and pops its
+// own jobs at the bottom without lock, the idle workers steal the oldest jobs
+// at the top. A job can increment a JobCounter (wait for a group of jobs) and
+// can depend on another counter (it is only scheduled when the counter is done).
+// The waiting thread executes jobs instead of sleeping ("help while waiting").
+//
+// The thread that creates the instance (normally the main thread) owns a deque
+// too. Other threads (ex: the simulation thread) can use the job system: their
+// jobs go through a shared queue.
+//
+// Usage:
+//   JobSystem& jobs = JobSystem::instance();
+//   jobs.parallelFor(0, int(particles.size()), [&](int begin, int end) {
+//       for (int i = begin; i < end; ++i) update(particles[i]);
+//   });
+//
+//   JobCounter loaded, ready;
+//   jobs.run([&]() { loadA(); }, &loaded);
+//   jobs.run([&]() { loadB(); }, &loaded);
+//   jobs.run([&]() { build(); }, &ready, &loaded); // After loadA and loadB
+//   jobs.wait(ready);
+//
+// The number of workers is hardware threads - 1, the environment variable
+// JOB_SYSTEM_WORKERS overrides it (0 = everything on the calling thread).
+class JobSystem;
+struct Job;
+
+// Number of jobs not finished yet
+// The counter must stay alive until wait() returns.
+class JobCounter
+{
+public:
+    JobCounter() = default;
+    JobCounter(const JobCounter&) = delete;
+    JobCounter& operator=(const JobCounter&) = delete;
+
+    bool isDone() const { return m_pending.load(std::memory_order_acquire) == 0; }
+
+private:
+    friend class JobSystem;
+    std::atomic<int> m_pending{ 0 };
+    // Jobs scheduled when the counter reaches 0
+    std::mutex m_mutex;
+    std::vector<Job*> m_continuations;
+};
+
+class JobSystem
+{
+public:
+    // ------------------------------------------------------------------------
+    // unique instance (the workers are started on the first call)
+    static JobSystem& instance();
+
+    ~JobSystem();
+    JobSystem(const JobSystem&) = delete;
+    JobSystem& operator=(const JobSystem&) = delete;
+
+    // ------------------------------------------------------------------------
+    // schedule a job
+    // counter (optional) is incremented now and decremented when the job is done
+    // the job starts only when dependency (optional) is done
+    void run(std::function<void()> function, JobCounter* counter = nullptr, JobCounter* dependency = nullptr);
+
+    // ------------------------------------------------------------------------
+    // execute jobs until the counter is done
+    void wait(JobCounter& counter);
+
+    // ------------------------------------------------------------------------
+    // call body(begin, end) on sub-ranges of [begin, end[ in parallel and wait
+    // The range is split lazily: a part is given to the other threads only
+    // when the current thread has no job waiting in its deque (the other
+    // threads have stolen them). grain is the smallest sub-range
+    // (0 = chosen from the size of the range and the number of threads).
+    void parallelFor(int begin, int end, const std::function<void(int, int)>& body, int grain = 0);
+
+    // ------------------------------------------------------------------------
+    // number of threads executing jobs (workers + calling thread)
+    int threadCount() const { return int(m_workers.size()) + 1; }
+
+    // ------------------------------------------------------------------------
+    // counters (since the start)
+    uint64_t executedJobs() const { return m_executed.load(std::memory_order_relaxed); }
+    uint64_t stolenJobs() const { return m_stolen.load(std::memory_order_relaxed); }
+
+private:
+    explicit JobSystem(int workers);
+
+    // Chase-Lev deque with a fixed capacity
+    // push/pop: owner thread only, steal: any thread
+    class WorkQueue
+    {
+    public:
+        static const int64_t Capacity = 1 << 12;
+
+        bool push(Job* job);
+        Job* pop();
+        Job* steal();
+        bool empty() const;
+
+    private:
+        alignas(64) std::atomic<int64_t> m_top{ 0 };
+        alignas(64) std::atomic<int64_t> m_bottom{ 0 };
+        std::atomic<Job*> m_jobs[Capacity];
+    };
+
+    void workerLoop(int index);
+    void submit(Job* job);
+    Job* findJob(int index);
+    void execute(Job* job);
+    void finish(JobCounter* counter);
+    void wakeWorkers();
+    bool hasWork() const;
+    bool localQueueEmpty() const;
+
+    // Sub-range of a parallelFor
+    struct ParallelRange
+    {
+        JobSystem* system;
+        const std::function<void(int, int)>* body;
+        JobCounter* counter;
+        int grain;
+
+        void execute(int begin, int end) const;
+    };
+
+private:
+    std::vector<std::thread> m_workers;
+    // Index 0 = thread that created the instance, 1..n = workers
+    std::vector<std::unique_ptr<WorkQueue>> m_queues;
+
+    // Jobs of the threads without deque (and of the full deques)
+    mutable std::mutex m_sharedMutex;
+    std::deque<Job*> m_shared;
+    std::atomic<int> m_sharedCount{ 0 };
+
+    // Sleeping workers
+    std::mutex m_sleepMutex;
+    std::condition_variable m_wake;
+    std::atomic<int> m_sleeping{ 0 };
+    std::atomic<bool> m_stop{ false };
+
+    std::atomic<uint64_t> m_executed{ 0 };
+    std::atomic<uint64_t> m_stolen{ 0 };
+};
@@ -1,5 +1,9 @@
 #include "OBJLoader.h"
+#include "CpuProfiler.h"
+#include "JobSystem.h"
 
+#include <algorithm>
+#include <cmath>
 #include <fstream>
 #include <iostream>
 #include <sstream>
@@ -23,6 +27,73 @@ namespace
     float x,y;
   };
 
+  // Indices of the vertices of a face (0 = not specified)
+  struct Face
+  {
+    std::vector<unsigned int> vertexIDs;
+    std::vector<unsigned int> uvIDs;
+    std::vector<unsigned int> normalIDs;
+    std::size_t mesh = 0;
+  };
+
+  // Parse a face line ("f v/vt/vn v/vt/vn ...")
+  void parseFace(const std::string& line, Face& face)
+  {
+    std::string vertexData;
+    std::stringstream ssLine(line.substr(2));
+    while (std::getline(ssLine, vertexData, ' '))
+    {
+      std::size_t index = face.vertexIDs.size();
+      face.vertexIDs.push_back(0);
+      face.uvIDs.push_back(0);
+      face.normalIDs.push_back(0);
+
+      std::stringstream ss(vertexData);
+      std::string stringVal;
+      std::getline(ss, stringVal, '/');
+      std::stringstream ss2(stringVal);
+      ss2 >> face.vertexIDs[index];
+
+      std::getline(ss, stringVal, '/');
+      std::stringstream ss3(stringVal);
+      ss3 >> face.uvIDs[index];
+
+      std::getline(ss, stringVal, '/');
+      std::stringstream ss4(stringVal);
+      ss4 >> face.normalIDs[index];
+    }
+  }
+
+  // Compute the bounding box and the bounding sphere of a mesh
+  void computeBounds(Mesh& mesh)
+  {
+    for (int c=0; c<3; ++c)
+    {
+      mesh.boundsMin[c] = mesh.vertices[0].position[c];
+      mesh.boundsMax[c] = mesh.vertices[0].position[c];
+    }
+    for (const Vertex& v : mesh.vertices)
+    {
+      for (int c=0; c<3; ++c)
+      {
+        mesh.boundsMin[c] = std::min(mesh.boundsMin[c], v.position[c]);
+        mesh.boundsMax[c] = std::max(mesh.boundsMax[c], v.position[c]);
+      }
+    }
+
+    float radius2 = 0;
+    for (int c=0; c<3; ++c)
+      mesh.center[c] = (mesh.boundsMin[c] + mesh.boundsMax[c]) * 0.5f;
+    for (const Vertex& v : mesh.vertices)
+    {
+      const float dx = v.position[0] - mesh.center[0];
+      const float dy = v.position[1] - mesh.center[1];
+      const float dz = v.position[2] - mesh.center[2];
+      radius2 = std::max(radius2, dx*dx + dy*dy + dz*dz);
+    }
+    mesh.radius = std::sqrt(radius2);
+  }
+
   // Extract path from a string
   std::string extractPath(const std::string& filepathname)
   {
@@ -54,6 +125,8 @@ Loader::~Loader()
 // Load file
 bool Loader::loadFile(const std::string& filename)
 {
+  PROFILE_SCOPE("OBJLoader::loadFile");
+
   // Clear current data
   unload();
 
@@ -87,15 +160,22 @@ bool Loader::loadFile(const std::string& filename)
 
   std::size_t currentMesh = 0;
 
-  // Create vertices' position, normal, and uv lists with default values
-  std::vector<Point3D> vertices(1);
-  std::vector<Point3D> normals(1);
-  std::vector<Point2D> uvs(1);
+  // Read the whole file: the lines are parsed in parallel
+  std::vector<std::string> lines;
+  {
+    std::string line;
+    while (std::getline(file, line))
+      lines.push_back(line);
+  }
 
-  // Read file
-  std::string line;
-  while (std::getline(file, line))
+  // First pass (sequential): groups, materials and destination of each
+  // vertex, normal, tex coord and face
+  std::vector<int> slots(lines.size(), -1);
+  std::vector<Face> faces;
+  int vertexCount = 1, normalCount = 1, uvCount = 1;
+  for (std::size_t l=0; l<lines.size(); ++l)
   {
+    const std::string& line = lines[l];
     if (line[0] == '#')
     {
       // Comments... just ignore the line
@@ -103,28 +183,18 @@ bool Loader::loadFile(const std::string& filename)
     }
     else if (line[0] == 'v' && line[1] == ' ')
     {
-      // Vertex! Add it to the list.
-      Point3D v;
-      std::stringstream ss(line.substr(2));
-      ss >> v.x >> v.y >> v.z;
-      vertices.push_back(v);
-
+      // Vertex! Reserve its place in the list
+      slots[l] = vertexCount++;
     }
     else if (line[0] == 'v' && line[1] == 'n')
     {
-      // Normal! Add it to the list.
-      Point3D n;
-      std::stringstream ss(line.substr(3));
-      ss >> n.x >> n.y >> n.z;
-      normals.push_back(n);
+      // Normal! Reserve its place in the list
+      slots[l] = normalCount++;
     }
     else if (line[0] == 'v' && line[1] == 't')
     {
-      // Tex coord! Add it to the list
-      Point2D uv;
-      std::stringstream ss(line.substr(3));
-      ss >> uv.x >> uv.y;
-      uvs.push_back(uv);
+      // Tex coord! Reserve its place in the list
+      slots[l] = uvCount++;
     }
     else if (line[0] == 'u')
     {
@@ -151,98 +221,10 @@ bool Loader::loadFile(const std::string& filename)
     }
     else if (line[0] == 'f')
     {
-      // Face! First, get its vertices data
-      std::string vertexData;
-      std::string dummy;
-      std::stringstream ssLine(line.substr(2));
-      std::vector<unsigned int> vertexIDs;
-      std::vector<unsigned int> uvIDs;
-      std::vector<unsigned int> normalIDs;
-      while (std::getline(ssLine, vertexData, ' '))
-      {
-        std::size_t index = vertexIDs.size();
-        vertexIDs.push_back(0);
-        uvIDs.push_back(0);
-        normalIDs.push_back(0);
-
-        std::stringstream ss(vertexData);
-        std::string stringVal;
-        std::getline(ss, stringVal, '/');
-        std::stringstream ss2(stringVal);
-        ss2 >> vertexIDs[index];
-
-        std::getline(ss, stringVal, '/');
-        std::stringstream ss3(stringVal);
-        ss3 >> uvIDs[index];
-
-        std::getline(ss, stringVal, '/');
-        std::stringstream ss4(stringVal);
-        ss4 >> normalIDs[index];
-      }
-
-      // Create first triangle
-      if (vertexIDs.size() < 3)
-        continue;
-
-      for (unsigned int i=0; i<3; ++i)
-      {
-        Vertex v;
-        v.position[0] = vertices[vertexIDs[i]].x;
-        v.position[1] = vertices[vertexIDs[i]].y;
-        v.position[2] = vertices[vertexIDs[i]].z;
-
-        v.normal[0] = normals[normalIDs[i]].x;
-        v.normal[1] = normals[normalIDs[i]].y;
-        v.normal[2] = normals[normalIDs[i]].z;
-
-        v.uv[0] = uvs[uvIDs[i]].x;
-        v.uv[1] = uvs[uvIDs[i]].y;
-
-        _meshes[currentMesh].vertices.push_back(v);
-      }
-
-      // Create subsequent triangles (1 per additional vertices)
-      // Note: These triangles are created using a triangle fan approach
-      for (unsigned int i=3; i<vertexIDs.size(); ++i)
-      {
-        // First vertex of triangle is always the first vertex that has been specified
-        Vertex v1;
-        v1.position[0] = vertices[vertexIDs[0]].x;
-        v1.position[1] = vertices[vertexIDs[0]].y;
-        v1.position[2] = vertices[vertexIDs[0]].z;
-        v1.normal[0] = normals[normalIDs[0]].x;
-        v1.normal[1] = normals[normalIDs[0]].y;
-        v1.normal[2] = normals[normalIDs[0]].z;
-        v1.uv[0] = uvs[uvIDs[0]].x;
-        v1.uv[1] = uvs[uvIDs[0]].y;
-
-        // Second vertex is the previous vertex
-        Vertex v2;
-        v2.position[0] = vertices[vertexIDs[i-1]].x;
-        v2.position[1] = vertices[vertexIDs[i-1]].y;
-        v2.position[2] = vertices[vertexIDs[i-1]].z;
-        v2.normal[0] = normals[normalIDs[i-1]].x;
-        v2.normal[1] = normals[normalIDs[i-1]].y;
-        v2.normal[2] = normals[normalIDs[i-1]].z;
-        v2.uv[0] = uvs[uvIDs[i-1]].x;
-        v2.uv[1] = uvs[uvIDs[i-1]].y;
-
-        // Third vertex is the current vertex
-        Vertex v3;
-        v3.position[0] = vertices[vertexIDs[i]].x;
-        v3.position[1] = vertices[vertexIDs[i]].y;
-        v3.position[2] = vertices[vertexIDs[i]].z;
-        v3.normal[0] = normals[normalIDs[i]].x;
-        v3.normal[1] = normals[normalIDs[i]].y;
-        v3.normal[2] = normals[normalIDs[i]].z;
-        v3.uv[0] = uvs[uvIDs[i]].x;
-        v3.uv[1] = uvs[uvIDs[i]].y;
-
-        // Add the triangle
-        _meshes[currentMesh].vertices.push_back(v1);
-        _meshes[currentMesh].vertices.push_back(v2);
-        _meshes[currentMesh].vertices.push_back(v3);
-      }
+      // Face! Remember its mesh, it is parsed later
+      slots[l] = int(faces.size());
+      faces.push_back(Face());
+      faces.back().mesh = currentMesh;
     }
     else if (line[0] == 'm')
     {
@@ -266,6 +248,82 @@ bool Loader::loadFile(const std::string& filename)
     }
   }
 
+  // Create vertices' position, normal, and uv lists with default values
+  std::vector<Point3D> vertices(vertexCount);
+  std::vector<Point3D> normals(normalCount);
+  std::vector<Point2D> uvs(uvCount);
+
+  // Second pass (parallel): parse the numbers, each line has its own slot
+  JobSystem::instance().parallelFor(0, int(lines.size()), [&](int begin, int end) {
+    for (int l=begin; l<end; ++l)
+    {
+      if (slots[l] < 0)
+        continue;
+      const std::string& line = lines[l];
+      if (line[0] == 'v' && line[1] == ' ')
+      {
+        Point3D& v = vertices[slots[l]];
+        std::stringstream ss(line.substr(2));
+        ss >> v.x >> v.y >> v.z;
+      }
+      else if (line[0] == 'v' && line[1] == 'n')
+      {
+        Point3D& n = normals[slots[l]];
+        std::stringstream ss(line.substr(3));
+        ss >> n.x >> n.y >> n.z;
+      }
+      else if (line[0] == 'v' && line[1] == 't')
+      {
+        Point2D& uv = uvs[slots[l]];
+        std::stringstream ss(line.substr(3));
+        ss >> uv.x >> uv.y;
+      }
+      else
+      {
+        parseFace(line, faces[slots[l]]);
+      }
+    }
+  });
+
+  // Third pass (sequential): create the triangles in the order of the file
+  for (const Face& face : faces)
+  {
+    // Create first triangle
+    if (face.vertexIDs.size() < 3)
+      continue;
+
+    auto makeVertex = [&](std::size_t i) {
+      Vertex v;
+      v.position[0] = vertices[face.vertexIDs[i]].x;
+      v.position[1] = vertices[face.vertexIDs[i]].y;
+      v.position[2] = vertices[face.vertexIDs[i]].z;
+
+      v.normal[0] = normals[face.normalIDs[i]].x;
+      v.normal[1] = normals[face.normalIDs[i]].y;
+      v.normal[2] = normals[face.normalIDs[i]].z;
+
+      v.uv[0] = uvs[face.uvIDs[i]].x;
+      v.uv[1] = uvs[face.uvIDs[i]].y;
+      return v;
+    };
+
+    std::vector<Vertex>& meshVertices = _meshes[face.mesh].vertices;
+    for (unsigned int i=0; i<3; ++i)
+      meshVertices.push_back(makeVertex(i));
+
+    // Create subsequent triangles (1 per additional vertices)
+    // Note: These triangles are created using a triangle fan approach
+    for (unsigned int i=3; i<face.vertexIDs.size(); ++i)
+    {
+      // First vertex of triangle is always the first vertex that has been specified
+      meshVertices.push_back(makeVertex(0));
+      // Second vertex is the previous vertex
+      meshVertices.push_back(makeVertex(i-1));
+      // Third vertex is the current vertex
+      meshVertices.push_back(makeVertex(i));
+    }
+  }
+
   // Everything is loaded! Now remove empty meshes (this generally happens with the default group)
   std::vector<Mesh>::iterator it = _meshes.begin();
   while (it != _meshes.end())
@@ -276,6 +334,7 @@ bool Loader::loadFile(const std::string& filename)
     }
     else
     {
+      computeBounds(*it);
       ++it;
     }
   }
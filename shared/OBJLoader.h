@@ -30,11 +30,17 @@ namespace OBJLoader
   // Each triplet of vertices forms a triangle.
   struct Mesh
   {
-    Mesh() : materialID(0), name("") {}
+    Mesh() : materialID(0), name(""), boundsMin{0, 0, 0}, boundsMax{0, 0, 0}, center{0, 0, 0}, radius(0) {}
 
     std::vector<Vertex> vertices;
     std::size_t  materialID;
     std::string   name;
+
+    // Bounding volumes (computed at load, used for the frustum culling)
+    float boundsMin[3]; // Axis aligned bounding box
+    float boundsMax[3];
+    float center[3];    // Bounding sphere (centered on the box)
+    float radius;
   };
 
   // Class responsible for loading all the meshes included in an OBJ file
@@ -0,0 +1,188 @@
+#include "OnDemandRendering.h"
+#include "Benchmark.h"
+
+#include <GLFW/glfw3.h>
+#include <imgui.h>
+
+#include <algorithm>
+
+namespace
+{
+    // Tracked instance (the GLFW callbacks have no user data,
+    // the window user pointer is used by the examples)
+    OnDemandRendering* g_instance = nullptr;
+
+    // Previous callbacks (example and ImGui backend)
+    GLFWkeyfun g_previousKey = nullptr;
+    GLFWcharfun g_previousChar = nullptr;
+    GLFWmousebuttonfun g_previousMouseButton = nullptr;
+    GLFWcursorposfun g_previousCursorPos = nullptr;
+    GLFWcursorenterfun g_previousCursorEnter = nullptr;
+    GLFWscrollfun g_previousScroll = nullptr;
+    GLFWframebuffersizefun g_previousFramebufferSize = nullptr;
+    GLFWwindowrefreshfun g_previousWindowRefresh = nullptr;
+    GLFWwindowfocusfun g_previousWindowFocus = nullptr;
+
+    // ImGui needs a few frames to settle after an input (hover, open popups, ...)
+    const int InputFrames = 3;
+}
+
+void OnDemandRendering::install(GLFWwindow* window)
+{
+    m_window = window;
+    g_instance = this;
+    g_previousKey = glfwSetKeyCallback(window, keyCallback);
+    g_previousChar = glfwSetCharCallback(window, charCallback);
+    g_previousMouseButton = glfwSetMouseButtonCallback(window, mouseButtonCallback);
+    g_previousCursorPos = glfwSetCursorPosCallback(window, cursorPosCallback);
+    g_previousCursorEnter = glfwSetCursorEnterCallback(window, cursorEnterCallback);
+    g_previousScroll = glfwSetScrollCallback(window, scrollCallback);
+    g_previousFramebufferSize = glfwSetFramebufferSizeCallback(window, framebufferSizeCallback);
+    g_previousWindowRefresh = glfwSetWindowRefreshCallback(window, windowRefreshCallback);
+    g_previousWindowFocus = glfwSetWindowFocusCallback(window, windowFocusCallback);
+}
+
+bool OnDemandRendering::waitEvents()
+{
+    // Continuous: benchmark, keys held down (the camera reads the key states)
+    if (!enabled || Benchmark::settings().frames > 0 || m_keysDown > 0)
+    {
+        glfwPollEvents();
+        raiseFrames(1);
+        m_imguiFrames = std::max(m_imguiFrames, 1);
+        return true;
+    }
+
+    if (m_frames > 0)
+    {
+        glfwPollEvents();
+        return true;
+    }
+
+    glfwWaitEventsTimeout(timeout);
+    if (m_frames > 0)
+        return true;
+
+    // Woken up by the timeout (or an event without effect)
+    m_idleWakeups++;
+    if (ImGui::GetCurrentContext() && ImGui::GetIO().WantTextInput)
+    {
+        // Blinking text cursor
+        m_imguiFrames = std::max(m_imguiFrames, 1);
+        raiseFrames(1);
+        return true;
+    }
+    return false;
+}
+
+void OnDemandRendering::requestRedraw(int frames)
+{
+    raiseFrames(frames);
+    // Wake up glfwWaitEventsTimeout (thread-safe)
+    glfwPostEmptyEvent();
+}
+
+void OnDemandRendering::endFrame()
+{
+    if (m_imguiFrames == 0)
+        m_reusedImguiFrames++;
+    m_drawnFrames++;
+    int frames = m_frames.load();
+    while (frames > 0 && !m_frames.compare_exchange_weak(frames, frames - 1))
+    {
+    }
+    m_imguiFrames = std::max(m_imguiFrames - 1, 0);
+}
+
+void OnDemandRendering::drawImgui()
+{
+    ImGui::Checkbox("On-demand rendering", &enabled);
+    ImGui::Text("Frames drawn: %llu (ImGui reused: %llu), idle wake-ups: %llu",
+        (unsigned long long)m_drawnFrames, (unsigned long long)m_reusedImguiFrames,
+        (unsigned long long)m_idleWakeups);
+}
+
+void OnDemandRendering::raiseFrames(int frames)
+{
+    int current = m_frames.load();
+    while (current < frames && !m_frames.compare_exchange_weak(current, frames))
+    {
+    }
+}
+
+void OnDemandRendering::onInput(int frames)
+{
+    raiseFrames(frames);
+    m_imguiFrames = std::max(m_imguiFrames, frames);
+}
+
+// ----------------------------------------------------------------------------
+void OnDemandRendering::keyCallback(GLFWwindow* window, int key, int scancode, int action, int mods)
+{
+    if (g_previousKey)
+        g_previousKey(window, key, scancode, action, mods);
+    if (action == GLFW_PRESS)
+        g_instance->m_keysDown++;
+    else if (action == GLFW_RELEASE)
+        g_instance->m_keysDown = std::max(g_instance->m_keysDown - 1, 0);
+    g_instance->onInput(InputFrames);
+}
+
+void OnDemandRendering::charCallback(GLFWwindow* window, unsigned int c)
+{
+    if (g_previousChar)
+        g_previousChar(window, c);
+    g_instance->onInput(InputFrames);
+}
+
+void OnDemandRendering::mouseButtonCallback(GLFWwindow* window, int button, int action, int mods)
+{
+    if (g_previousMouseButton)
+        g_previousMouseButton(window, button, action, mods);
+    g_instance->onInput(InputFrames);
+}
+
+void OnDemandRendering::cursorPosCallback(GLFWwindow* window, double x, double y)
+{
+    if (g_previousCursorPos)
+        g_previousCursorPos(window, x, y);
+    g_instance->onInput(InputFrames);
+}
+
+void OnDemandRendering::cursorEnterCallback(GLFWwindow* window, int entered)
+{
+    if (g_previousCursorEnter)
+        g_previousCursorEnter(window, entered);
+    g_instance->onInput(InputFrames);
+}
+
+void OnDemandRendering::scrollCallback(GLFWwindow* window, double x, double y)
+{
+    if (g_previousScroll)
+        g_previousScroll(window, x, y);
+    g_instance->onInput(InputFrames);
+}
+
+void OnDemandRendering::framebufferSizeCallback(GLFWwindow* window, int width, int height)
+{
+    if (g_previousFramebufferSize)
+        g_previousFramebufferSize(window, width, height);
+    g_instance->onInput(InputFrames);
+}
+
+void OnDemandRendering::windowRefreshCallback(GLFWwindow* window)
+{
+    if (g_previousWindowRefresh)
+        g_previousWindowRefresh(window);
+    g_instance->onInput(1);
+}
+
+void OnDemandRendering::windowFocusCallback(GLFWwindow* window, int focused)
+{
+    if (g_previousWindowFocus)
+        g_previousWindowFocus(window, focused);
+    // The releases are not received when the window loses the focus
+    if (!focused)
+        g_instance->m_keysDown = 0;
+    g_instance->onInput(InputFrames);
+}
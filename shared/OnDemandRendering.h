@@ -0,0 +1,91 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+struct GLFWwindow;
+
+// On-demand rendering for the static viewers
+// Instead of drawing at full rate, the render loop sleeps inside
+// glfwWaitEventsTimeout and draws a frame only when something changed:
+// inputs (keyboard, mouse, resize, expose), ImGui interaction, animation or
+// resource loading (requestRedraw). When only the scene changed, the ImGui
+// draw data of the previous frame is drawn again (no new ImGui frame).
+// The benchmark mode (Benchmark.h) always draws continuously.
+//
+// Usage:
+//   m_onDemand.install(m_window); // After the callbacks of the example and ImGui
+//   while (!glfwWindowShouldClose(m_window)) {
+//       if (!m_onDemand.waitEvents()) // Replace glfwPollEvents
+//           continue;
+//       ... draw the scene ...
+//       if (m_onDemand.imguiNeedsUpdate()) { ... new ImGui frame ... }
+//       else ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+//       glfwSwapBuffers(m_window);
+//       m_onDemand.endFrame();
+//   }
+class OnDemandRendering
+{
+public:
+    // ------------------------------------------------------------------------
+    // install the GLFW callbacks that detect the inputs
+    // The previous callbacks (example, ImGui) are still called.
+    // Only one window can be tracked.
+    void install(GLFWwindow* window);
+
+    // ------------------------------------------------------------------------
+    // process the events: wait for them (on demand) or poll them (continuous)
+    // return true if a frame needs to be drawn
+    bool waitEvents();
+
+    // ------------------------------------------------------------------------
+    // something changed outside of the inputs (animation, loaded resource, ...)
+    // Can be called by any thread (e.g. a loading worker)
+    void requestRedraw(int frames = 1);
+
+    // ------------------------------------------------------------------------
+    // false if the ImGui draw data of the previous frame can be drawn again
+    bool imguiNeedsUpdate() const { return m_imguiFrames > 0; }
+
+    // ------------------------------------------------------------------------
+    // end of the drawn frame
+    void endFrame();
+
+    // ------------------------------------------------------------------------
+    // controls and counters (inside the current ImGui window)
+    void drawImgui();
+
+    bool enabled = true;
+    // Maximum wait (s), the text cursor of ImGui blinks at this rate
+    double timeout = 0.5;
+
+private:
+    // Called by the GLFW callbacks
+    void onInput(int frames);
+    // m_frames = max(m_frames, frames) (atomic, see requestRedraw)
+    void raiseFrames(int frames);
+
+    static void keyCallback(GLFWwindow* window, int key, int scancode, int action, int mods);
+    static void charCallback(GLFWwindow* window, unsigned int c);
+    static void mouseButtonCallback(GLFWwindow* window, int button, int action, int mods);
+    static void cursorPosCallback(GLFWwindow* window, double x, double y);
+    static void cursorEnterCallback(GLFWwindow* window, int entered);
+    static void scrollCallback(GLFWwindow* window, double x, double y);
+    static void framebufferSizeCallback(GLFWwindow* window, int width, int height);
+    static void windowRefreshCallback(GLFWwindow* window);
+    static void windowFocusCallback(GLFWwindow* window, int focused);
+
+private:
+    GLFWwindow* m_window = nullptr;
+    // Number of frames still to draw (scene and ImGui)
+    // m_frames is atomic: requestRedraw can be called by the other threads,
+    // the rest is only used by the thread of the render loop
+    std::atomic<int> m_frames{ 3 };
+    int m_imguiFrames = 3;
+    // Keys held down: the examples read the key states at each frame
+    int m_keysDown = 0;
+
+    uint64_t m_drawnFrames = 0;
+    uint64_t m_reusedImguiFrames = 0;
+    uint64_t m_idleWakeups = 0;
+};
@@ -0,0 +1,162 @@
+#include "RadixSort.h"
+#include "JobSystem.h"
+#include "CpuProfiler.h"
+
+#include <algorithm>
+
+namespace
+{
+    // Smallest chunk given to a thread (smaller arrays: one chunk)
+    const std::size_t MinChunkSize = 16384;
+
+    uint64_t pair(uint32_t key, uint32_t value) { return (uint64_t(key) << 32) | value; }
+    uint32_t pairKey(uint64_t p) { return uint32_t(p >> 32); }
+    uint32_t pairValue(uint64_t p) { return uint32_t(p); }
+}
+
+int RadixSort::chunkCount(std::size_t count) const
+{
+    // A few chunks per thread: the threads that finish early steal the others.
+    // A single thread uses one chunk: the digits counted in the first read of
+    // the keys stay valid for all the passes.
+    const int threads = JobSystem::instance().threadCount();
+    if (threads == 1)
+        return 1;
+    const std::size_t chunks = std::min<std::size_t>(threads * 4, count / MinChunkSize);
+    return int(std::max<std::size_t>(1, chunks));
+}
+
+// ----------------------------------------------------------------------------
+const std::vector<uint32_t>& RadixSort::sort(const uint32_t* keys, std::size_t count)
+{
+    PROFILE_SCOPE("RadixSort");
+    JobSystem& jobs = JobSystem::instance();
+    m_pairs[0].resize(count);
+    m_pairs[1].resize(count);
+    m_order.resize(count);
+    const int chunks = chunkCount(count);
+    m_histograms.assign(std::size_t(chunks) * Passes * Buckets, 0);
+    auto chunkBegin = [count, chunks](int chunk) { return count * chunk / chunks; };
+    auto histogram = [this](int chunk, int pass) { return &m_histograms[(std::size_t(chunk) * Passes + pass) * Buckets]; };
+    auto digit = [](uint32_t key, int pass) { return (key >> (pass * DigitBits)) & (Buckets - 1); };
+
+    // Digits of all the passes in a single read of the keys
+    // (with several chunks, the counts are valid for the first executed pass)
+    jobs.parallelFor(0, chunks, [&](int begin, int end) {
+        for (int chunk = begin; chunk < end; ++chunk)
+        {
+            uint32_t* h0 = histogram(chunk, 0);
+            uint32_t* h1 = histogram(chunk, 1);
+            uint32_t* h2 = histogram(chunk, 2);
+            for (std::size_t i = chunkBegin(chunk); i < chunkBegin(chunk + 1); ++i)
+            {
+                const uint32_t key = keys[i];
+                h0[digit(key, 0)]++;
+                h1[digit(key, 1)]++;
+                h2[digit(key, 2)]++;
+            }
+        }
+    }, 1);
+
+    // Passes to execute (a digit that is the same for all the keys does not move anything)
+    bool execute[Passes];
+    int first = -1, last = -1;
+    for (int pass = 0; pass < Passes; ++pass)
+    {
+        execute[pass] = true;
+        for (int d = 0; d < Buckets; ++d)
+        {
+            std::size_t total = 0;
+            for (int chunk = 0; chunk < chunks; ++chunk)
+                total += histogram(chunk, pass)[d];
+            if (total == count)
+                execute[pass] = false;
+        }
+        if (execute[pass])
+        {
+            if (first < 0)
+                first = pass;
+            last = pass;
+        }
+    }
+
+    // All the keys are equal: the order does not change
+    if (first < 0)
+    {
+        for (std::size_t i = 0; i < count; ++i)
+            m_order[i] = uint32_t(i);
+        return m_order;
+    }
+
+    // The (key, index) pairs move together: the first pass reads the keys, the
+    // last one writes only the indices
+    const uint64_t* src = nullptr;
+    int dst = 0;
+    for (int pass = first; pass <= last; ++pass)
+    {
+        if (!execute[pass])
+            continue;
+
+        // Counts of the digit in the current order
+        if (pass != first && chunks > 1)
+        {
+            jobs.parallelFor(0, chunks, [&](int begin, int end) {
+                for (int chunk = begin; chunk < end; ++chunk)
+                {
+                    uint32_t* h = histogram(chunk, pass);
+                    std::fill(h, h + Buckets, 0u);
+                    for (std::size_t i = chunkBegin(chunk); i < chunkBegin(chunk + 1); ++i)
+                        h[digit(pairKey(src[i]), pass)]++;
+                }
+            }, 1);
+        }
+
+        // Offsets: digit major, then chunk (stable)
+        uint32_t offset = 0;
+        for (int d = 0; d < Buckets; ++d)
+        {
+            for (int chunk = 0; chunk < chunks; ++chunk)
+            {
+                uint32_t& h = histogram(chunk, pass)[d];
+                const uint32_t n = h;
+                h = offset;
+                offset += n;
+            }
+        }
+
+        // Scatter
+        uint64_t* dstPairs = m_pairs[dst].data();
+        uint32_t* order = m_order.data();
+        jobs.parallelFor(0, chunks, [&, src, pass](int begin, int end) {
+            for (int chunk = begin; chunk < end; ++chunk)
+            {
+                uint32_t* h = histogram(chunk, pass);
+                const std::size_t chunkEnd = chunkBegin(chunk + 1);
+                if (pass == first && pass == last)
+                {
+                    for (std::size_t i = chunkBegin(chunk); i < chunkEnd; ++i)
+                        order[h[digit(keys[i], pass)]++] = uint32_t(i);
+                }
+                else if (pass == first)
+                {
+                    for (std::size_t i = chunkBegin(chunk); i < chunkEnd; ++i)
+                        dstPairs[h[digit(keys[i], pass)]++] = pair(keys[i], uint32_t(i));
+                }
+                else if (pass == last)
+                {
+                    for (std::size_t i = chunkBegin(chunk); i < chunkEnd; ++i)
+                        order[h[digit(pairKey(src[i]), pass)]++] = pairValue(src[i]);
+                }
+                else
+                {
+                    for (std::size_t i = chunkBegin(chunk); i < chunkEnd; ++i)
+                        dstPairs[h[digit(pairKey(src[i]), pass)]++] = src[i];
+                }
+            }
+        }, 1);
+
+        src = dstPairs;
+        dst = 1 - dst;
+    }
+    return m_order;
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+// Parallel LSD radix sort of 32-bit keys (3 passes of 11 bits, stable)
+// The keys are precomputed once (no comparison function), the result is the
+// order of the elements. Each pass counts the digits per chunk of the array,
+// then scatters the chunks at their offsets: both steps use the JobSystem.
+// The keys and the indices move together as 64-bit pairs (one store per
+// element), the elements themselves are gathered once by the caller.
+// A pass is skipped when all the keys have the same digit (ex: high bits of
+// close float values).
+//
+// Usage:
+//   for (i ...) keys[i] = RadixSort::floatKey(-distance2[i]); // Far to near
+//   const std::vector<uint32_t>& order = m_sorter.sort(keys.data(), keys.size());
+//   for (i ...) sorted[i] = particles[order[i]];
+//
+// A RadixSort object keeps its buffers between the calls (no allocation in the
+// steady state) and must be used by one thread at a time.
+class RadixSort
+{
+public:
+    // ------------------------------------------------------------------------
+    // key with the same order than the float values (negative values included)
+    static uint32_t floatKey(float value)
+    {
+        uint32_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        return (bits & 0x80000000u) ? ~bits : (bits | 0x80000000u);
+    }
+
+    // ------------------------------------------------------------------------
+    // sort the indices [0, count[ by increasing key
+    // return the sorted indices (valid until the next call)
+    const std::vector<uint32_t>& sort(const uint32_t* keys, std::size_t count);
+
+private:
+    static const int Passes = 3;
+    static const int DigitBits = 11;
+    static const int Buckets = 1 << DigitBits;
+
+    int chunkCount(std::size_t count) const;
+
+private:
+    // (key << 32 | index) between the passes
+    std::vector<uint64_t> m_pairs[2];
+    std::vector<uint32_t> m_order;
+    // Digit counts, then offsets: [chunk][pass][digit]
+    std::vector<uint32_t> m_histograms;
+};
@@ -0,0 +1,134 @@
+#include "Random.h"
+#include "RandomLanes.h"
+
+namespace
+{
+    using CpuFeatures::Level;
+#ifdef SIMD_SSE2
+    using RandomLanes::value4;
+    using RandomLanes::unit4;
+#endif
+#ifdef SIMD_AVX2
+    using RandomLanes::value8;
+    using RandomLanes::unit8;
+#endif
+
+    // ------------------------------------------------------------------------
+    // Scalar (reference)
+    void fillScalar(uint32_t key, uint32_t counter, float* values, std::size_t begin, std::size_t end, float min, float scale)
+    {
+        for (std::size_t i = begin; i < end; ++i)
+            values[i] = min + scale * Random::uniform(key, counter + uint32_t(i));
+    }
+
+    void fillScalar(uint32_t key, uint32_t counter, uint32_t* values, std::size_t begin, std::size_t end)
+    {
+        for (std::size_t i = begin; i < end; ++i)
+            values[i] = Random::value(key, counter + uint32_t(i));
+    }
+
+#ifdef SIMD_SSE2
+    // ------------------------------------------------------------------------
+    // SSE2 (4 values at a time)
+    template <typename Store>
+    std::size_t fillSSE2(uint32_t key, uint32_t counter, std::size_t count, Store store)
+    {
+        __m128i x = _mm_add_epi32(_mm_set1_epi32(int(counter)), _mm_setr_epi32(0, 1, 2, 3));
+        std::size_t i = 0;
+        for (; i + 4 <= count; i += 4)
+        {
+            store(i, value4(x, key));
+            x = _mm_add_epi32(x, _mm_set1_epi32(4));
+        }
+        return i;
+    }
+#endif
+
+#ifdef SIMD_AVX2
+    // ------------------------------------------------------------------------
+    // AVX2 (8 values at a time)
+    SIMD_AVX2_TARGET
+    std::size_t fillAVX2(uint32_t key, uint32_t counter, float* values, std::size_t count, float min, float scale)
+    {
+        const __m256 vmin = _mm256_set1_ps(min), vscale = _mm256_set1_ps(scale);
+        __m256i x = _mm256_add_epi32(_mm256_set1_epi32(int(counter)), _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7));
+        std::size_t i = 0;
+        for (; i + 8 <= count; i += 8)
+        {
+            const __m256 u = unit8(value8(x, key));
+            _mm256_storeu_ps(values + i, _mm256_add_ps(vmin, _mm256_mul_ps(vscale, u)));
+            x = _mm256_add_epi32(x, _mm256_set1_epi32(8));
+        }
+        return i;
+    }
+
+    SIMD_AVX2_TARGET
+    std::size_t fillAVX2(uint32_t key, uint32_t counter, uint32_t* values, std::size_t count)
+    {
+        __m256i x = _mm256_add_epi32(_mm256_set1_epi32(int(counter)), _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7));
+        std::size_t i = 0;
+        for (; i + 8 <= count; i += 8)
+        {
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(values + i), value8(x, key));
+            x = _mm256_add_epi32(x, _mm256_set1_epi32(8));
+        }
+        return i;
+    }
+#endif
+}
+
+// ----------------------------------------------------------------------------
+void Random::fill(uint32_t key, uint32_t counter, float* values, std::size_t count, float min, float max)
+{
+    const float scale = max - min;
+    std::size_t done = 0;
+    switch (CpuFeatures::level())
+    {
+#ifdef SIMD_AVX2
+    case Level::AVX2:
+        done = fillAVX2(key, counter, values, count, min, scale);
+        break;
+#endif
+#ifdef SIMD_SSE2
+    case Level::SSE2:
+    {
+        const __m128 vmin = _mm_set1_ps(min), vscale = _mm_set1_ps(scale);
+        done = fillSSE2(key, counter, count, [&](std::size_t i, __m128i bits) {
+            _mm_storeu_ps(values + i, _mm_add_ps(vmin, _mm_mul_ps(vscale, unit4(bits))));
+        });
+        break;
+    }
+#endif
+    default:
+        break;
+    }
+    fillScalar(key, counter, values, done, count, min, scale);
+}
+
+void Random::fill(uint32_t key, uint32_t counter, uint32_t* values, std::size_t count)
+{
+    std::size_t done = 0;
+    switch (CpuFeatures::level())
+    {
+#ifdef SIMD_AVX2
+    case Level::AVX2:
+        done = fillAVX2(key, counter, values, count);
+        break;
+#endif
+#ifdef SIMD_SSE2
+    case Level::SSE2:
+        done = fillSSE2(key, counter, count, [&](std::size_t i, __m128i bits) {
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(values + i), bits);
+        });
+        break;
+#endif
+    default:
+        break;
+    }
+    fillScalar(key, counter, values, done, count);
+}
+
+const char* Random::instructionSet()
+{
+    return CpuFeatures::name(CpuFeatures::level());
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Counter-based random numbers (PCG hashes, Jarzynski and Olano, "Hash
+// Functions for GPU Rendering", JCGT 2020)
+// A value only depends on a key (one per sequence) and on a counter (position
+// in the sequence): there is no shared state, any thread can compute any
+// element of any sequence and jumping ahead is free. shared/shaders/random.glsl
+// computes the same integers on the GPU.
+//
+// Usage:
+//   const uint32_t key = Random::key(seed, 3);             // Sequence 3 of the seed
+//   float life = Random::uniform(key, index, lifeMin, lifeMax);
+//   Random::fill(key, first, values, count, min, max);     // SIMD, values[i] = uniform(key, first + i, min, max)
+//
+//   Random generator(Random::key(seed, 0));                // Sequential use
+//   float x = generator.next(-1.0f, 1.0f);
+//   generator.skip(1000);
+class Random
+{
+public:
+    // ------------------------------------------------------------------------
+    // PCG hash of one value (bijection)
+    static uint32_t hash(uint32_t v)
+    {
+        const uint32_t state = v * 747796405u + 2891336453u;
+        const uint32_t word = ((state >> ((state >> 28u) + 4u)) ^ state) * 277803737u;
+        return (word >> 22u) ^ word;
+    }
+
+    // key of the sequence of a seed (independent sequences)
+    static uint32_t key(uint32_t seed, uint32_t sequence) { return hash(seed ^ hash(sequence)); }
+
+    // element of a sequence (pcg2d hash of (counter, key))
+    static uint32_t value(uint32_t key, uint32_t counter)
+    {
+        uint32_t x = counter * 1664525u + 1013904223u;
+        uint32_t y = key * 1664525u + 1013904223u;
+        x += y * 1664525u;
+        y += x * 1664525u;
+        x ^= x >> 16;
+        y ^= y >> 16;
+        x += y * 1664525u;
+        x ^= x >> 16;
+        return x;
+    }
+
+    // ------------------------------------------------------------------------
+    // [0, 1[ with 24 bits (exact in float)
+    static float unit(uint32_t bits) { return float(bits >> 8) * (1.0f / 16777216.0f); }
+    static float uniform(uint32_t key, uint32_t counter) { return unit(value(key, counter)); }
+    static float uniform(uint32_t key, uint32_t counter, float min, float max) { return min + (max - min) * uniform(key, counter); }
+
+    // ------------------------------------------------------------------------
+    // values[i] = uniform(key, counter + i, min, max), 8 (AVX2) or 4 (SSE2)
+    // values at a time, same results than uniform()
+    static void fill(uint32_t key, uint32_t counter, float* values, std::size_t count, float min = 0.0f, float max = 1.0f);
+    // values[i] = value(key, counter + i)
+    static void fill(uint32_t key, uint32_t counter, uint32_t* values, std::size_t count);
+
+    // instruction set used by fill: "AVX2", "SSE2" or "Scalar"
+    static const char* instructionSet();
+
+    // ------------------------------------------------------------------------
+    // sequential generator (a key and a counter)
+    explicit Random(uint32_t key = 0, uint32_t counter = 0) : m_key(key), m_counter(counter) {}
+
+    uint32_t next() { return value(m_key, m_counter++); }
+    float next(float min, float max) { return uniform(m_key, m_counter++, min, max); }
+    // jump ahead of n values
+    void skip(uint32_t n) { m_counter += n; }
+    uint32_t counter() const { return m_counter; }
+
+private:
+    uint32_t m_key;
+    uint32_t m_counter;
+};
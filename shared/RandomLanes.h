@@ -0,0 +1,73 @@
+#pragma once
+
+#include "CpuFeatures.h"
+
+#include <cstdint>
+
+// SIMD lanes of Random::value (pcg2d hash): 4 (SSE2) or 8 (AVX2) counters
+// of the same sequence at a time, same integers than Random::value.
+// Used by Random::fill and by the SIMD loops that need their own random
+// numbers (ex: masked respawn of the particles). The AVX2 functions must
+// only be called when CpuFeatures::level() is Level::AVX2.
+//
+// Usage:
+//   const __m256i counters = _mm256_add_epi32(_mm256_set1_epi32(int(i)), _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7));
+//   const __m256 u = RandomLanes::unit8(RandomLanes::value8(counters, key)); // Random::uniform(key, i + lane)
+namespace RandomLanes
+{
+#ifdef SIMD_SSE2
+    // ------------------------------------------------------------------------
+    // SSE2 (4 values at a time)
+    // Low 32 bits of the products (SSE2 only multiplies 2 lanes at a time)
+    inline __m128i mullo4(__m128i a, __m128i b)
+    {
+        const __m128i even = _mm_mul_epu32(a, b);
+        const __m128i odd = _mm_mul_epu32(_mm_srli_epi64(a, 32), _mm_srli_epi64(b, 32));
+        return _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)), _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)));
+    }
+
+    // Same as Random::value, y only depends on the key (computed once)
+    inline __m128i value4(__m128i x, uint32_t key)
+    {
+        const __m128i m = _mm_set1_epi32(1664525);
+        x = _mm_add_epi32(mullo4(x, m), _mm_set1_epi32(1013904223));
+        __m128i y = _mm_set1_epi32(int(key * 1664525u + 1013904223u));
+        x = _mm_add_epi32(x, mullo4(y, m));
+        y = _mm_add_epi32(y, mullo4(x, m));
+        x = _mm_xor_si128(x, _mm_srli_epi32(x, 16));
+        y = _mm_xor_si128(y, _mm_srli_epi32(y, 16));
+        x = _mm_add_epi32(x, mullo4(y, m));
+        return _mm_xor_si128(x, _mm_srli_epi32(x, 16));
+    }
+
+    // Same as Random::unit
+    inline __m128 unit4(__m128i bits)
+    {
+        return _mm_mul_ps(_mm_cvtepi32_ps(_mm_srli_epi32(bits, 8)), _mm_set1_ps(1.0f / 16777216.0f));
+    }
+#endif
+
+#ifdef SIMD_AVX2
+    // ------------------------------------------------------------------------
+    // AVX2 (8 values at a time)
+    SIMD_AVX2_TARGET
+    inline __m256i value8(__m256i x, uint32_t key)
+    {
+        const __m256i m = _mm256_set1_epi32(1664525);
+        x = _mm256_add_epi32(_mm256_mullo_epi32(x, m), _mm256_set1_epi32(1013904223));
+        __m256i y = _mm256_set1_epi32(int(key * 1664525u + 1013904223u));
+        x = _mm256_add_epi32(x, _mm256_mullo_epi32(y, m));
+        y = _mm256_add_epi32(y, _mm256_mullo_epi32(x, m));
+        x = _mm256_xor_si256(x, _mm256_srli_epi32(x, 16));
+        y = _mm256_xor_si256(y, _mm256_srli_epi32(y, 16));
+        x = _mm256_add_epi32(x, _mm256_mullo_epi32(y, m));
+        return _mm256_xor_si256(x, _mm256_srli_epi32(x, 16));
+    }
+
+    SIMD_AVX2_TARGET
+    inline __m256 unit8(__m256i bits)
+    {
+        return _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_srli_epi32(bits, 8)), _mm256_set1_ps(1.0f / 16777216.0f));
+    }
+#endif
+}
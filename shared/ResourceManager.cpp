@@ -0,0 +1,532 @@
+#include "ResourceManager.h"
+#include "CpuProfiler.h"
+#include "JobSystem.h"
+#include "OBJLoader.h"
+
+#include <imgui.h>
+#include <stb_image.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <iostream>
+
+namespace
+{
+    typedef std::chrono::steady_clock Clock;
+
+    double elapsedMs(Clock::time_point begin)
+    {
+        return std::chrono::duration<double, std::milli>(Clock::now() - begin).count();
+    }
+
+    int mipLevels(int width, int height, GLint minFilter)
+    {
+        if (minFilter == GL_NEAREST || minFilter == GL_LINEAR)
+            return 1;
+        int levels = 1;
+        while ((std::max(width, height) >> levels) > 0)
+            levels++;
+        return levels;
+    }
+
+    GLuint createTexture(int width, int height, const unsigned char* rgba, const TextureRequest& request)
+    {
+        GLuint id = 0;
+        const int levels = mipLevels(width, height, request.minFilter);
+        glCreateTextures(GL_TEXTURE_2D, 1, &id);
+        glTextureStorage2D(id, levels, GL_RGBA8, width, height);
+        glTextureSubImage2D(id, 0, 0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, rgba);
+        if (levels > 1)
+            glGenerateTextureMipmap(id);
+        glTextureParameteri(id, GL_TEXTURE_WRAP_S, request.wrap);
+        glTextureParameteri(id, GL_TEXTURE_WRAP_T, request.wrap);
+        glTextureParameteri(id, GL_TEXTURE_MIN_FILTER, request.minFilter);
+        glTextureParameteri(id, GL_TEXTURE_MAG_FILTER, request.magFilter);
+        return id;
+    }
+
+    // VAO reading interleaved OBJLoader::Vertex
+    GLuint createVertexArray(GLuint vbo, const MeshLayout& layout)
+    {
+        GLuint vao = 0;
+        glCreateVertexArrays(1, &vao);
+        glVertexArrayVertexBuffer(vao, 0, vbo, 0, sizeof(OBJLoader::Vertex));
+        const GLint locations[3] = { layout.position, layout.normal, layout.uv };
+        const GLint sizes[3] = { 3, 3, 2 };
+        const GLuint offsets[3] = { offsetof(OBJLoader::Vertex, position), offsetof(OBJLoader::Vertex, normal), offsetof(OBJLoader::Vertex, uv) };
+        for (int a = 0; a < 3; ++a)
+        {
+            if (locations[a] < 0)
+                continue;
+            glVertexArrayAttribFormat(vao, locations[a], sizes[a], GL_FLOAT, GL_FALSE, offsets[a]);
+            glVertexArrayAttribBinding(vao, locations[a], 0);
+            glEnableVertexArrayAttrib(vao, locations[a]);
+        }
+        return vao;
+    }
+
+    // Mesh decoded by a loading thread
+    struct MeshData
+    {
+        struct Part
+        {
+            std::vector<OBJLoader::Vertex> vertices;
+            glm::vec3 diffuse, specular;
+            float specularExponent;
+            glm::vec3 center;
+            float radius;
+        };
+        std::vector<Part> parts;
+    };
+}
+
+// ----------------------------------------------------------------------------
+ResourceManager::ResourceManager(int threads)
+{
+    // The job system (used by the OBJ loader) is created by this thread:
+    // the GL thread owns a deque, the loading threads use the shared queue
+    JobSystem::instance();
+    for (int i = 0; i < std::max(1, threads); ++i)
+        m_threads.emplace_back(&ResourceManager::loaderLoop, this, i);
+}
+
+ResourceManager::~ResourceManager()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+        m_loads.clear();
+    }
+    m_wake.notify_all();
+    for (std::thread& thread : m_threads)
+        thread.join();
+}
+
+void ResourceManager::loaderLoop(int index)
+{
+#ifndef PROFILER_DISABLED
+    CpuProfiler::setThreadName("Resource loader " + std::to_string(index));
+#endif
+    for (;;)
+    {
+        std::function<Upload()> load;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_wake.wait(lock, [this]() { return m_stop || !m_loads.empty(); });
+            if (m_stop)
+                return;
+            load = std::move(m_loads.front());
+            m_loads.pop_front();
+        }
+
+        Upload upload = load();
+        bool notify = false;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_uploads.push_back(std::move(upload));
+            notify = !m_stop;
+        }
+        // Still counted as in flight: clear() waits for the callback
+        // (it can use the window, ex: glfwPostEmptyEvent)
+        if (notify && onLoaded)
+            onLoaded();
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_inFlight--;
+        }
+        m_idle.notify_all();
+    }
+}
+
+void ResourceManager::enqueueLoad(std::function<Upload()> load)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_loads.push_back(std::move(load));
+        m_inFlight++;
+    }
+    m_wake.notify_one();
+}
+
+// ----------------------------------------------------------------------------
+TextureHandle ResourceManager::loadTexture(const std::string& path, const TextureRequest& request)
+{
+    TextureHandle handle;
+    auto known = m_textures.find(path);
+    if (known != m_textures.end())
+    {
+        handle.m_entry = known->second;
+        return handle;
+    }
+
+    createPlaceholders();
+    auto entry = std::make_shared<ResourceEntry<TextureResource>>();
+    entry->key = path;
+    entry->frame = &m_frame;
+    entry->lastUsed = m_frame;
+    entry->placeholder.width = entry->placeholder.height = 1;
+    if (request.placeholderColor)
+    {
+        const glm::vec4 c = glm::clamp(request.color, 0.0f, 1.0f) * 255.0f + 0.5f;
+        const unsigned char rgba[4] = { (unsigned char)c.r, (unsigned char)c.g, (unsigned char)c.b, (unsigned char)c.a };
+        TextureRequest constant = request;
+        constant.minFilter = GL_NEAREST;
+        constant.magFilter = GL_NEAREST;
+        entry->placeholder.id = createTexture(1, 1, rgba, constant);
+    }
+    else
+    {
+        entry->placeholder.id = m_checkerTexture;
+    }
+    m_textures[path] = entry;
+    handle.m_entry = entry;
+
+    // Read and decode on a loading thread
+    const GLuint checker = m_checkerTexture;
+    enqueueLoad([this, entry, path, request, checker]() {
+        PROFILE_SCOPE("ResourceManager::decodeTexture");
+        const Clock::time_point begin = Clock::now();
+        int width = 0, height = 0, components = 0;
+        stbi_set_flip_vertically_on_load_thread(request.flipVertically);
+        std::shared_ptr<unsigned char> pixels(stbi_load(path.c_str(), &width, &height, &components, STBI_rgb_alpha), stbi_image_free);
+        const double decodeMs = elapsedMs(begin);
+
+        Upload upload;
+        upload.finalize = [this, entry, request, checker, pixels, width, height, decodeMs]() {
+            if (!pixels)
+            {
+                std::cerr << "Impossible to load: " << entry->key << std::endl;
+                entry->state = ResourceState::Failed;
+                m_failed++;
+                return;
+            }
+            entry->resource.id = createTexture(width, height, pixels.get(), request);
+            entry->resource.width = width;
+            entry->resource.height = height;
+            entry->bytes = std::size_t(width) * height * 4 * (request.minFilter == GL_NEAREST || request.minFilter == GL_LINEAR ? 3 : 4) / 3;
+            entry->state = ResourceState::Ready;
+            if (entry->placeholder.id != checker)
+                glDeleteTextures(1, &entry->placeholder.id);
+            entry->placeholder.id = checker;
+            m_residentBytes += entry->bytes;
+            m_loaded++;
+            std::cout << "Texture loaded at path: " << entry->key << " (" << width << "x" << height
+                << ", decoded in " << decodeMs << " ms)" << std::endl;
+        };
+        return upload;
+    });
+    return handle;
+}
+
+MeshHandle ResourceManager::loadMesh(const std::string& path, const MeshLayout& layout)
+{
+    // The VAOs depend on the layout
+    const std::string key = path + "#" + std::to_string(layout.position) + "," + std::to_string(layout.normal) + "," + std::to_string(layout.uv);
+    MeshHandle handle;
+    auto known = m_meshes.find(key);
+    if (known != m_meshes.end())
+    {
+        handle.m_entry = known->second;
+        return handle;
+    }
+
+    createPlaceholders();
+    auto entry = std::make_shared<ResourceEntry<MeshResource>>();
+    entry->key = key;
+    entry->frame = &m_frame;
+    entry->lastUsed = m_frame;
+    entry->placeholder.parts.push_back(createBoxPart(layout));
+    m_meshes[key] = entry;
+    handle.m_entry = entry;
+
+    // Parse and split by material on a loading thread
+    enqueueLoad([this, entry, path, layout]() {
+        PROFILE_SCOPE("ResourceManager::decodeMesh");
+        const Clock::time_point begin = Clock::now();
+        auto data = std::make_shared<MeshData>();
+        OBJLoader::Loader loader;
+        const bool loaded = loader.loadFile(path);
+        if (loaded)
+        {
+            const std::vector<OBJLoader::Material>& materials = loader.getMaterials();
+            for (const OBJLoader::Mesh& mesh : loader.getMeshes())
+            {
+                if (mesh.vertices.empty())
+                    continue;
+                const OBJLoader::Material& material = materials[mesh.materialID];
+                MeshData::Part part;
+                part.vertices = mesh.vertices;
+                part.diffuse = glm::vec3(material.Kd[0], material.Kd[1], material.Kd[2]);
+                part.specular = glm::vec3(material.Ks[0], material.Ks[1], material.Ks[2]);
+                part.specularExponent = material.Kn;
+                part.center = glm::vec3(mesh.center[0], mesh.center[1], mesh.center[2]);
+                part.radius = mesh.radius;
+                data->parts.push_back(std::move(part));
+            }
+        }
+        const double decodeMs = elapsedMs(begin);
+
+        Upload upload;
+        upload.finalize = [this, entry, path, layout, data, loaded, decodeMs]() {
+            if (!loaded)
+            {
+                std::cerr << "Impossible to load: " << path << std::endl;
+                entry->state = ResourceState::Failed;
+                m_failed++;
+                return;
+            }
+            std::size_t vertices = 0;
+            for (const MeshData::Part& p : data->parts)
+            {
+                MeshResource::Part part;
+                part.vertexCount = GLsizei(p.vertices.size());
+                glCreateBuffers(1, &part.vbo);
+                glNamedBufferStorage(part.vbo, p.vertices.size() * sizeof(OBJLoader::Vertex), p.vertices.data(), 0);
+                part.vao = createVertexArray(part.vbo, layout);
+                part.diffuse = p.diffuse;
+                part.specular = p.specular;
+                part.specularExponent = p.specularExponent;
+                part.center = p.center;
+                part.radius = p.radius;
+                entry->resource.parts.push_back(part);
+                vertices += p.vertices.size();
+            }
+            entry->bytes = vertices * sizeof(OBJLoader::Vertex);
+            entry->state = ResourceState::Ready;
+            for (MeshResource::Part& part : entry->placeholder.parts)
+                glDeleteVertexArrays(1, &part.vao);
+            entry->placeholder.parts.clear();
+            m_residentBytes += entry->bytes;
+            m_loaded++;
+            std::cout << "Mesh loaded at path: " << path << " (" << entry->resource.parts.size() << " parts, "
+                << vertices << " vertices, decoded in " << decodeMs << " ms)" << std::endl;
+        };
+        return upload;
+    });
+    return handle;
+}
+
+// ----------------------------------------------------------------------------
+int ResourceManager::update(double budgetMs)
+{
+    PROFILE_SCOPE("ResourceManager::update");
+    m_frame++;
+    const Clock::time_point begin = Clock::now();
+    int finalized = 0;
+    for (;;)
+    {
+        Upload upload;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (m_uploads.empty())
+                break;
+            upload = std::move(m_uploads.front());
+            m_uploads.pop_front();
+        }
+        upload.finalize();
+        finalized++;
+        if (elapsedMs(begin) >= budgetMs)
+            break;
+    }
+    m_lastUpdateMs = elapsedMs(begin);
+    return finalized;
+}
+
+void ResourceManager::finish()
+{
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_idle.wait(lock, [this]() { return m_inFlight == 0; });
+    }
+    update(1e30);
+}
+
+bool ResourceManager::isBusy() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_inFlight > 0 || !m_uploads.empty();
+}
+
+// ----------------------------------------------------------------------------
+int ResourceManager::evictUnused(std::size_t maxBytes)
+{
+    if (m_residentBytes <= maxBytes)
+        return 0;
+
+    // Candidates: ready, only referenced by the manager
+    struct Candidate
+    {
+        uint64_t lastUsed;
+        std::size_t bytes;
+        std::function<void()> evict;
+        std::string key;
+    };
+    std::vector<Candidate> candidates;
+    for (auto& t : m_textures)
+    {
+        auto entry = t.second;
+        if (entry.use_count() == 2 && entry->state == ResourceState::Ready)
+            candidates.push_back({ entry->lastUsed, entry->bytes, [this, entry]() {
+                deleteResource(entry->resource);
+                m_textures.erase(entry->key);
+            }, entry->key });
+    }
+    for (auto& m : m_meshes)
+    {
+        auto entry = m.second;
+        if (entry.use_count() == 2 && entry->state == ResourceState::Ready)
+            candidates.push_back({ entry->lastUsed, entry->bytes, [this, entry]() {
+                deleteResource(entry->resource);
+                m_meshes.erase(entry->key);
+            }, entry->key });
+    }
+    std::sort(candidates.begin(), candidates.end(), [](const Candidate& a, const Candidate& b) {
+        return a.lastUsed < b.lastUsed;
+    });
+
+    int evicted = 0;
+    for (Candidate& c : candidates)
+    {
+        if (m_residentBytes <= maxBytes)
+            break;
+        if (onEvict && !onEvict(c.key, c.bytes))
+            continue;
+        c.evict();
+        m_residentBytes -= c.bytes;
+        evicted++;
+    }
+    m_evicted += evicted;
+    return evicted;
+}
+
+void ResourceManager::clear()
+{
+    // Wait for the loading threads: their results use the placeholders
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_inFlight -= int(m_loads.size());
+        m_loads.clear();
+        m_idle.wait(lock, [this]() { return m_inFlight == 0; });
+    }
+    for (auto& t : m_textures)
+    {
+        deleteResource(t.second->resource);
+        if (t.second->placeholder.id != m_checkerTexture)
+            deleteResource(t.second->placeholder);
+    }
+    for (auto& m : m_meshes)
+    {
+        deleteResource(m.second->resource);
+        for (MeshResource::Part& part : m.second->placeholder.parts)
+            glDeleteVertexArrays(1, &part.vao);
+        m.second->placeholder.parts.clear();
+    }
+    m_textures.clear();
+    m_meshes.clear();
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_uploads.clear();
+    }
+    glDeleteTextures(1, &m_checkerTexture);
+    glDeleteBuffers(1, &m_boxBuffer);
+    m_checkerTexture = 0;
+    m_boxBuffer = 0;
+    m_residentBytes = 0;
+}
+
+void ResourceManager::deleteResource(TextureResource& texture)
+{
+    glDeleteTextures(1, &texture.id);
+    texture = TextureResource();
+}
+
+void ResourceManager::deleteResource(MeshResource& mesh)
+{
+    for (MeshResource::Part& part : mesh.parts)
+    {
+        glDeleteVertexArrays(1, &part.vao);
+        glDeleteBuffers(1, &part.vbo);
+    }
+    mesh.parts.clear();
+}
+
+// ----------------------------------------------------------------------------
+void ResourceManager::createPlaceholders()
+{
+    if (m_checkerTexture != 0)
+        return;
+
+    // Checker 8x8 (magenta / grey), sampled without filtering
+    const int size = 8;
+    std::vector<unsigned char> checker(size * size * 4);
+    for (int y = 0; y < size; ++y)
+    {
+        for (int x = 0; x < size; ++x)
+        {
+            unsigned char* p = &checker[(y * size + x) * 4];
+            const bool odd = ((x + y) & 1) != 0;
+            p[0] = odd ? 255 : 96;
+            p[1] = odd ? 0 : 96;
+            p[2] = odd ? 255 : 96;
+            p[3] = 255;
+        }
+    }
+    TextureRequest request;
+    request.minFilter = GL_NEAREST;
+    request.magFilter = GL_NEAREST;
+    m_checkerTexture = createTexture(size, size, checker.data(), request);
+
+    // Box [-1, 1] (36 vertices with face normals)
+    std::vector<OBJLoader::Vertex> box;
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        for (int side = -1; side <= 1; side += 2)
+        {
+            const int u = (axis + 1) % 3, v = (axis + 2) % 3;
+            const float corners[6][2] = { { -1, -1 }, { 1, -1 }, { 1, 1 }, { -1, -1 }, { 1, 1 }, { -1, 1 } };
+            for (int c = 0; c < 6; ++c)
+            {
+                // Counter-clockwise seen from outside
+                const int k = side > 0 ? c : 5 - c;
+                OBJLoader::Vertex vertex = {};
+                vertex.position[axis] = float(side);
+                vertex.position[u] = corners[k][0];
+                vertex.position[v] = corners[k][1];
+                vertex.normal[axis] = float(side);
+                vertex.uv[0] = corners[k][0] * 0.5f + 0.5f;
+                vertex.uv[1] = corners[k][1] * 0.5f + 0.5f;
+                box.push_back(vertex);
+            }
+        }
+    }
+    glCreateBuffers(1, &m_boxBuffer);
+    glNamedBufferStorage(m_boxBuffer, box.size() * sizeof(OBJLoader::Vertex), box.data(), 0);
+    m_boxVertexCount = GLsizei(box.size());
+}
+
+MeshResource::Part ResourceManager::createBoxPart(const MeshLayout& layout)
+{
+    MeshResource::Part part;
+    part.vao = createVertexArray(m_boxBuffer, layout);
+    part.vbo = 0; // Shared, deleted by clear()
+    part.vertexCount = m_boxVertexCount;
+    part.radius = std::sqrt(3.0f);
+    return part;
+}
+
+// ----------------------------------------------------------------------------
+void ResourceManager::drawImgui()
+{
+    int loading = 0, waiting = 0;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        loading = m_inFlight;
+        waiting = int(m_uploads.size());
+    }
+    ImGui::Text("Resources: %llu loaded, %llu failed, %llu evicted",
+        (unsigned long long)m_loaded, (unsigned long long)m_failed, (unsigned long long)m_evicted);
+    ImGui::Text("Loading: %d, waiting for upload: %d (last upload %.2f ms)", loading, waiting, m_lastUpdateMs);
+    ImGui::Text("GPU memory: %.1f MB", m_residentBytes / (1024.0 * 1024.0));
+}
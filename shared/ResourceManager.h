@@ -0,0 +1,225 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Asynchronous loading of the textures and the OBJ meshes
+// A request returns a handle immediately. The file is read, decoded and
+// processed by background threads, then the OpenGL objects are created by
+// the GL thread inside update(), within a time budget per frame. Until the
+// resource is ready, the handle gives a placeholder: checker texture (or a
+// constant color) and box mesh. The first frame is drawn without waiting.
+//
+// The resources are shared (the same file is loaded only once) and reference
+// counted by the handles. The unused ones stay in memory until
+// evictUnused() removes the least recently used (onEvict can veto).
+//
+// Usage:
+//   m_texture = m_resources.loadTexture(path);                   // InitializeGL
+//   m_mesh = m_resources.loadMesh(path, MeshLayout{ posLoc, normalLoc, -1 });
+//   ...
+//   m_resources.update();                                        // Each frame
+//   glBindTextureUnit(0, m_texture->id);
+//   for (const MeshResource::Part& part : m_mesh->parts) ...
+//   ...
+//   m_resources.clear();                                         // Before destroying the context
+//
+// The requests, update() and clear() are called by the GL thread.
+enum class ResourceState { Loading, Ready, Failed };
+
+struct TextureResource
+{
+    GLuint id = 0;
+    int width = 0;
+    int height = 0;
+};
+
+// Attribute locations used by the VAOs of a mesh (-1 = not used)
+struct MeshLayout
+{
+    GLint position = 0;
+    GLint normal = 1;
+    GLint uv = 2;
+};
+
+// Mesh with one part per material of the OBJ file
+// Interleaved vertices: position (vec3), normal (vec3), uv (vec2)
+struct MeshResource
+{
+    struct Part
+    {
+        GLuint vao = 0;
+        GLuint vbo = 0;
+        GLsizei vertexCount = 0;
+        glm::vec3 diffuse = glm::vec3(0.6f);
+        glm::vec3 specular = glm::vec3(0.0f);
+        float specularExponent = 1.0f;
+        // Bounding sphere (object space)
+        glm::vec3 center = glm::vec3(0.0f);
+        float radius = 0.0f;
+    };
+    std::vector<Part> parts;
+};
+
+struct TextureRequest
+{
+    GLint wrap = GL_REPEAT;
+    GLint minFilter = GL_LINEAR_MIPMAP_LINEAR;
+    GLint magFilter = GL_LINEAR;
+    // Flip the rows (OpenGL expects the bottom row first)
+    bool flipVertically = true;
+    // Placeholder: checker if false, else a constant color
+    bool placeholderColor = false;
+    glm::vec4 color = glm::vec4(1.0f);
+};
+
+template <typename T>
+struct ResourceEntry
+{
+    std::string key;
+    ResourceState state = ResourceState::Loading;
+    T resource;
+    T placeholder;
+    std::size_t bytes = 0;     // GPU memory of the resource
+    uint64_t lastUsed = 0;     // Frame of the last get()
+    const uint64_t* frame = nullptr;
+};
+
+// Reference to a resource (copyable, counted)
+template <typename T>
+class ResourceHandle
+{
+public:
+    bool isValid() const { return bool(m_entry); }
+    ResourceState state() const { return m_entry ? m_entry->state : ResourceState::Failed; }
+    bool isReady() const { return state() == ResourceState::Ready; }
+
+    // ------------------------------------------------------------------------
+    // resource, or its placeholder while loading (or when the loading failed)
+    // return nullptr if the handle is not valid
+    const T* get() const
+    {
+        if (!m_entry)
+            return nullptr;
+        m_entry->lastUsed = *m_entry->frame;
+        return m_entry->state == ResourceState::Ready ? &m_entry->resource : &m_entry->placeholder;
+    }
+    const T* operator->() const { return get(); }
+
+    void reset() { m_entry.reset(); }
+
+private:
+    friend class ResourceManager;
+    std::shared_ptr<ResourceEntry<T>> m_entry;
+};
+
+typedef ResourceHandle<TextureResource> TextureHandle;
+typedef ResourceHandle<MeshResource> MeshHandle;
+
+class ResourceManager
+{
+public:
+    // ------------------------------------------------------------------------
+    // start the loading threads
+    explicit ResourceManager(int threads = 2);
+    ~ResourceManager();
+
+    // ------------------------------------------------------------------------
+    // request the loading (nothing is loaded if the resource is known)
+    TextureHandle loadTexture(const std::string& path, const TextureRequest& request = TextureRequest());
+    MeshHandle loadMesh(const std::string& path, const MeshLayout& layout = MeshLayout());
+
+    // ------------------------------------------------------------------------
+    // create the OpenGL objects of the loaded resources (once per frame)
+    // Stops when the budget is spent (at least one resource per call).
+    // return the number of resources that became ready (or failed)
+    int update(double budgetMs = 2.0);
+
+    // ------------------------------------------------------------------------
+    // wait for all the requests and create their OpenGL objects
+    // (ex: benchmark mode, the measured frames show the real scene)
+    void finish();
+
+    // ------------------------------------------------------------------------
+    // true if resources are still loaded or waiting for update()
+    bool isBusy() const;
+
+    // ------------------------------------------------------------------------
+    // delete the unused resources (no handle) from the least recently used
+    // until the GPU memory is below maxBytes, return the number of deleted ones
+    int evictUnused(std::size_t maxBytes);
+    // called before evicting a resource, return false to keep it
+    std::function<bool(const std::string& key, std::size_t bytes)> onEvict;
+
+    // ------------------------------------------------------------------------
+    // called by a loading thread when a resource is waiting for update()
+    // (ex: wake up the render loop with glfwPostEmptyEvent)
+    // Never called after clear() returns or during the destruction.
+    std::function<void()> onLoaded;
+
+    // ------------------------------------------------------------------------
+    // cancel the pending requests, wait for the loading ones (and their
+    // onLoaded) and delete all the OpenGL objects (the handles must not be
+    // used after). Call it before destroying the window.
+    void clear();
+
+    std::size_t residentBytes() const { return m_residentBytes; }
+
+    // ------------------------------------------------------------------------
+    // counters (inside the current ImGui window)
+    void drawImgui();
+
+private:
+    // Work done on the GL thread when the CPU part is done
+    struct Upload
+    {
+        std::function<void()> finalize;
+    };
+
+    void loaderLoop(int index);
+    void enqueueLoad(std::function<Upload()> load);
+    void createPlaceholders();
+    MeshResource::Part createBoxPart(const MeshLayout& layout);
+    static void deleteResource(TextureResource& texture);
+    static void deleteResource(MeshResource& mesh);
+
+private:
+    std::vector<std::thread> m_threads;
+
+    // Requests waiting for a loading thread
+    mutable std::mutex m_mutex;
+    std::condition_variable m_wake;
+    std::condition_variable m_idle;
+    std::deque<std::function<Upload()>> m_loads;
+    // Loaded resources waiting for update()
+    std::deque<Upload> m_uploads;
+    int m_inFlight = 0; // Requests not yet inside m_uploads (or notified)
+    bool m_stop = false;
+
+    // Known resources (GL thread only)
+    std::map<std::string, std::shared_ptr<ResourceEntry<TextureResource>>> m_textures;
+    std::map<std::string, std::shared_ptr<ResourceEntry<MeshResource>>> m_meshes;
+
+    // Placeholders
+    GLuint m_checkerTexture = 0;
+    GLuint m_boxBuffer = 0;
+    GLsizei m_boxVertexCount = 0;
+
+    uint64_t m_frame = 0;
+    std::size_t m_residentBytes = 0;
+    uint64_t m_loaded = 0;
+    uint64_t m_failed = 0;
+    uint64_t m_evicted = 0;
+    double m_lastUpdateMs = 0.0;
+};
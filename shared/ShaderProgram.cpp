@@ -10,10 +10,13 @@
  */
 
 #include "ShaderProgram.h"
+#include "ShaderSourceCache.h"
+#include "GLDebugSink.h"
 #include <iostream>
 
 
-// utility function that translate OpenGL error code to console output
+// utility function that forward the OpenGL debug messages to the console
+// Note: the messages are queued and printed by GLDebugSink::drain()
 // --------------------------------------------------------------------
 void APIENTRY glDebugOutput(GLenum source, 
                             GLenum type, 
@@ -26,45 +29,12 @@ void APIENTRY glDebugOutput(GLenum source,
     // ignore non-significant error/warning codes
     if(id == 131169 || id == 131185 || id == 131218 || id == 131204) return; 
 
-    std::cout << "---------------" << std::endl;
-    std::cout << "Debug message (" << id << "): " <<  message << std::endl;
-
-    switch (source)
-    {
-        case GL_DEBUG_SOURCE_API:             std::cout << "Source: API"; break;
-        case GL_DEBUG_SOURCE_WINDOW_SYSTEM:   std::cout << "Source: Window System"; break;
-        case GL_DEBUG_SOURCE_SHADER_COMPILER: std::cout << "Source: Shader Compiler"; break;
-        case GL_DEBUG_SOURCE_THIRD_PARTY:     std::cout << "Source: Third Party"; break;
-        case GL_DEBUG_SOURCE_APPLICATION:     std::cout << "Source: Application"; break;
-        case GL_DEBUG_SOURCE_OTHER:           std::cout << "Source: Other"; break;
-    } std::cout << std::endl;
-
-    switch (type)
-    {
-        case GL_DEBUG_TYPE_ERROR:               std::cout << "Type: Error"; break;
-        case GL_DEBUG_TYPE_DEPRECATED_BEHAVIOR: std::cout << "Type: Deprecated Behaviour"; break;
-        case GL_DEBUG_TYPE_UNDEFINED_BEHAVIOR:  std::cout << "Type: Undefined Behaviour"; break; 
-        case GL_DEBUG_TYPE_PORTABILITY:         std::cout << "Type: Portability"; break;
-        case GL_DEBUG_TYPE_PERFORMANCE:         std::cout << "Type: Performance"; break;
-        case GL_DEBUG_TYPE_MARKER:              std::cout << "Type: Marker"; break;
-        case GL_DEBUG_TYPE_PUSH_GROUP:          std::cout << "Type: Push Group"; break;
-        case GL_DEBUG_TYPE_POP_GROUP:           std::cout << "Type: Pop Group"; break;
-        case GL_DEBUG_TYPE_OTHER:               std::cout << "Type: Other"; break;
-    } std::cout << std::endl;
-    
-    switch (severity)
-    {
-        case GL_DEBUG_SEVERITY_HIGH:         std::cout << "Severity: high"; break;
-        case GL_DEBUG_SEVERITY_MEDIUM:       std::cout << "Severity: medium"; break;
-        case GL_DEBUG_SEVERITY_LOW:          std::cout << "Severity: low"; break;
-        case GL_DEBUG_SEVERITY_NOTIFICATION: std::cout << "Severity: notification"; break;
-    } std::cout << std::endl;
-    std::cout << std::endl;
+    GLDebugSink::instance().push(source, type, id, severity, length, message);
 }
 
 // utility function for checking shader compilation/linking errors.
 // ------------------------------------------------------------------------
-bool checkCompileErrors(GLuint shader, std::string type, std::string filename)
+bool checkCompileErrors(GLuint shader, std::string type, std::string filename, const ResolvedShaderSource* source = nullptr)
 {
 	int success;
 	char infoLog[1024];
@@ -77,7 +47,12 @@ bool checkCompileErrors(GLuint shader, std::string type, std::string filename)
 			std::cerr << "ERROR::SHADER_COMPILATION_ERROR of type: " << type << "\n";
 			if (filename != "")
 				std::cerr << "Filename: " << filename << "\n";
-			std::cerr << infoLog << "\n -- --------------------------------------------------- -- " << std::endl;
+			// Show the file names instead of the source string numbers (includes)
+			if (source && source->files.size() > 1)
+				std::cerr << source->remapLog(infoLog);
+			else
+				std::cerr << infoLog;
+			std::cerr << "\n -- --------------------------------------------------- -- " << std::endl;
 		}
 	}
 	else
@@ -130,32 +105,23 @@ bool ShaderProgram::addShaderFromSource(GLenum shader_type, const std::string& p
 		return false;
 	}
 
-	// Read file
-	std::string code;
-	std::ifstream file;
-	file.exceptions(std::ifstream::failbit | std::ifstream::badbit);
-	try
-	{
-		file.open(path);
-		std::stringstream ss;
-		ss << file.rdbuf();
-		file.close();
-		code = ss.str();
-	} 
-	catch (std::ifstream::failure& e)
-	{
-		std::cerr << "Impossible to read: " << path << std::endl;
-		std::cerr << e.what() << std::endl;
+	// Read file and resolve the includes
+	// Note that the files are cached (each include file is read once)
+	ResolvedShaderSource source;
+	if (!ShaderSourceCache::instance().resolve(path, source)) {
 		return false;
 	}
+	const std::string& code = source.code;
 	GLuint shader_id = glCreateShader(shader_type);
 	const char* code_c_str = code.c_str();
 	glShaderSource(shader_id, 1, &code_c_str, NULL);
 	glCompileShader(shader_id);
-	bool success = checkCompileErrors(shader_id, shader_type_str, path);
+	bool success = checkCompileErrors(shader_id, shader_type_str, path, &source);
 	glAttachShader(m_ID, shader_id);
 	if (success) {
 		m_shaders_ids[shader_type_str] = shader_id;
+		// Combine the hash of the different stages
+		m_sourceHash ^= source.hash + 0x9e3779b97f4a7c15ull + (m_sourceHash << 6) + (m_sourceHash >> 2);
 	}
 	return success;
 }
@@ -6,6 +6,7 @@
 #include <glad/glad.h>
 #include <glm/glm.hpp>
 
+#include <cstdint>
 #include <map>
 #include <string>
 #include <fstream>
@@ -50,6 +51,8 @@ inline void CheckOpenGLError(const char* stmt, const char* fname, int line)
 
 // Other function to check OpenGL error
 // From https://learnopengl.com/In-Practice/Debugging
+// The messages are queued: call GLDebugSink::instance().drain() to print them
+// (high severity messages are printed immediately, see GLDebugSink.h)
 void APIENTRY glDebugOutput(GLenum source, 
                             GLenum type, 
                             unsigned int id, 
@@ -69,6 +72,7 @@ public:
    
    // ------------------------------------------------------------------------
    // attach shader from sources 
+   // #include "file.glsl" directives are resolved (see ShaderSourceCache)
    // return true if sucessfull
    bool addShaderFromSource(GLenum type, const std::string& path);
    
@@ -81,6 +85,11 @@ public:
    // get program ID to interact directly with the shader program
    inline GLuint programId() const { return m_ID; }
 
+   // ------------------------------------------------------------------------
+   // hash of the resolved sources of all the attached shaders
+   // (can be used as a key for a program binary cache)
+   inline uint64_t sourceHash() const { return m_sourceHash; }
+
    // ------------------------------------------------------------------------
    // use shader program
    inline void bind() const { 
@@ -126,6 +135,8 @@ private:
     bool m_linked = false;
     // List of the different shaders (can be reused if necessary)
     std::map<std::string, GLuint> m_shaders_ids;
+    // Hash of the resolved sources
+    uint64_t m_sourceHash = 0;
 };
 
 inline std::ostream& operator<<(std::ostream& out, const glm::vec2& g)
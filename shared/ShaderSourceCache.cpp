@@ -0,0 +1,265 @@
+#include "ShaderSourceCache.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <regex>
+#include <sstream>
+
+namespace
+{
+    // Normalize a path (use '/' and remove "./" and "dir/../")
+    std::string normalizePath(const std::string& path)
+    {
+        std::string p = path;
+        std::replace(p.begin(), p.end(), '\\', '/');
+
+        // Split the path
+        std::vector<std::string> parts;
+        std::stringstream ss(p);
+        std::string part;
+        while (std::getline(ss, part, '/'))
+        {
+            if (part == "." || (part.empty() && !parts.empty()))
+                continue;
+            if (part == ".." && !parts.empty() && parts.back() != ".." && !parts.back().empty())
+            {
+                parts.pop_back();
+                continue;
+            }
+            parts.push_back(part);
+        }
+
+        // Rebuild it
+        std::string res;
+        for (std::size_t i = 0; i < parts.size(); ++i)
+        {
+            if (i != 0)
+                res += "/";
+            res += parts[i];
+        }
+        if (parts.size() == 1 && parts[0].empty())
+            res = "/";
+        return res;
+    }
+
+    // Extract directory from a path
+    std::string extractDirectory(const std::string& path)
+    {
+        std::size_t pos = path.find_last_of("/\\");
+        if (pos == std::string::npos)
+            return std::string(".");
+        return path.substr(0, pos);
+    }
+
+    uint64_t hashFNV1a(const std::string& s)
+    {
+        uint64_t h = 14695981039346656037ull;
+        for (unsigned char c : s)
+        {
+            h ^= c;
+            h *= 1099511628211ull;
+        }
+        return h;
+    }
+}
+
+std::string ResolvedShaderSource::remapLog(const std::string& log) const
+{
+    // Different drivers format: "0(12) : error" (NVIDIA), "0:12(5): error" (Mesa)
+    // or "ERROR: 0:12: error" (AMD/Intel)
+    static const std::regex location("^((?:ERROR|WARNING): )?([0-9]+)([:(])([0-9]+)");
+    std::stringstream in(log);
+    std::stringstream out;
+    std::string line;
+    while (std::getline(in, line))
+    {
+        std::smatch m;
+        if (std::regex_search(line, m, location))
+        {
+            std::size_t id = std::stoul(m[2].str());
+            if (id < files.size())
+            {
+                line = m[1].str() + files[id] + m[3].str() + m[4].str() + m.suffix().str();
+            }
+        }
+        out << line << "\n";
+    }
+    return out.str();
+}
+
+ShaderSourceCache& ShaderSourceCache::instance()
+{
+    static ShaderSourceCache cache;
+    return cache;
+}
+
+ShaderSourceCache::ShaderSourceCache()
+{
+#ifdef SHARED_SHADERS_DIR
+    m_includeDirectories.push_back(SHARED_SHADERS_DIR);
+#endif
+}
+
+void ShaderSourceCache::addIncludeDirectory(const std::string& directory)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (std::find(m_includeDirectories.begin(), m_includeDirectories.end(), directory) == m_includeDirectories.end())
+        m_includeDirectories.push_back(directory);
+}
+
+void ShaderSourceCache::clear()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_files.clear();
+}
+
+const ShaderSourceCache::ParsedFile* ShaderSourceCache::load(const std::string& path, bool reportError)
+{
+    const std::string key = normalizePath(path);
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_files.find(key);
+        if (it != m_files.end())
+            return it->second.get();
+    }
+
+    // Read file
+    std::ifstream file(key);
+    if (!file.is_open())
+    {
+        if (reportError)
+            std::cerr << "Impossible to read: " << path << std::endl;
+        return nullptr;
+    }
+
+    // Split the file into segments
+    static const std::regex includeDirective("^\\s*#\\s*include\\s*[\"<]([^\">]+)[\">]");
+    static const std::regex pragmaOnceDirective("^\\s*#\\s*pragma\\s+once\\b");
+    std::unique_ptr<ParsedFile> parsed = std::make_unique<ParsedFile>();
+    parsed->path = key;
+    Segment current;
+    std::string line;
+    int lineNumber = 0;
+    while (std::getline(file, line))
+    {
+        lineNumber++;
+        // Quick rejection for the lines that are not directives
+        std::size_t first = line.find_first_not_of(" \t");
+        bool directive = first != std::string::npos && line[first] == '#';
+
+        std::smatch m;
+        if (directive && std::regex_search(line, m, includeDirective))
+        {
+            if (!current.code.empty())
+                parsed->segments.push_back(current);
+            Segment include;
+            include.include = m[1].str();
+            include.line = lineNumber;
+            parsed->segments.push_back(include);
+            current = Segment();
+            current.line = lineNumber + 1;
+        }
+        else if (directive && std::regex_search(line, pragmaOnceDirective))
+        {
+            // Keep an empty line to preserve the line numbers
+            parsed->pragmaOnce = true;
+            current.code += "\n";
+        }
+        else
+        {
+            current.code += line;
+            current.code += "\n";
+        }
+    }
+    if (!current.code.empty())
+        parsed->segments.push_back(current);
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    // Another thread may have loaded the same file in the meantime
+    auto inserted = m_files.emplace(key, std::move(parsed));
+    return inserted.first->second.get();
+}
+
+const ShaderSourceCache::ParsedFile* ShaderSourceCache::findInclude(const std::string& name, const std::string& currentPath)
+{
+    // 1) Relative to the current file
+    const ParsedFile* file = load(extractDirectory(currentPath) + "/" + name, false);
+    if (file)
+        return file;
+
+    // 2) Inside the include directories
+    std::vector<std::string> directories;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        directories = m_includeDirectories;
+    }
+    for (const std::string& directory : directories)
+    {
+        file = load(directory + "/" + name, false);
+        if (file)
+            return file;
+    }
+    return nullptr;
+}
+
+bool ShaderSourceCache::append(const ParsedFile* file, ResolvedShaderSource& out,
+    std::vector<std::string>& stack, std::vector<std::string>& included)
+{
+    const std::size_t id = out.files.size();
+    out.files.push_back(file->path);
+    stack.push_back(file->path);
+    included.push_back(file->path);
+
+    for (const Segment& s : file->segments)
+    {
+        if (s.include.empty())
+        {
+            out.code += s.code;
+            continue;
+        }
+
+        const ParsedFile* child = findInclude(s.include, file->path);
+        if (!child)
+        {
+            std::cerr << "Impossible to find include \"" << s.include << "\" in " << file->path << ":" << s.line << std::endl;
+            return false;
+        }
+        if (std::find(stack.begin(), stack.end(), child->path) != stack.end())
+        {
+            std::cerr << "Recursive include \"" << s.include << "\" in " << file->path << ":" << s.line << std::endl;
+            return false;
+        }
+        if (child->pragmaOnce && std::find(included.begin(), included.end(), child->path) != included.end())
+        {
+            // Already included, keep the line numbers consistent
+            out.code += "\n";
+            continue;
+        }
+
+        out.code += "#line 1 " + std::to_string(out.files.size()) + "\n";
+        if (!append(child, out, stack, included))
+            return false;
+        if (!out.code.empty() && out.code.back() != '\n')
+            out.code += "\n";
+        out.code += "#line " + std::to_string(s.line + 1) + " " + std::to_string(id) + "\n";
+    }
+
+    stack.pop_back();
+    return true;
+}
+
+bool ShaderSourceCache::resolve(const std::string& path, ResolvedShaderSource& out)
+{
+    out = ResolvedShaderSource();
+    const ParsedFile* file = load(path, true);
+    if (!file)
+        return false;
+
+    std::vector<std::string> stack;
+    std::vector<std::string> included;
+    if (!append(file, out, stack, included))
+        return false;
+    out.hash = hashFNV1a(out.code);
+    return true;
+}
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Shader source after the #include directives have been resolved
+struct ResolvedShaderSource
+{
+    // Final GLSL code given to glShaderSource
+    std::string code;
+    // Files used to build the code. The index in this list is the
+    // source string number used in the #line directives (0 = main file)
+    std::vector<std::string> files;
+    // Hash (FNV-1a) of the final code.
+    // Can be used as a key for a program binary cache
+    uint64_t hash = 0;
+
+    // Replace the source string numbers inside a compiler log
+    // (ex: "1(12) : error" or "1:12(5): error") by the file names
+    std::string remapLog(const std::string& log) const;
+};
+
+// Process-wide cache of the shader files (read and parsed only once)
+// Support:
+//  - #include "file.glsl" (relative to the current file, then to the include directories)
+//  - #pragma once
+// Note that the cache is thread safe.
+class ShaderSourceCache
+{
+public:
+    // ------------------------------------------------------------------------
+    // unique instance shared by all the ShaderProgram
+    static ShaderSourceCache& instance();
+
+    // ------------------------------------------------------------------------
+    // add a directory where the include files are searched
+    // (SHARED_SHADERS_DIR is added by default if defined)
+    void addIncludeDirectory(const std::string& directory);
+
+    // ------------------------------------------------------------------------
+    // resolve all the includes of a shader file
+    // return true if sucessfull (error message is written in std::cerr)
+    bool resolve(const std::string& path, ResolvedShaderSource& out);
+
+    // ------------------------------------------------------------------------
+    // forget all the files (to force reloading them from the disk)
+    void clear();
+
+private:
+    ShaderSourceCache();
+
+    // Part of a file: either plain code or an include directive
+    struct Segment
+    {
+        std::string code;    // Code (empty if include)
+        std::string include; // Include name (empty if code)
+        int line = 1;        // Line number of the first line of the segment
+    };
+    // File read and split in segments
+    struct ParsedFile
+    {
+        std::string path;
+        std::vector<Segment> segments;
+        bool pragmaOnce = false;
+    };
+
+    // Return the parsed file (read it if not cached), nullptr if not readable
+    const ParsedFile* load(const std::string& path, bool reportError);
+    // Find the file corresponding to an include directive
+    const ParsedFile* findInclude(const std::string& name, const std::string& currentPath);
+    // Append recursively the file to the resolved source
+    bool append(const ParsedFile* file, ResolvedShaderSource& out,
+        std::vector<std::string>& stack, std::vector<std::string>& included);
+
+private:
+    std::mutex m_mutex;
+    std::map<std::string, std::unique_ptr<ParsedFile>> m_files;
+    std::vector<std::string> m_includeDirectories;
+};
@@ -0,0 +1,144 @@
+#include "StreamingBuffer.h"
+
+#include <algorithm>
+#include <iostream>
+
+// ----------------------------------------------------------------------------
+void StreamingBuffer::reserve(std::size_t regionSize)
+{
+    if (regionSize > m_regionCapacity)
+    {
+        // Offsets of the regions usable by glBindBufferRange
+        GLint alignment = 256;
+        glGetIntegerv(GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT, &alignment);
+        std::size_t capacity = std::max(regionSize, m_regionCapacity * 2);
+        capacity = (capacity + alignment - 1) / alignment * alignment;
+
+        // The GPU can still read the old buffer: OpenGL deletes it after
+        release();
+        const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        glCreateBuffers(1, &m_buffer);
+        glNamedBufferStorage(m_buffer, capacity * Regions, nullptr, flags);
+        m_mapped = static_cast<char*>(glMapNamedBufferRange(m_buffer, 0, capacity * Regions, flags));
+        if (!m_mapped)
+        {
+            std::cerr << "Impossible to map the streaming buffer (" << capacity * Regions << " bytes)" << std::endl;
+            return;
+        }
+        m_regionCapacity = capacity;
+    }
+
+    // Empty regions, the ones still read by the GPU wait for their fence
+    for (int i = 0; i < Regions; ++i)
+        m_states[i].store(m_fences[i] ? Retired : Free, std::memory_order_relaxed);
+    m_ready.store(-1);
+    m_writing = -1;
+    m_read = -1;
+}
+
+void StreamingBuffer::release()
+{
+    for (GLsync& fence : m_fences)
+    {
+        if (fence)
+            glDeleteSync(fence);
+        fence = nullptr;
+    }
+    if (m_buffer)
+    {
+        if (m_mapped)
+            glUnmapNamedBuffer(m_buffer);
+        glDeleteBuffers(1, &m_buffer);
+    }
+    m_buffer = 0;
+    m_mapped = nullptr;
+    m_regionCapacity = 0;
+    for (std::atomic<int>& state : m_states)
+        state.store(Free, std::memory_order_relaxed);
+    m_ready.store(-1);
+    m_read = -1;
+}
+
+// ----------------------------------------------------------------------------
+void* StreamingBuffer::beginWrite()
+{
+    if (!m_mapped)
+        return nullptr;
+    for (int i = 0; i < Regions; ++i)
+    {
+        // acquire: the GPU is done with the region (fence checked by update)
+        int expected = Free;
+        if (m_states[i].compare_exchange_strong(expected, Writing, std::memory_order_acquire, std::memory_order_relaxed))
+        {
+            m_writing = i;
+            return m_mapped + std::size_t(i) * m_regionCapacity;
+        }
+    }
+
+    // Overwrite the newest region if the GL thread did not take it
+    const int ready = m_ready.exchange(-1, std::memory_order_acq_rel);
+    if (ready >= 0)
+    {
+        m_states[ready].store(Writing, std::memory_order_relaxed);
+        m_writing = ready;
+        return m_mapped + std::size_t(ready) * m_regionCapacity;
+    }
+    m_skipped.fetch_add(1, std::memory_order_relaxed);
+    return nullptr;
+}
+
+void StreamingBuffer::endWrite(uint64_t tag)
+{
+    if (m_writing < 0)
+        return;
+    m_tags[m_writing] = tag;
+    m_states[m_writing].store(Ready, std::memory_order_relaxed);
+    // release: the content of the region is visible before its index
+    const int previous = m_ready.exchange(m_writing, std::memory_order_acq_rel);
+    // Replaced before being drawn
+    if (previous >= 0)
+        m_states[previous].store(Free, std::memory_order_release);
+    m_writing = -1;
+    m_written.fetch_add(1, std::memory_order_relaxed);
+}
+
+// ----------------------------------------------------------------------------
+bool StreamingBuffer::update()
+{
+    recycle();
+    const int ready = m_ready.exchange(-1, std::memory_order_acq_rel);
+    if (ready < 0)
+        return false;
+    // The previous region is free when the GPU has executed its last draw
+    if (m_read >= 0)
+        m_states[m_read].store(m_fences[m_read] ? Retired : Free, std::memory_order_release);
+    m_read = ready;
+    m_states[m_read].store(Drawing, std::memory_order_relaxed);
+    return true;
+}
+
+void StreamingBuffer::fenceRead()
+{
+    if (m_read < 0)
+        return;
+    if (m_fences[m_read])
+        glDeleteSync(m_fences[m_read]);
+    m_fences[m_read] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
+
+void StreamingBuffer::recycle()
+{
+    for (int i = 0; i < Regions; ++i)
+    {
+        if (m_states[i].load(std::memory_order_relaxed) != Retired)
+            continue;
+        // Poll only (the fences are flushed by the swap of the frame)
+        const GLenum result = glClientWaitSync(m_fences[i], 0, 0);
+        if (result == GL_ALREADY_SIGNALED || result == GL_CONDITION_SATISFIED)
+        {
+            glDeleteSync(m_fences[i]);
+            m_fences[i] = nullptr;
+            m_states[i].store(Free, std::memory_order_release);
+        }
+    }
+}
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <glad/glad.h>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+// Buffer persistently mapped (coherent) and split in 3 regions, filled by a
+// producer thread without OpenGL context and read by the GPU
+// The producer writes straight into the mapped memory (no glBufferSubData
+// copy). The GL thread draws from the newest complete region and places a
+// fence after the draws: a region is given back to the producer only when its
+// fence is signaled (glClientWaitSync without timeout, nobody waits). If the
+// GL thread has not taken the last region yet, the producer overwrites it.
+//
+// Usage:
+//   m_stream.reserve(count * sizeof(Particle));        // GL thread, producer stopped
+//   ...
+//   if (void* data = m_stream.beginWrite()) {         // Producer thread
+//       ... fill data ...
+//       m_stream.endWrite(step);
+//   }
+//   ...
+//   m_stream.update();                                 // GL thread, each frame
+//   if (m_stream.hasData())
+//       glBindBufferRange(GL_SHADER_STORAGE_BUFFER, 0, m_stream.buffer(), m_stream.readOffset(), size);
+//   ... draw ...
+//   m_stream.fenceRead();
+class StreamingBuffer
+{
+public:
+    StreamingBuffer() = default;
+    StreamingBuffer(const StreamingBuffer&) = delete;
+    StreamingBuffer& operator=(const StreamingBuffer&) = delete;
+
+    // ------------------------------------------------------------------------
+    // GL thread (the producer must not write during these calls)
+    // make the regions at least regionSize bytes, the capacity grows
+    // geometrically (a smaller size keeps the buffer)
+    // All the regions are emptied (hasData() is false until the next endWrite)
+    void reserve(std::size_t regionSize);
+    // delete the buffer (before destroying the context)
+    void release();
+
+    // ------------------------------------------------------------------------
+    // producer: region to fill (regionCapacity() bytes), nullptr if the GPU
+    // still uses all the other regions
+    void* beginWrite();
+    // producer: the region becomes the newest one (tag: ex the step number)
+    void endWrite(uint64_t tag);
+
+    // ------------------------------------------------------------------------
+    // GL thread: take the newest region and recycle the regions done by the GPU
+    // return true if the region to draw changed
+    bool update();
+    // GL thread: after the last command reading the current region
+    void fenceRead();
+
+    bool hasData() const { return m_read >= 0; }
+    GLuint buffer() const { return m_buffer; }
+    GLintptr readOffset() const { return GLintptr(m_read) * GLintptr(m_regionCapacity); }
+    uint64_t readTag() const { return m_read >= 0 ? m_tags[m_read] : 0; }
+    std::size_t regionCapacity() const { return m_regionCapacity; }
+
+    // ------------------------------------------------------------------------
+    // counters (since the start)
+    uint64_t writtenRegions() const { return m_written.load(std::memory_order_relaxed); }
+    uint64_t skippedWrites() const { return m_skipped.load(std::memory_order_relaxed); }
+
+private:
+    static const int Regions = 3;
+    enum State { Free, Writing, Ready, Drawing, Retired };
+
+    void recycle();
+
+private:
+    GLuint m_buffer = 0;
+    char* m_mapped = nullptr;
+    std::size_t m_regionCapacity = 0;
+
+    std::atomic<int> m_states[Regions] = { {Free}, {Free}, {Free} };
+    std::atomic<int> m_ready{ -1 }; // Newest region written (-1 = none)
+    int m_writing = -1;             // Producer only
+    uint64_t m_tags[Regions] = { 0, 0, 0 };
+
+    // GL thread only
+    int m_read = -1;
+    GLsync m_fences[Regions] = { nullptr, nullptr, nullptr };
+
+    std::atomic<uint64_t> m_written{ 0 };
+    std::atomic<uint64_t> m_skipped{ 0 };
+};
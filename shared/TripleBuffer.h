@@ -0,0 +1,76 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+// Lock-free triple buffer: one producer thread, one consumer thread
+// The producer writes a complete state then publishes it, the consumer always
+// gets the newest published state. Nobody waits: the producer never overwrites
+// the buffer being read, and the consumer never sees a half written state.
+// Intermediate states can be skipped by the consumer (only the newest matters).
+//
+// Usage:
+//   // Producer (ex: simulation thread)
+//   State& s = buffer.writeBuffer();
+//   ... fill s ...
+//   buffer.publish();
+//
+//   // Consumer (ex: render thread)
+//   if (buffer.update())
+//       upload(buffer.readBuffer());
+template <typename T>
+class TripleBuffer
+{
+public:
+    // ------------------------------------------------------------------------
+    // producer: buffer to fill (content of an old state, to overwrite)
+    T& writeBuffer() { return m_buffers[m_write]; }
+
+    // ------------------------------------------------------------------------
+    // producer: the written buffer becomes the newest state
+    void publish()
+    {
+        // Swap with the middle buffer and flag it as new
+        // release: the content of the buffer is visible before the flag
+        const uint8_t previous = m_middle.exchange(uint8_t(m_write | NewBit), std::memory_order_acq_rel);
+        m_write = previous & IndexMask;
+    }
+
+    // ------------------------------------------------------------------------
+    // consumer: take the newest state if there is one
+    // return true if readBuffer() changed
+    bool update()
+    {
+        if ((m_middle.load(std::memory_order_relaxed) & NewBit) == 0)
+            return false;
+        // acquire: see the content written before publish()
+        const uint8_t previous = m_middle.exchange(m_read, std::memory_order_acq_rel);
+        m_read = previous & IndexMask;
+        return true;
+    }
+
+    // ------------------------------------------------------------------------
+    // consumer: newest state received by update()
+    const T& readBuffer() const { return m_buffers[m_read]; }
+    T& readBuffer() { return m_buffers[m_read]; }
+
+    // ------------------------------------------------------------------------
+    // initialize the 3 buffers (no thread can use the buffer during this call)
+    void reset(const T& value)
+    {
+        for (T& b : m_buffers)
+            b = value;
+        m_write = 0;
+        m_middle.store(1, std::memory_order_relaxed);
+        m_read = 2;
+    }
+
+private:
+    static const uint8_t IndexMask = 0x3;
+    static const uint8_t NewBit = 0x4;
+
+    T m_buffers[3];
+    uint8_t m_write = 0;                     // Owned by the producer
+    std::atomic<uint8_t> m_middle{ 1 };      // Shared (index + NewBit)
+    uint8_t m_read = 2;                      // Owned by the consumer
+};
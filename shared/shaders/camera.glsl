@@ -0,0 +1,15 @@
+// Camera data shared by all the programs (see shared/CameraUBO.h)
+// Usage: #include "camera.glsl" (needs #version 420 or more)
+#pragma once
+
+layout(std140, binding = 0) uniform CameraBlock
+{
+    mat4 view;
+    mat4 projection;
+    mat4 viewProjection;
+    mat4 invView;
+    mat4 invProjection;
+    vec4 position;         // xyz: camera position (world)
+    vec4 clip;             // x: near, y: far
+    vec4 frustumPlanes[6]; // left, right, bottom, top, near, far (world)
+} camera;
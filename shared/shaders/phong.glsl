@@ -0,0 +1,17 @@
+// Phong lighting helpers shared by several examples
+// Usage: #include "phong.glsl" (resolved by ShaderProgram)
+#pragma once
+
+// Reflect the light direction around the normal
+// Note: both vectors need to be normalized
+vec3 phongReflect(vec3 lightDirection, vec3 normal)
+{
+    return normalize(-lightDirection + 2.0*normal*dot(normal, lightDirection));
+}
+
+// Specular lobe of the Phong model
+float phongSpecular(vec3 lightDirection, vec3 normal, vec3 viewDirection, float exponent)
+{
+    vec3 Rl = phongReflect(lightDirection, normal);
+    return pow(max(0.0, dot(Rl, viewDirection)), exponent);
+}
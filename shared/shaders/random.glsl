@@ -0,0 +1,36 @@
+// Counter-based random numbers, GPU twin of shared/Random.h
+// Same integers than the CPU for the same key and counter (the floats can
+// differ in the last bit if the compiler fuses min + (max - min) * u).
+// Usage: #include "random.glsl"
+#pragma once
+
+// PCG hash of one value (Random::hash)
+uint randomHash(uint v) {
+    uint state = v * 747796405u + 2891336453u;
+    uint word = ((state >> ((state >> 28u) + 4u)) ^ state) * 277803737u;
+    return (word >> 22u) ^ word;
+}
+
+// Key of the sequence of a seed (Random::key)
+uint randomKey(uint seed, uint sequence) {
+    return randomHash(seed ^ randomHash(sequence));
+}
+
+// Element of a sequence, pcg2d hash of (counter, key) (Random::value)
+uint randomValue(uint key, uint counter) {
+    uvec2 v = uvec2(counter, key) * 1664525u + 1013904223u;
+    v.x += v.y * 1664525u;
+    v.y += v.x * 1664525u;
+    v = v ^ (v >> 16u);
+    v.x += v.y * 1664525u;
+    return v.x ^ (v.x >> 16u);
+}
+
+// [0, 1[ with 24 bits (Random::uniform)
+float randomUniform(uint key, uint counter) {
+    return float(randomValue(key, counter) >> 8u) * (1.0 / 16777216.0);
+}
+
+float randomUniform(uint key, uint counter, float minValue, float maxValue) {
+    return minValue + (maxValue - minValue) * randomUniform(key, counter);
+}